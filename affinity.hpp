@@ -0,0 +1,195 @@
+// ========================================
+// affinity.hpp - CPU pinning & NUMA placement
+// ========================================
+/**
+ * @file affinity.hpp
+ * @brief Maps worker threads to CPUs by policy, using the NUMA topology from sysfs.
+ *
+ * Unpinned workers migrate between cores and sockets, which shows up as run-to-run variance
+ * in the perf logs. Pinning each worker to a fixed CPU also makes NUMA placement follow:
+ * Linux allocates a page on the node of the thread that first touches it, so a pinned worker's
+ * `thread_local PoolAllocator` (which touches its pages on construction) lands on its own node.
+ *
+ * ---
+ *
+ * ## Policies (`--pin`)
+ * | Policy      | Placement                                                     |
+ * |-------------|---------------------------------------------------------------|
+ * | `compact`   | Fill node 0's CPUs first, then node 1, ...                    |
+ * | `scatter`   | Round-robin across NUMA nodes (spreads memory bandwidth)      |
+ * | `0,2,4-7`   | Explicit CPU list, assigned to workers in order               |
+ *
+ * Worker `i` gets `cpus[i % cpus.size()]`. Only CPUs in the process affinity mask are used.
+ *
+ * ## Topology Source
+ * `/sys/devices/system/node/node<N>/cpulist`. Without sysfs (non-Linux, containers with a
+ * masked `/sys`), all allowed CPUs are treated as one node. No libnuma dependency.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+/// Exclusive upper bound on CPU ids (the size of a `cpu_set_t`)
+#if defined(CPU_SETSIZE)
+constexpr int kCpuIdLimit = CPU_SETSIZE;
+#else
+constexpr int kCpuIdLimit = 1024;
+#endif
+
+/**
+ * @brief Parses a Linux CPU list such as `"0-3,8,10-11"`.
+ * @param text CPU list
+ * @param cpus Output CPU ids, in list order
+ * @return false if the list is malformed or names a CPU id at or above `kCpuIdLimit`
+ */
+inline bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || item == "\n") continue;
+        try {
+            std::size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            if (first < 0 || last < first || last >= kCpuIdLimit) return false;
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (const std::invalid_argument&) {
+            return false;
+        } catch (const std::out_of_range&) {
+            return false;
+        }
+    }
+    return !cpus.empty();
+}
+
+/**
+ * @brief CPUs the process may run on (its affinity mask).
+ * @return Sorted CPU ids
+ */
+inline std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &mask)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < count; ++cpu) cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+/**
+ * @brief Allowed CPUs grouped by NUMA node.
+ * @return One CPU list per node that has allowed CPUs (a single group if topology is unknown)
+ */
+inline std::vector<std::vector<int>> numaNodes() {
+    std::vector<int> allowed = allowedCpus();
+    std::set<int> allowedSet(allowed.begin(), allowed.end());
+    std::vector<std::vector<int>> nodes;
+
+    for (int node = 0; node < 1024; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            if (node == 0) break;
+            continue;     // node ids can be sparse
+        }
+        std::string text;
+        std::getline(file, text);
+
+        std::vector<int> cpus, usable;
+        if (!parseCpuList(text, cpus)) continue;
+        for (int cpu : cpus) {
+            if (allowedSet.count(cpu)) usable.push_back(cpu);
+        }
+        if (!usable.empty()) nodes.push_back(usable);
+    }
+
+    if (nodes.empty()) nodes.push_back(allowed);
+    return nodes;
+}
+
+/**
+ * @brief Resolves a `--pin` policy to an ordered CPU list.
+ *
+ * @param policy `compact`, `scatter`, or an explicit CPU list; empty means "don't pin"
+ * @param cpus   Output CPU list (worker i → cpus[i % size])
+ * @return false if the policy is not recognized or names no usable CPU
+ */
+inline bool resolvePinning(const std::string& policy, std::vector<int>& cpus) {
+    cpus.clear();
+    if (policy.empty()) return true;
+
+    if (policy == "compact" || policy == "scatter") {
+        std::vector<std::vector<int>> nodes = numaNodes();
+        if (policy == "compact") {
+            for (const auto& node : nodes) cpus.insert(cpus.end(), node.begin(), node.end());
+        } else {
+            for (std::size_t depth = 0;; ++depth) {
+                bool any = false;
+                for (const auto& node : nodes) {
+                    if (depth < node.size()) {
+                        cpus.push_back(node[depth]);
+                        any = true;
+                    }
+                }
+                if (!any) break;
+            }
+        }
+        return !cpus.empty();
+    }
+
+    return parseCpuList(policy, cpus);
+}
+
+/**
+ * @brief The CPU list `--pin` resolved to, for pools a method creates itself (e.g. `Hybrid`).
+ */
+struct PinConfig {
+    std::vector<int> cpus;   ///< Worker i → cpus[i % size]; empty = unpinned
+
+    /**
+     * @brief Process-wide configuration. Set before starting any run.
+     * @return Reference to the global configuration
+     */
+    static PinConfig& global() {
+        static PinConfig instance;
+        return instance;
+    }
+};
+
+/**
+ * @brief Pins the calling thread to one CPU.
+ * @param cpu CPU id
+ * @return true on success (always false on platforms without affinity support)
+ */
+inline bool pinCurrentThread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= kCpuIdLimit) return false;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
@@ -0,0 +1,722 @@
+// ========================================
+// arrowlog.hpp - Arrow IPC result log
+// ========================================
+/**
+ * @file arrowlog.hpp
+ * @brief Appends benchmark rows to one Arrow IPC stream file per batch, with the pipeline's columns.
+ *
+ * The per-run path (stdout → `[PERF]` record → `gen_perf_parquet_logs.py` → one tiny parquet
+ * per row → `combine_batch_parquets.py`) costs an interpreter start per data point and leaves
+ * thousands of files after a sweep. `ResultLog` collects one row per timed repetition in the
+ * process and, at exit, appends them as a single record batch to `--arrow-out`. Every process
+ * of a batch appends to the same file, so a whole batch — sweeps included — is one file that
+ * `polars.read_ipc_stream()` loads directly.
+ *
+ * ---
+ *
+ * ## Format
+ * Arrow IPC *streaming* format, metadata version V5, little endian:
+ * ```
+ * [schema message] [record batch] [record batch] ... [end-of-stream 0xFFFFFFFF 00000000]
+ * ```
+ * The streaming format (unlike the file format) has no footer, so appending a batch is: drop the
+ * 8-byte end-of-stream marker, write the batch, write the marker again. The existing schema
+ * message must be byte-identical to this binary's; a file written with a different column set is
+ * left untouched and the append fails with an `[ERROR]`.
+ *
+ * ## Columns
+ * `resultColumns()` mirrors `SCHEMA` in `pipeline/schema.py` — same names, same order:
+ * | Polars type         | Arrow type                     |
+ * |---------------------|--------------------------------|
+ * | `pl.Datetime("ms")` | Timestamp(millisecond, no zone) |
+ * | `pl.Utf8()`         | Utf8                           |
+ * | `pl.Int64()`        | Int(64, signed)                |
+ * | `pl.Float64()`      | FloatingPoint(double)          |
+ *
+ * `Host` is `$MC_HOST` if set, else the machine's host name, so containers with random host names
+ * can still share one regression baseline (`pipeline/detect_regressions.py`). It and the columns
+ * after it (CPU, clock policy, SIMD kernel, pinning, compiler, flags, git revision) come from the
+ * `RunInfo` passed to `ResultLog::open()` (`runinfo.hpp`), and unknown values are nulls. They are
+ * the same for every row of a process, except in a distributed run: node rows carry the worker's
+ * `RunInfo` and the `cluster` row only the values all workers share.
+ *
+ * `Timestamp` is local wall-clock time stored zone-less, matching the rows written by
+ * `gen_perf_parquet_logs.py`. Every Arrow field is declared nullable, and unavailable counters
+ * are written as nulls even in columns `SCHEMA` marks non-nullable (e.g. `Cycles` without perf).
+ * The pipeline's `safe_vector_cast()` only casts types and backfills missing nullable columns;
+ * it does not reject those nulls. Derived columns (miss %, IPC, per-trial ratios) use the same
+ * formulas and 4-decimal rounding as `pipeline/utils.py`.
+ *
+ * ## Flatbuffers
+ * IPC metadata is flatbuffers. `FlatNode` is a minimal front-to-back encoder covering what the
+ * Arrow schema needs (tables, strings, vectors of tables and of 16-byte structs): each object is
+ * written before its children, so every `uoffset` points forward as the format requires.
+ *
+ * ## Example
+ * ```cpp
+ * ResultLog::global().open("db/logs/batch_x/perf_results_x.arrows", "x");
+ * ResultLog::global().add("SIMD", 8, repeated.runs);
+ * ResultLog::global().flush();   // one record batch appended
+ * ```
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "runinfo.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One flatbuffers object of an Arrow metadata tree, serialized by `flatSerialize()`.
+ */
+struct FlatNode {
+    /// Kind of object.
+    enum class Kind { Table, String, TableVector, StructVector };
+
+    /// One present field of a table: an inline scalar or an offset to a child object.
+    struct Slot {
+        int id;                              ///< Field index in the schema (vtable slot)
+        std::vector<std::uint8_t> scalar;    ///< Little-endian scalar bytes (empty for offsets)
+        std::shared_ptr<FlatNode> child;     ///< Referenced object (null for scalars)
+    };
+
+    Kind kind = Kind::Table;
+    std::vector<Slot> slots;                          ///< Table fields
+    std::string text;                                 ///< String contents
+    std::vector<std::shared_ptr<FlatNode>> items;     ///< TableVector elements
+    std::vector<std::uint8_t> structs;                ///< StructVector element bytes (16 per element)
+
+    /**
+     * @brief Add an inline scalar field to a table.
+     * @param id    Field index
+     * @param value Scalar value (its size is its alignment)
+     * @return This node, for chaining
+     */
+    template <typename T>
+    FlatNode& scalar(int id, T value) {
+        std::vector<std::uint8_t> bytes(sizeof(T));
+        std::memcpy(bytes.data(), &value, sizeof(T));
+        slots.push_back({id, std::move(bytes), nullptr});
+        return *this;
+    }
+
+    /**
+     * @brief Add an offset field to a table.
+     * @param id    Field index
+     * @param node  Referenced table, string or vector
+     * @return This node, for chaining
+     */
+    FlatNode& child(int id, std::shared_ptr<FlatNode> node) {
+        slots.push_back({id, {}, std::move(node)});
+        return *this;
+    }
+
+    /// @brief New empty table.
+    static std::shared_ptr<FlatNode> table() {
+        return std::make_shared<FlatNode>();
+    }
+
+    /// @brief New string.
+    static std::shared_ptr<FlatNode> string(const std::string& value) {
+        auto node = std::make_shared<FlatNode>();
+        node->kind = Kind::String;
+        node->text = value;
+        return node;
+    }
+
+    /// @brief New vector of tables.
+    static std::shared_ptr<FlatNode> tables(std::vector<std::shared_ptr<FlatNode>> elements) {
+        auto node = std::make_shared<FlatNode>();
+        node->kind = Kind::TableVector;
+        node->items = std::move(elements);
+        return node;
+    }
+
+    /// @brief New vector of `{int64, int64}` structs (Arrow `FieldNode` / `Buffer`).
+    static std::shared_ptr<FlatNode> pairs(const std::vector<std::pair<std::int64_t, std::int64_t>>& elements) {
+        auto node = std::make_shared<FlatNode>();
+        node->kind = Kind::StructVector;
+        for (const auto& element : elements) {
+            std::uint8_t bytes[16];
+            std::memcpy(bytes, &element.first, 8);
+            std::memcpy(bytes + 8, &element.second, 8);
+            node->structs.insert(node->structs.end(), bytes, bytes + 16);
+        }
+        return node;
+    }
+};
+
+/**
+ * @brief Serializes a flatbuffers object at the end of `out`, children after their parents.
+ * @param out  Buffer (alignment is relative to its start)
+ * @param node Object to write
+ * @return Position the object's `uoffset` must point to
+ */
+inline std::size_t flatSerialize(std::vector<std::uint8_t>& out, const FlatNode& node) {
+    auto align = [&](std::size_t alignment, std::size_t phase = 0) {
+        while (out.size() % alignment != phase) out.push_back(0);
+    };
+    auto put32 = [&](std::size_t at, std::uint32_t value) { std::memcpy(out.data() + at, &value, 4); };
+    auto append = [&](const void* data, std::size_t size) {
+        const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    };
+    auto link = [&](std::size_t at, const FlatNode& child) {
+        std::size_t target = flatSerialize(out, child);
+        put32(at, static_cast<std::uint32_t>(target - at));
+    };
+
+    switch (node.kind) {
+        case FlatNode::Kind::String: {
+            align(4);
+            std::size_t start = out.size();
+            std::uint32_t length = static_cast<std::uint32_t>(node.text.size());
+            append(&length, 4);
+            append(node.text.data(), node.text.size());
+            out.push_back(0);
+            return start;
+        }
+        case FlatNode::Kind::StructVector: {
+            align(8, 4);   // Elements (8-byte aligned) follow the 4-byte length
+            std::size_t start = out.size();
+            std::uint32_t length = static_cast<std::uint32_t>(node.structs.size() / 16);
+            append(&length, 4);
+            append(node.structs.data(), node.structs.size());
+            return start;
+        }
+        case FlatNode::Kind::TableVector: {
+            align(4);
+            std::size_t start = out.size();
+            std::uint32_t length = static_cast<std::uint32_t>(node.items.size());
+            append(&length, 4);
+            std::size_t first = out.size();
+            out.resize(out.size() + 4 * node.items.size());
+            for (std::size_t i = 0; i < node.items.size(); ++i) link(first + 4 * i, *node.items[i]);
+            return start;
+        }
+        case FlatNode::Kind::Table:
+            break;
+    }
+
+    // vtable: {vtable bytes, table bytes, field offsets...}, then the table it describes
+    int fields = 0;
+    for (const FlatNode::Slot& slot : node.slots) fields = std::max(fields, slot.id + 1);
+    std::vector<std::uint16_t> vtable(2 + static_cast<std::size_t>(fields), 0);
+    vtable[0] = static_cast<std::uint16_t>(2 * vtable.size());
+
+    align(2);
+    std::size_t vtablePos = out.size();
+    out.resize(out.size() + 2 * vtable.size());
+
+    align(8);
+    std::size_t tablePos = out.size();
+    out.resize(out.size() + 4);
+    std::int32_t back = static_cast<std::int32_t>(tablePos - vtablePos);
+    std::memcpy(out.data() + tablePos, &back, 4);
+
+    std::vector<std::size_t> offsetPos(node.slots.size(), 0);
+    for (std::size_t i = 0; i < node.slots.size(); ++i) {
+        const FlatNode::Slot& slot = node.slots[i];
+        std::size_t size = slot.child ? 4 : slot.scalar.size();
+        align(size);
+        vtable[2 + static_cast<std::size_t>(slot.id)] = static_cast<std::uint16_t>(out.size() - tablePos);
+        offsetPos[i] = out.size();
+        if (slot.child) out.resize(out.size() + 4);
+        else append(slot.scalar.data(), size);
+    }
+    vtable[1] = static_cast<std::uint16_t>(out.size() - tablePos);
+    std::memcpy(out.data() + vtablePos, vtable.data(), 2 * vtable.size());
+
+    for (std::size_t i = 0; i < node.slots.size(); ++i) {
+        if (node.slots[i].child) link(offsetPos[i], *node.slots[i].child);
+    }
+    return tablePos;
+}
+
+/**
+ * @brief Serializes a flatbuffers root object, padded to a multiple of 8 bytes.
+ * @param root Root table
+ * @return Flatbuffer bytes
+ */
+inline std::vector<std::uint8_t> flatFinish(const FlatNode& root) {
+    std::vector<std::uint8_t> out(4, 0);
+    std::uint32_t offset = static_cast<std::uint32_t>(flatSerialize(out, root));
+    std::memcpy(out.data(), &offset, 4);
+    while (out.size() % 8) out.push_back(0);
+    return out;
+}
+
+/// Column types the result log writes.
+enum class ArrowType {
+    TimestampMs,   ///< Milliseconds since the Unix epoch
+    Utf8,          ///< String
+    Int64,         ///< Signed 64-bit integer
+    Float64,       ///< Double
+};
+
+/**
+ * @brief One column of the result log.
+ */
+struct ResultColumn {
+    const char* name;   ///< Column name, as in `pipeline/schema.py`
+    ArrowType type;     ///< Arrow type
+};
+
+/**
+ * @brief The result log's columns, in `SCHEMA` order.
+ * @return Column list
+ */
+inline const std::vector<ResultColumn>& resultColumns() {
+    static const std::vector<ResultColumn> columns = {
+        {"Timestamp", ArrowType::TimestampMs},
+        {"BatchID", ArrowType::Utf8},
+        {"Method", ArrowType::Utf8},
+        {"Trials", ArrowType::Int64},
+        {"Cycles", ArrowType::Int64},
+        {"Instructions", ArrowType::Int64},
+        {"IPC", ArrowType::Float64},
+        {"Wall Time (s)", ArrowType::Float64},
+        {"Wall Time (ns)", ArrowType::Int64},
+        {"Cache Loads", ArrowType::Int64},
+        {"Cache Misses", ArrowType::Int64},
+        {"Cache Miss %", ArrowType::Float64},
+        {"L1 Loads", ArrowType::Int64},
+        {"L1 Misses", ArrowType::Int64},
+        {"L1 Miss %", ArrowType::Float64},
+        {"L2 Loads", ArrowType::Int64},
+        {"L2 Misses", ArrowType::Int64},
+        {"L2 Miss %", ArrowType::Float64},
+        {"L3 Loads", ArrowType::Int64},
+        {"L3 Misses", ArrowType::Int64},
+        {"L3 Miss %", ArrowType::Float64},
+        {"TLB Loads", ArrowType::Int64},
+        {"TLB Misses", ArrowType::Int64},
+        {"TLB Miss %", ArrowType::Float64},
+        {"Branch Instructions", ArrowType::Int64},
+        {"Branch Misses", ArrowType::Int64},
+        {"Branch Miss %", ArrowType::Float64},
+        {"Misses/Trial", ArrowType::Float64},
+        {"Cycles/Trial", ArrowType::Float64},
+        {"ThreadCount", ArrowType::Int64},
+        {"Repetition", ArrowType::Int64},
+        {"Node", ArrowType::Utf8},
+        {"NodeCount", ArrowType::Int64},
+        {"Reduction Overhead (ns)", ArrowType::Int64},
+        {"Start Skew (ns)", ArrowType::Int64},
+        {"Join Wait (ns)", ArrowType::Int64},
+        {"Worker Busy Min (ns)", ArrowType::Int64},
+        {"Worker Busy Max (ns)", ArrowType::Int64},
+        {"Load Imbalance", ArrowType::Float64},
+        {"Host", ArrowType::Utf8},
+        {"CPU Model", ArrowType::Utf8},
+        {"CPU Microarch", ArrowType::Utf8},
+        {"CPU Cores", ArrowType::Int64},
+        {"CPU Max Freq (MHz)", ArrowType::Int64},
+        {"CPU Governor", ArrowType::Utf8},
+        {"Turbo", ArrowType::Utf8},
+        {"SIMD Kernel", ArrowType::Utf8},
+        {"Pinning", ArrowType::Utf8},
+        {"Compiler", ArrowType::Utf8},
+        {"Build Flags", ArrowType::Utf8},
+        {"Git Revision", ArrowType::Utf8},
+    };
+    return columns;
+}
+
+/**
+ * @brief One cell; `valid == false` is a null.
+ */
+struct ResultValue {
+    bool valid = false;       ///< false = null
+    std::int64_t integer = 0; ///< Int64 / TimestampMs value
+    double real = 0.0;        ///< Float64 value
+    std::string text;         ///< Utf8 value
+};
+
+/// One row, in `resultColumns()` order.
+using ResultRow = std::vector<ResultValue>;
+
+/**
+ * @brief Frames an IPC message: continuation marker, metadata length, metadata, body.
+ * @param metadata Flatbuffer `Message` (padded to 8 bytes)
+ * @param body     Message body (empty for schema messages)
+ * @return Message bytes
+ */
+inline std::vector<std::uint8_t> arrowFrame(const std::vector<std::uint8_t>& metadata, const std::vector<std::uint8_t>& body) {
+    const std::uint32_t prefix[2] = {0xFFFFFFFFu, static_cast<std::uint32_t>(metadata.size())};
+    const std::uint8_t* header = reinterpret_cast<const std::uint8_t*>(prefix);
+
+    std::vector<std::uint8_t> framed(header, header + sizeof(prefix));
+    framed.reserve(sizeof(prefix) + metadata.size() + body.size());
+    framed.insert(framed.end(), metadata.begin(), metadata.end());
+    framed.insert(framed.end(), body.begin(), body.end());
+    return framed;
+}
+
+/**
+ * @brief Serializes the Arrow schema message for `columns`.
+ * @param columns Column list
+ * @return Framed message bytes (continuation, length, flatbuffer)
+ */
+inline std::vector<std::uint8_t> arrowSchemaMessage(const std::vector<ResultColumn>& columns) {
+    constexpr std::uint8_t kTypeInt = 2, kTypeFloat = 3, kTypeUtf8 = 5, kTypeTimestamp = 10;
+
+    std::vector<std::shared_ptr<FlatNode>> fields;
+    for (const ResultColumn& column : columns) {
+        auto type = FlatNode::table();
+        std::uint8_t typeId = kTypeUtf8;
+        switch (column.type) {
+            case ArrowType::TimestampMs: typeId = kTypeTimestamp; type->scalar<std::int16_t>(0, 1); break;   // MILLISECOND
+            case ArrowType::Int64:       typeId = kTypeInt; type->scalar<std::int32_t>(0, 64).scalar<std::uint8_t>(1, 1); break;
+            case ArrowType::Float64:     typeId = kTypeFloat; type->scalar<std::int16_t>(0, 2); break;      // DOUBLE
+            case ArrowType::Utf8:        break;
+        }
+
+        auto field = FlatNode::table();
+        field->child(0, FlatNode::string(column.name))
+            .scalar<std::uint8_t>(1, 1)         // nullable
+            .scalar<std::uint8_t>(2, typeId)
+            .child(3, type)
+            .child(5, FlatNode::tables({}));    // children (required by some readers even if empty)
+        fields.push_back(field);
+    }
+
+    auto schema = FlatNode::table();
+    schema->child(1, FlatNode::tables(fields));
+
+    auto message = FlatNode::table();
+    message->scalar<std::int16_t>(0, 4)         // MetadataVersion V5
+        .scalar<std::uint8_t>(1, 1)             // MessageHeader::Schema
+        .child(2, schema)
+        .scalar<std::int64_t>(3, 0);
+
+    return arrowFrame(flatFinish(*message), {});
+}
+
+/**
+ * @brief Serializes one record batch message (metadata and body) for `rows`.
+ * @param columns Column list
+ * @param rows    Rows, each in column order
+ * @return Framed message bytes
+ */
+inline std::vector<std::uint8_t> arrowRecordBatchMessage(const std::vector<ResultColumn>& columns,
+                                                         const std::vector<ResultRow>& rows) {
+    std::vector<std::uint8_t> body;
+    std::vector<std::pair<std::int64_t, std::int64_t>> nodes;     // {length, null_count}
+    std::vector<std::pair<std::int64_t, std::int64_t>> buffers;   // {offset, length}
+    const std::size_t n = rows.size();
+
+    auto addBuffer = [&](const std::vector<std::uint8_t>& bytes) {
+        buffers.push_back({static_cast<std::int64_t>(body.size()), static_cast<std::int64_t>(bytes.size())});
+        body.insert(body.end(), bytes.begin(), bytes.end());
+        while (body.size() % 8) body.push_back(0);
+    };
+
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+        std::vector<std::uint8_t> validity((n + 7) / 8, 0);
+        std::int64_t nulls = 0;
+        for (std::size_t r = 0; r < n; ++r) {
+            if (rows[r][c].valid) validity[r / 8] |= static_cast<std::uint8_t>(1u << (r % 8));
+            else ++nulls;
+        }
+        nodes.push_back({static_cast<std::int64_t>(n), nulls});
+        addBuffer(validity);
+
+        std::vector<std::uint8_t> values;
+        if (columns[c].type == ArrowType::Utf8) {
+            std::vector<std::uint8_t> offsets(4 * (n + 1), 0);
+            std::int32_t offset = 0;
+            for (std::size_t r = 0; r < n; ++r) {
+                if (rows[r][c].valid) {
+                    values.insert(values.end(), rows[r][c].text.begin(), rows[r][c].text.end());
+                    offset += static_cast<std::int32_t>(rows[r][c].text.size());
+                }
+                std::memcpy(offsets.data() + 4 * (r + 1), &offset, 4);
+            }
+            addBuffer(offsets);
+        } else {
+            values.resize(8 * n, 0);
+            for (std::size_t r = 0; r < n; ++r) {
+                if (!rows[r][c].valid) continue;
+                if (columns[c].type == ArrowType::Float64) std::memcpy(values.data() + 8 * r, &rows[r][c].real, 8);
+                else std::memcpy(values.data() + 8 * r, &rows[r][c].integer, 8);
+            }
+        }
+        addBuffer(values);
+    }
+
+    auto batch = FlatNode::table();
+    batch->scalar<std::int64_t>(0, static_cast<std::int64_t>(n))
+        .child(1, FlatNode::pairs(nodes))
+        .child(2, FlatNode::pairs(buffers));
+
+    auto message = FlatNode::table();
+    message->scalar<std::int16_t>(0, 4)
+        .scalar<std::uint8_t>(1, 3)             // MessageHeader::RecordBatch
+        .child(2, batch)
+        .scalar<std::int64_t>(3, static_cast<std::int64_t>(body.size()));
+
+    return arrowFrame(flatFinish(*message), body);
+}
+
+/**
+ * @brief Appends `rows` as one record batch to an Arrow IPC stream file, creating it if needed.
+ *
+ * After checking the schema prefix and the end-of-stream marker, only the new record batch and
+ * a fresh marker are written over the old marker, so the cost follows the batch, and a failed
+ * write cannot touch the rows already logged.
+ *
+ * @param path    Stream file path
+ * @param columns Column list
+ * @param rows    Rows to append
+ * @return false (after an `[ERROR]`) if the file is unreadable, not a stream written with the
+ *         same columns, or cannot be written
+ */
+inline bool appendArrowStream(const std::string& path, const std::vector<ResultColumn>& columns,
+                              const std::vector<ResultRow>& rows) {
+    static const std::uint8_t kEndOfStream[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0};
+    std::vector<std::uint8_t> schema = arrowSchemaMessage(columns);
+
+    std::vector<std::uint8_t> batch = arrowRecordBatchMessage(columns, rows);
+
+    // An existing stream is only extended in place: its rows are never rewritten
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    std::streamoff size = 0;
+    if (file) {
+        file.seekg(0, std::ios::end);
+        size = static_cast<std::streamoff>(file.tellg());
+    }
+
+    if (size > 0) {
+        std::vector<std::uint8_t> head(schema.size());
+        std::uint8_t tail[8] = {};
+        bool sameSchema = size >= static_cast<std::streamoff>(schema.size() + 8) &&
+                          file.seekg(0).read(reinterpret_cast<char*>(head.data()),
+                                             static_cast<std::streamsize>(head.size())) &&
+                          head == schema;
+        bool terminated = size >= 8 && file.seekg(size - 8).read(reinterpret_cast<char*>(tail), 8) &&
+                          std::memcmp(tail, kEndOfStream, 8) == 0;
+        if (!sameSchema || !terminated) {
+            std::cerr << "[ERROR] " << path << " is not an Arrow stream with this build's columns; not appending\n";
+            return false;
+        }
+        file.seekp(size - 8);
+    } else {
+        file.close();
+        file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (file) file.write(reinterpret_cast<const char*>(schema.data()), static_cast<std::streamsize>(schema.size()));
+    }
+    if (!file) {
+        std::cerr << "[ERROR] Cannot write Arrow results: " << path << "\n";
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(batch.size()));
+    file.write(reinterpret_cast<const char*>(kEndOfStream), 8);
+    file.flush();
+    if (!file) {
+        std::cerr << "[ERROR] Cannot write Arrow results: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Cluster columns of a row written by a distributed run (all null for a local run).
+ */
+struct ResultNode {
+    std::string name;                   ///< `Node`: worker name, or `cluster` for the reduced row
+    int count = 0;                      ///< `NodeCount`: workers in the run (0 = local run)
+    std::vector<long long> overheadNs;  ///< `Reduction Overhead (ns)` per repetition (cluster row only)
+};
+
+/**
+ * @brief Process-wide collector of result rows for `--arrow-out`.
+ */
+class ResultLog {
+public:
+    /**
+     * @brief Process-wide log (closed by default).
+     * @return Reference to the log
+     */
+    static ResultLog& global() {
+        static ResultLog instance;
+        return instance;
+    }
+
+    /**
+     * @brief Start collecting rows for `path`.
+     * @param path    Arrow stream file to append to at `flush()`
+     * @param batchId Value of the `BatchID` column
+     * @param info    Values of `Host` and the metadata columns after it
+     */
+    void open(const std::string& path, const std::string& batchId, const RunInfo& info = RunInfo::capture()) {
+        outPath = path;
+        batch = batchId;
+        metadata = info;
+    }
+
+    /**
+     * @brief Change the `SIMD Kernel` value of rows added from now on (e.g. between `--spec` kernels).
+     * @param kernel Bound backend and variant (`activeSimdKernelName()`)
+     */
+    void setSimdKernel(const std::string& kernel) {
+        metadata.simdKernel = kernel;
+    }
+
+    /**
+     * @brief Whether rows are being collected.
+     * @return true after `open()`
+     */
+    bool active() const {
+        return !outPath.empty();
+    }
+
+    /**
+     * @brief Add one row per timed repetition of a method. No-op while closed.
+     * @param method  Method name (`Method` column)
+     * @param threads Worker threads (`ThreadCount` column)
+     * @param runs    Repetitions, in run order (`Repetition` column = index)
+     * @param node    Cluster columns (default: local run, nulls)
+     * @param info    Metadata of the machine that produced `runs` (default: this process's)
+     */
+    void add(const std::string& method, unsigned threads, const std::vector<BenchmarkResult>& runs,
+             const ResultNode& node = {}, const RunInfo* info = nullptr) {
+        if (!active()) return;
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+            rows.push_back(makeRow(method, threads, static_cast<int>(i), runs[i], node, info ? *info : metadata));
+        }
+    }
+
+    /**
+     * @brief Append collected rows to the file as one record batch and clear them.
+     * @return false if the append failed
+     */
+    bool flush() {
+        if (!active() || rows.empty()) return true;
+        bool ok = appendArrowStream(outPath, resultColumns(), rows);
+        if (ok) std::cout << "[INFO] Arrow results: " << rows.size() << " rows appended to " << outPath << "\n";
+        rows.clear();
+        return ok;
+    }
+
+private:
+    /**
+     * @brief Build a row with the derived columns of `gen_perf_parquet_logs.py`.
+     * @param method     Method name
+     * @param threads    Worker threads
+     * @param repetition Repetition index
+     * @param run        Timed repetition
+     * @param node       Cluster columns
+     * @param info       `Host` and the metadata columns
+     * @return Row in column order
+     */
+    ResultRow makeRow(const std::string& method, unsigned threads, int repetition, const BenchmarkResult& run,
+                      const ResultNode& node, const RunInfo& info) const {
+        const PerfSample& counters = run.counters;
+        auto integer = [](std::int64_t value) { ResultValue cell; cell.valid = true; cell.integer = value; return cell; };
+        auto text = [](const std::string& value) { ResultValue cell; cell.valid = true; cell.text = value; return cell; };
+        auto known = [&](const std::string& value) { return value.empty() ? ResultValue{} : text(value); };
+        auto real = [](bool valid, double value) {
+            ResultValue cell;
+            cell.valid = valid && std::isfinite(value);
+            cell.real = cell.valid ? value : 0.0;
+            return cell;
+        };
+        auto count = [&](PerfEvent event) {
+            return counters.has(event) ? integer(static_cast<std::int64_t>(counters[event] + 0.5)) : ResultValue{};
+        };
+        // safe_div / safe_div_percent: rounded to 4 decimals, NA when an input is missing
+        auto ratio = [&](bool valid, double numerator, double denominator, double scale) {
+            bool defined = valid && denominator != 0.0;
+            return real(defined, defined ? perfRatio(numerator, denominator, scale) : 0.0);
+        };
+        auto percent = [&](PerfEvent misses, PerfEvent loads) {
+            return ratio(counters.has(misses) && counters.has(loads), counters[misses], counters[loads], 100.0);
+        };
+
+        const double trials = static_cast<double>(run.trials);
+        const TraceBalance& balance = run.balance;
+        auto traced = [&](long long ns) { return balance.valid() ? integer(ns) : ResultValue{}; };
+        const std::size_t rep = static_cast<std::size_t>(repetition);
+        return {
+            integer(localTimeMs()),
+            text(batch),
+            text(method),
+            integer(run.trials),
+            count(PerfEvent::Cycles),
+            count(PerfEvent::Instructions),
+            ratio(counters.has(PerfEvent::Instructions) && counters.has(PerfEvent::Cycles),
+                  counters[PerfEvent::Instructions], counters[PerfEvent::Cycles], 1.0),
+            real(true, static_cast<double>(run.elapsedNs) / 1e9),
+            integer(run.elapsedNs),
+            count(PerfEvent::CacheReferences),
+            count(PerfEvent::CacheMisses),
+            percent(PerfEvent::CacheMisses, PerfEvent::CacheReferences),
+            count(PerfEvent::L1Loads),
+            count(PerfEvent::L1Misses),
+            percent(PerfEvent::L1Misses, PerfEvent::L1Loads),
+            {}, {}, {}, {}, {}, {},   // L2 / L3: no generic events
+            count(PerfEvent::TlbLoads),
+            count(PerfEvent::TlbMisses),
+            percent(PerfEvent::TlbMisses, PerfEvent::TlbLoads),
+            count(PerfEvent::BranchInstructions),
+            count(PerfEvent::BranchMisses),
+            percent(PerfEvent::BranchMisses, PerfEvent::BranchInstructions),
+            ratio(counters.has(PerfEvent::CacheMisses), counters[PerfEvent::CacheMisses], trials, 1.0),
+            ratio(counters.has(PerfEvent::Cycles), counters[PerfEvent::Cycles], trials, 1.0),
+            integer(static_cast<std::int64_t>(threads)),
+            integer(repetition),
+            node.count > 0 ? text(node.name) : ResultValue{},
+            node.count > 0 ? integer(node.count) : ResultValue{},
+            rep < node.overheadNs.size() ? integer(node.overheadNs[rep]) : ResultValue{},
+            traced(balance.startSkewNs),
+            traced(balance.joinWaitNs),
+            traced(balance.busyMinNs),
+            traced(balance.busyMaxNs),
+            real(balance.valid(), std::round(balance.imbalance() * 1e4) / 1e4),
+            known(info.host),
+            known(info.cpuModel),
+            known(info.cpuMicroarch),
+            info.cpuCores > 0 ? integer(info.cpuCores) : ResultValue{},
+            info.maxFreqMHz > 0 ? integer(info.maxFreqMHz) : ResultValue{},
+            known(info.governor),
+            known(info.turbo),
+            known(info.simdKernel),
+            known(info.pinning),
+            known(info.compiler),
+            known(info.buildFlags),
+            known(info.gitRevision),
+        };
+    }
+
+    /**
+     * @brief Current local wall-clock time as naive milliseconds, like the script-written rows.
+     * @return Milliseconds since the epoch, shifted by the local UTC offset
+     */
+    static std::int64_t localTimeMs() {
+        auto now = std::chrono::system_clock::now();
+        std::int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+#if defined(__unix__) || defined(__APPLE__)
+        std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+        std::tm local{};
+        if (localtime_r(&seconds, &local)) ms += static_cast<std::int64_t>(local.tm_gmtoff) * 1000;
+#endif
+        return ms;
+    }
+
+    std::string outPath;             ///< Stream file (empty = closed)
+    std::string batch;               ///< `BatchID` value
+    RunInfo metadata;                ///< `Host` and the metadata columns
+    std::vector<ResultRow> rows;     ///< Rows not yet flushed
+};
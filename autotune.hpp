@@ -0,0 +1,177 @@
+// ========================================
+// autotune.hpp - SIMD kernel autotuning and tuning cache
+// ========================================
+/**
+ * @file autotune.hpp
+ * @brief Picks the fastest `SIMD` (unroll, buffer) instantiation per CPU model and remembers it.
+ *
+ * `SimdMtKernels<Ops>::run<Unroll, Buffer>` is compiled for every configuration in
+ * `simdVariantsFor` (`dispatch.hpp`). Which one wins depends on the core (issue width, load ports,
+ * how well `mt19937_64` overlaps with the compares), so it is measured rather than guessed:
+ * - `--autotune` times each variant of the active backend on the calling thread
+ *   (`kAutotuneTrials` darts, best of `kAutotuneRepetitions`), prints the table, and stores the
+ *   winner in the tuning cache
+ * - Every later run looks up its (CPU model, backend) in that cache at startup and binds the
+ *   stored variant with `selectSimdVariant`; without an entry the default (1, lanes) is kept
+ *
+ * All variants draw the same darts in the same order, so tuning changes speed, never hits.
+ *
+ * ---
+ *
+ * ## Cache File
+ * Tab-separated, one line per (CPU model, backend); `--tune-cache PATH` moves it, `none` disables it:
+ * ```
+ * # cpu	backend	unroll	buffer	ns_per_trial
+ * AMD EPYC 9654 96-Core Processor	avx512	4	256	1.98
+ * ```
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Default tuning cache, relative to the working directory.
+constexpr const char* kDefaultTuneCache = "montecarlo_tuning.tsv";
+
+/// Darts per timed call while autotuning.
+constexpr std::int64_t kAutotuneTrials = std::int64_t{1} << 22;
+
+/// Timed calls per variant; the fastest counts.
+constexpr int kAutotuneRepetitions = 5;
+
+/**
+ * @brief Tuned `SIMD` configuration for one CPU model and backend.
+ */
+struct SimdTuning {
+    std::string cpu;           ///< CPU model name (`cpuModelName()`)
+    std::string backend;       ///< `SimdBackend::name`
+    int unroll = 1;            ///< Independent counters per step
+    int buffer = 1;            ///< Darts staged per refill
+    double nsPerTrial = 0.0;   ///< Measured cost when tuned
+};
+
+/**
+ * @brief Reads every entry of a tuning cache.
+ * @param path Cache file
+ * @return Parsed entries (empty if the file is missing); malformed lines are skipped
+ */
+inline std::vector<SimdTuning> readTuningCache(const std::string& path) {
+    std::vector<SimdTuning> entries;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        SimdTuning entry;
+        std::string unroll, buffer, ns;
+        if (!std::getline(fields, entry.cpu, '\t') || !std::getline(fields, entry.backend, '\t') ||
+            !std::getline(fields, unroll, '\t') || !std::getline(fields, buffer, '\t') || !std::getline(fields, ns)) {
+            continue;
+        }
+        entry.unroll = std::atoi(unroll.c_str());
+        entry.buffer = std::atoi(buffer.c_str());
+        entry.nsPerTrial = std::atof(ns.c_str());
+        if (entry.unroll > 0 && entry.buffer > 0) entries.push_back(entry);
+    }
+    return entries;
+}
+
+/**
+ * @brief Stores `tuning` in the cache, replacing any entry for the same CPU model and backend.
+ * @param path   Cache file
+ * @param tuning Entry to store
+ * @return false (after printing an error) if the file cannot be written
+ */
+inline bool writeTuningCache(const std::string& path, const SimdTuning& tuning) {
+    std::vector<SimdTuning> entries = readTuningCache(path);
+    bool replaced = false;
+    for (SimdTuning& entry : entries) {
+        if (entry.cpu != tuning.cpu || entry.backend != tuning.backend) continue;
+        entry = tuning;
+        replaced = true;
+    }
+    if (!replaced) entries.push_back(tuning);
+
+    std::ofstream out(path, std::ios::trunc);
+    out << "# cpu\tbackend\tunroll\tbuffer\tns_per_trial\n";
+    for (const SimdTuning& entry : entries) {
+        out << entry.cpu << "\t" << entry.backend << "\t" << entry.unroll << "\t" << entry.buffer << "\t"
+            << entry.nsPerTrial << "\n";
+    }
+    if (!out) {
+        std::cerr << "[ERROR] Could not write tuning cache: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Times every `SIMD` variant of the active backend on the calling thread.
+ * @return The fastest variant as a cache entry for this CPU
+ */
+inline SimdTuning autotuneSimd() {
+    const SimdBackend& backend = activeSimdBackend();
+    std::cout << "[INFO] Autotune: " << backend.name << " SIMD kernel, " << kAutotuneTrials << " trials, best of "
+              << kAutotuneRepetitions << "\n";
+    std::cout << "Unroll  Buffer  ns/trial\n";
+
+    SimdTuning best{cpuModelName(), backend.name, 1, 1, std::numeric_limits<double>::infinity()};
+    double defaultNs = 0.0;
+    for (const SimdVariant& variant : backend.simdVariants()) {
+        variant.kernel(kAutotuneTrials);   // warm the thread_local pool and engine
+        long long fastest = std::numeric_limits<long long>::max();
+        for (int rep = 0; rep < kAutotuneRepetitions; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            std::int64_t hits = *variant.kernel(kAutotuneTrials);
+            doNotOptimize(hits);
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            fastest = std::min<long long>(fastest, ns);
+        }
+
+        double nsPerTrial = static_cast<double>(fastest) / static_cast<double>(kAutotuneTrials);
+        std::string unroll = std::to_string(variant.unroll);
+        std::string buffer = std::to_string(variant.buffer);
+        std::cout << unroll << std::string(8 - unroll.size(), ' ') << buffer << std::string(8 - buffer.size(), ' ')
+                  << nsPerTrial << "\n";
+        if (defaultNs == 0.0) defaultNs = nsPerTrial;
+        if (nsPerTrial < best.nsPerTrial) {
+            best.unroll = variant.unroll;
+            best.buffer = variant.buffer;
+            best.nsPerTrial = nsPerTrial;
+        }
+    }
+
+    std::cout << "[INFO] Fastest: unroll " << best.unroll << ", buffer " << best.buffer << " — "
+              << defaultNs / best.nsPerTrial << "x vs the default (unroll 1, buffer " << backend.lanes << ")\n";
+    return best;
+}
+
+/**
+ * @brief Binds this CPU's cached `SIMD` variant for the active backend, if there is one.
+ * @param path Cache file
+ */
+inline void applyTuningCache(const std::string& path) {
+    std::string cpu = cpuModelName();
+    const char* backend = activeSimdBackend().name;
+    for (const SimdTuning& entry : readTuningCache(path)) {
+        if (entry.cpu != cpu || entry.backend != backend) continue;
+        if (selectSimdVariant(entry.unroll, entry.buffer)) {
+            std::cout << "[INFO] SIMD tuning: unroll " << entry.unroll << ", buffer " << entry.buffer << " (" << path
+                      << ")\n";
+        } else {
+            std::cout << "[WARN] Ignoring tuning unroll " << entry.unroll << ", buffer " << entry.buffer << " from "
+                      << path << " (not compiled into this build)\n";
+        }
+        return;
+    }
+}
@@ -8,12 +8,32 @@
  * Wraps a simulation function and logs:
  * - Wall time in nanoseconds + seconds
  * - CPU cycles (via rdtsc or cntvct_el0)
- * - π estimate from number of hits
+ * - π estimate from number of hits, and its absolute error against π
+ * - Hardware counters of the timed call only, when `PerfCounters` is enabled (`perfcounters.hpp`)
+ * - Pool load balance of the timed call (start skew, join wait, busy spread), when tracing (`trace.hpp`)
  *
  * ## Features
  * - Cross-platform CPU cycle counting (x86 + ARM)
  * - High-resolution `std::chrono` timer
  * - Printable results for logging or scripting
+ * - Thread-scaling sweeps (`scalingSweep`) with speedup, parallel efficiency and throughput
+ * - Warmup calls and repeated measurement (`RepeatConfig`) with min / median / p90 / p99 / MAD
+ * - Convergence sweeps (`convergenceSweep`): RMSE against trials and time, with the fitted order
+ *
+ * ## Repetitions
+ * A single cold run includes page faults of the thread-local pools, clock ramp-up and first
+ * touch, so one sample is mostly noise. `RepeatConfig` adds untimed warmup calls and N timed
+ * repetitions; `benchmark()` reports the median repetition, the distribution, and (with
+ * counters) one `[PERF]` record per repetition so the perf pipeline stores every sample.
+ * Hit counts pass through `doNotOptimize()` so warmup calls cannot be elided.
+ *
+ * ## Scaling Modes
+ * | Mode     | Trials at T threads     | Speedup            | Efficiency     |
+ * |----------|-------------------------|--------------------|----------------|
+ * | `strong` | fixed total             | t(1) / t(T)        | speedup / T    |
+ * | `weak`   | fixed per thread (× T)  | T · t(1) / t(T)    | t(1) / t(T)    |
+ *
+ * Weak-scaling speedup is the scaled (Gustafson) speedup: ideal is still T, ideal efficiency 1.
  *
  * ## Example
  * ```cpp
@@ -25,35 +45,544 @@
 
 #pragma once
 
+#include "perfcounters.hpp"
+#include "runinfo.hpp"
+#include "trace.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
+
+/// π reference used for accuracy reporting (M_PI is not standard C++).
+constexpr double kPi = 3.14159265358979323846;
+
+/**
+ * @brief Outcome of one `benchmark()` call, for comparisons between methods.
+ */
+struct BenchmarkResult {
+    std::string name;       ///< Benchmark label
+    std::int64_t trials;    ///< Total number of trials
+    std::int64_t hits;      ///< Hits inside the circle
+    double estimate;        ///< π estimate (4 · hits / trials)
+    double absError;        ///< |estimate − π|
+    long long elapsedNs;    ///< Wall time in nanoseconds
+    PerfSample counters{};  ///< Hardware counters of the timed region (unavailable unless enabled)
+    TraceBalance balance{}; ///< Pool load balance of the timed region (`runs == 0` unless tracing)
+};
+
+/**
+ * @brief Keeps the compiler from eliding a value's computation (Google Benchmark's `DoNotOptimize`).
+ * @param value Result that must be materialized
+ */
+template <typename T>
+inline void doNotOptimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#else
+    volatile T sink = value;
+    (void)sink;
+#endif
+}
+
+/**
+ * @brief Times a function and derives the π estimate, without printing.
+ * @param name   Name of the benchmark
+ * @param trials Total number of Monte Carlo trials
+ * @param func   Function that returns number of hits
+ * @return Timing and accuracy of the run
+ */
+inline BenchmarkResult measure(const std::string& name, std::int64_t trials, const std::function<std::int64_t()>& func) {
+    // Counter reads sit outside the clock so they never show up in wall time
+    PerfRegion region;
+    TraceRegion trace;
+    const char* label = TraceLog::global().active() ? TraceLog::global().intern(name) : nullptr;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    TraceSpan span(label);
+    std::int64_t hits = func();
+    doNotOptimize(hits);
+    span.finish();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    TraceBalance balance = trace.stop();
+    PerfSample counters = region.stop();
+
+    double piEstimate = 4.0 * static_cast<double>(hits) / static_cast<double>(trials);
+    double absError = std::fabs(piEstimate - kPi);
+    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    return {name, trials, hits, piEstimate, absError, static_cast<long long>(elapsed_ns), counters, balance};
+}
+
+/**
+ * @brief Prints a benchmark result in the standard block format.
+ * @param result Timing and accuracy of a run
+ */
+inline void printBenchmarkResult(const BenchmarkResult& result) {
+    std::cout << result.name << ":\n"
+              << "  Trials: " << result.trials << "\n"
+              << "  Hits: " << result.hits << "\n"
+              << "  Estimate: " << result.estimate << "\n"
+              << "  Error: " << result.absError << "\n"
+              << "  Time: " << (result.elapsedNs / 1e9) << "s (" << result.elapsedNs << " ns)\n";
+    const TraceBalance& balance = result.balance;
+    if (balance.valid()) {
+        std::cout << "  Balance: start skew " << balance.startSkewNs / 1e3 << " us, join wait " << balance.joinWaitNs / 1e3
+                  << " us, worker busy " << balance.busyMinNs / 1e6 << "-" << balance.busyMaxNs / 1e6
+                  << " ms, imbalance " << balance.imbalance() << "x\n";
+    }
+    if (!PerfCounters::global().active()) return;
+
+    const PerfSample& counters = result.counters;
+    if (counters.has(PerfEvent::Cycles) && counters.has(PerfEvent::Instructions)) {
+        std::cout << "  Counters: IPC " << counters[PerfEvent::Instructions] / std::max(1.0, counters[PerfEvent::Cycles])
+                  << ", " << counters[PerfEvent::Cycles] / static_cast<double>(std::max<std::int64_t>(1, result.trials))
+                  << " cycles/trial\n";
+    }
+}
+
+/**
+ * @brief Warmup and repetition counts used by `benchmark()` and the scaling sweeps.
+ */
+struct RepeatConfig {
+    int warmup = 0;         ///< Untimed calls before measuring (page faults, pool first touch, clock ramp-up)
+    int repetitions = 1;    ///< Timed calls; statistics are reported over these
+
+    /**
+     * @brief Process-wide settings (no warmup, one repetition by default).
+     * @return Reference to the global settings
+     */
+    static RepeatConfig& global() {
+        static RepeatConfig instance;
+        return instance;
+    }
+};
+
+/**
+ * @brief Wall-time distribution of the repetitions of one benchmark.
+ *
+ * Percentiles use the nearest-rank method. Repetitions further than 3 robust standard
+ * deviations (1.4826 · MAD) from the median are counted as outliers and left out of `meanNs`;
+ * min and the percentiles always cover every repetition.
+ */
+struct RunStatistics {
+    int repetitions = 0;        ///< Timed repetitions
+    int warmup = 0;             ///< Untimed warmup calls before them
+    double minNs = 0.0;         ///< Fastest repetition
+    double medianNs = 0.0;      ///< Median repetition
+    double p90Ns = 0.0;         ///< 90th percentile
+    double p99Ns = 0.0;         ///< 99th percentile
+    double madNs = 0.0;         ///< Median absolute deviation from the median
+    double meanNs = 0.0;        ///< Mean of the non-outlier repetitions
+    int outliers = 0;           ///< Repetitions rejected from `meanNs`
+};
+
+/**
+ * @brief Every repetition of a benchmark and their statistics.
+ */
+struct RepeatedResult {
+    std::vector<BenchmarkResult> runs;   ///< One entry per timed repetition, in run order
+    RunStatistics stats;                 ///< Wall-time distribution over `runs`
+    BenchmarkResult median;              ///< The median-time repetition (lower middle for even counts)
+    std::size_t medianIndex = 0;         ///< Index of `median` in `runs`
+};
+
+/**
+ * @brief Median of a sorted sample.
+ * @param sorted Ascending values (non-empty)
+ * @return Middle value, or the mean of the two middle values
+ */
+inline double sortedMedian(const std::vector<double>& sorted) {
+    std::size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+/**
+ * @brief Computes min, median, p90, p99, MAD and the outlier-rejected mean of wall times.
+ * @param runs Timed repetitions (non-empty)
+ * @return Distribution statistics (`warmup` left at 0)
+ */
+inline RunStatistics computeRunStatistics(const std::vector<BenchmarkResult>& runs) {
+    std::vector<double> times;
+    for (const BenchmarkResult& run : runs) times.push_back(static_cast<double>(run.elapsedNs));
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&](double q) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(times.size())));
+        return times[std::min(times.size(), std::max<std::size_t>(rank, 1)) - 1];
+    };
+
+    RunStatistics stats;
+    stats.repetitions = static_cast<int>(times.size());
+    stats.minNs = times.front();
+    stats.medianNs = sortedMedian(times);
+    stats.p90Ns = percentile(0.90);
+    stats.p99Ns = percentile(0.99);
+
+    std::vector<double> deviations;
+    for (double t : times) deviations.push_back(std::fabs(t - stats.medianNs));
+    std::sort(deviations.begin(), deviations.end());
+    stats.madNs = sortedMedian(deviations);
+
+    double cutoff = 3.0 * 1.4826 * stats.madNs;
+    double sum = 0.0;
+    int kept = 0;
+    for (double t : times) {
+        if (stats.madNs > 0.0 && std::fabs(t - stats.medianNs) > cutoff) {
+            ++stats.outliers;
+            continue;
+        }
+        sum += t;
+        ++kept;
+    }
+    stats.meanNs = sum / std::max(1, kept);
+    return stats;
+}
+
+/**
+ * @brief Runs `RepeatConfig` warmup calls, then times each repetition with `measure()`.
+ * @param name   Name of the benchmark
+ * @param trials Total number of Monte Carlo trials per call
+ * @param func   Function that returns number of hits
+ * @return Every repetition, their statistics and the median repetition
+ */
+inline RepeatedResult measureRepeated(const std::string& name, std::int64_t trials, const std::function<std::int64_t()>& func) {
+    const RepeatConfig& config = RepeatConfig::global();
+    for (int i = 0; i < config.warmup; ++i) {
+        std::int64_t hits = func();
+        doNotOptimize(hits);
+    }
+
+    RepeatedResult repeated;
+    for (int i = 0; i < std::max(1, config.repetitions); ++i) repeated.runs.push_back(measure(name, trials, func));
+
+    repeated.stats = computeRunStatistics(repeated.runs);
+    repeated.stats.warmup = config.warmup;
+
+    std::vector<std::size_t> order(repeated.runs.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return repeated.runs[a].elapsedNs < repeated.runs[b].elapsedNs;
+    });
+    repeated.medianIndex = order[(order.size() - 1) / 2];
+    repeated.median = repeated.runs[repeated.medianIndex];
+    return repeated;
+}
+
+/**
+ * @brief Prints the wall-time distribution line of a repeated benchmark.
+ * @param stats Statistics from `measureRepeated()`
+ */
+inline void printRunStatistics(const RunStatistics& stats) {
+    std::cout << "  Repetitions: " << stats.repetitions << " (+" << stats.warmup << " warmup)"
+              << " min " << stats.minNs / 1e9 << "s, median " << stats.medianNs / 1e9 << "s, p90 "
+              << stats.p90Ns / 1e9 << "s, p99 " << stats.p99Ns / 1e9 << "s, MAD " << stats.madNs / 1e9
+              << "s, outliers " << stats.outliers << "\n";
+}
+
+/**
+ * @brief Prints one `[PERF]` record per repetition when counters are enabled (`--counters`).
+ * @param runs Timed repetitions, in run order
+ */
+inline void printBenchmarkRecords(const std::vector<BenchmarkResult>& runs) {
+    if (!PerfCounters::global().active()) return;
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        printPerfRecord(runs[i].trials, runs[i].elapsedNs, runs[i].counters, static_cast<int>(i));
+    }
+}
+
+/**
+ * @brief Like `benchmark()`, but returns every repetition (e.g. for the Arrow result log).
+ * @param name   Name of the benchmark
+ * @param trials Total number of Monte Carlo trials
+ * @param func   Function that returns number of hits
+ * @return Every repetition, their statistics and the median repetition
+ */
+inline RepeatedResult benchmarkRepeated(const std::string& name, std::int64_t trials, const std::function<std::int64_t()>& func) {
+    RepeatedResult repeated = measureRepeated(name, trials, func);
+    printBenchmarkResult(repeated.median);
+    if (repeated.stats.repetitions > 1) printRunStatistics(repeated.stats);
+    printBenchmarkRecords(repeated.runs);
+    return repeated;
+}
 
 /**
- * @brief Benchmark wrapper that logs wall time and CPU cycles.
+ * @brief Benchmark wrapper: warmup, timed repetitions, and a printed summary.
  *
- * Times the execution of a function using both std::chrono.
- * Outputs hit count and estimate of π.
- * duration in seconds and nanoseconds
+ * With `RepeatConfig` defaults this times exactly one call. With more repetitions the block
+ * shows the median repetition, followed by the distribution line; with counters enabled each
+ * repetition also gets its own `[PERF]` record.
  *
  * @param name      Name of the benchmark (e.g., "SIMD")
  * @param trials    Total number of Monte Carlo trials
  * @param func      Function that returns number of hits
+ * @return The median repetition
  */
-inline void benchmark(const std::string& name, int trials, std::function<int()> func) {
-    auto start = std::chrono::high_resolution_clock::now();
+inline BenchmarkResult benchmark(const std::string& name, std::int64_t trials, std::function<std::int64_t()> func) {
+    return benchmarkRepeated(name, trials, func).median;
+}
 
-    int hits = func();
+/**
+ * @brief Prints the CPU clock setup that makes repeated runs drift, when the OS exposes it.
+ *
+ * Reads cpufreq (governor, current / max clock) and the turbo switch of intel_pstate or
+ * acpi-cpufreq from sysfs (`readCpuClock()`), falling back to the `cpu MHz` field of
+ * `/proc/cpuinfo`. Prints a `[WARN]` when the governor is not `performance`. Prints nothing
+ * if neither source exists.
+ */
+inline void printCpuFrequencyInfo() {
+    CpuClock clock = readCpuClock();
+    const std::string& governor = clock.governor;
+    const std::string& turbo = clock.turbo;
 
-    auto end = std::chrono::high_resolution_clock::now();
+    if (clock.curKHz <= 0.0 && clock.cpuinfoMHz <= 0.0) return;
 
-    double piEstimate = 4.0 * hits / trials;
-    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << "[INFO] CPU clock: ";
+    if (clock.curKHz > 0.0) {
+        std::cout << clock.curKHz / 1e6 << " GHz";
+        if (clock.maxKHz > 0.0) std::cout << " (max " << clock.maxKHz / 1e6 << " GHz)";
+    } else {
+        std::cout << clock.cpuinfoMHz / 1e3 << " GHz (/proc/cpuinfo)";
+    }
+    if (!governor.empty()) std::cout << ", governor " << governor;
+    if (!turbo.empty()) std::cout << ", turbo " << turbo;
+    std::cout << "\n";
+
+    if (!governor.empty() && governor != "performance") {
+        std::cout << "[WARN] CPU governor is '" << governor << "', not 'performance'; clocks may vary between repetitions\n";
+    }
+}
+
+/**
+ * @brief Thread-scaling sweep mode.
+ */
+enum class ScalingMode {
+    Strong,     ///< Fixed total trials; more threads should take less time
+    Weak,       ///< Fixed trials per thread; more threads should take the same time
+};
+
+/**
+ * @brief One thread count of a scaling sweep.
+ */
+struct ScalingPoint {
+    unsigned threads;           ///< Worker threads used
+    BenchmarkResult result;     ///< Timing and accuracy at this thread count
+    double speedup;             ///< Speedup over the 1-thread point (scaled speedup in weak mode)
+    double efficiency;          ///< Parallel efficiency (1.0 = perfect scaling)
+    double throughput;          ///< Trials per second
+};
+
+/**
+ * @brief Thread counts for a sweep up to `maxThreads`: powers of two, then `maxThreads` itself.
+ * @param maxThreads Largest thread count
+ * @return Increasing thread counts starting at 1
+ */
+inline std::vector<unsigned> sweepThreadCounts(unsigned maxThreads) {
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads > 0 ? maxThreads : 1);
+    return counts;
+}
+
+/**
+ * @brief Runs a method at each thread count and derives speedup, efficiency and throughput.
+ *
+ * The first thread count is the baseline and should be 1 (as from `sweepThreadCounts`).
+ *
+ * @param mode     Strong (fixed total trials) or weak (fixed trials per thread)
+ * @param trials   Total trials (strong) or trials per thread (weak)
+ * @param counts   Thread counts to run, baseline first
+ * @param run      Runs and times (`measure`) `trials` trials on `threads` workers; setup such as
+ *                 starting the workers stays outside the timed region
+ * @return One point per thread count
+ */
+inline std::vector<ScalingPoint> scalingSweep(ScalingMode mode, std::int64_t trials,
+                                              const std::vector<unsigned>& counts,
+                                              const std::function<BenchmarkResult(unsigned threads, std::int64_t trials)>& run) {
+    std::vector<ScalingPoint> points;
+    double baselineNs = 0.0;
+
+    for (unsigned threads : counts) {
+        std::int64_t pointTrials = mode == ScalingMode::Strong ? trials : trials * threads;
+        BenchmarkResult result = run(threads, pointTrials);
+
+        double ns = static_cast<double>(std::max(1LL, result.elapsedNs));
+        if (points.empty()) baselineNs = ns;
+
+        double speedup = mode == ScalingMode::Strong ? baselineNs / ns : threads * baselineNs / ns;
+        points.push_back({threads, result, speedup, speedup / threads, static_cast<double>(pointTrials) / (ns / 1e9)});
+    }
+    return points;
+}
+
+/**
+ * @brief Prints a scaling sweep as a table.
+ * @param name   Method label
+ * @param mode   Sweep mode
+ * @param trials Total trials (strong) or trials per thread (weak)
+ * @param points Sweep results
+ */
+inline void printScalingReport(const std::string& name, ScalingMode mode, std::int64_t trials,
+                               const std::vector<ScalingPoint>& points) {
+    std::cout << name << " — " << (mode == ScalingMode::Strong ? "strong" : "weak") << " scaling ("
+              << trials << (mode == ScalingMode::Strong ? " trials total" : " trials per thread") << "):\n"
+              << "  Threads      Time (s)      Trials/s   Speedup  Efficiency     Error\n";
+
+    for (const ScalingPoint& point : points) {
+        std::cout << "  " << std::setw(7) << point.threads
+                  << std::fixed << std::setprecision(6) << std::setw(14) << point.result.elapsedNs / 1e9
+                  << std::scientific << std::setprecision(3) << std::setw(14) << point.throughput
+                  << std::fixed << std::setprecision(2) << std::setw(10) << point.speedup
+                  << std::setw(11) << point.efficiency * 100.0 << "%"
+                  << std::scientific << std::setprecision(2) << std::setw(10) << point.result.absError << "\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+}
+
+/// Repetitions per trial count in a convergence sweep when `--reps` is left at 1.
+constexpr int kConvergenceRepetitions = 10;
+
+/**
+ * @brief One trial count of a convergence sweep.
+ */
+struct ConvergencePoint {
+    std::int64_t trials;        ///< Trials per repetition
+    double rmse;                ///< Root-mean-square error of π̂ over the repetitions
+    double medianNs;            ///< Median wall time of one repetition
+};
+
+/**
+ * @brief Power-law fit `rmse ≈ exp(logScale) · trials^slope` of a convergence sweep.
+ */
+struct ConvergenceFit {
+    double slope = 0.0;         ///< Convergence order (−0.5 for i.i.d. darts)
+    double logScale = 0.0;      ///< Intercept in log space
+    double nsPerTrial = 0.0;    ///< Wall time per trial at the largest trial count
+    bool valid = false;         ///< At least two points with non-zero error and a falling fit
+};
+
+/**
+ * @brief Trial counts for a convergence sweep: powers of 4 from 4096, then `maxTrials` itself.
+ * @param maxTrials Largest trial count
+ * @return Increasing trial counts
+ */
+inline std::vector<std::int64_t> convergenceTrialCounts(std::int64_t maxTrials) {
+    std::vector<std::int64_t> counts;
+    for (std::int64_t t = 4096; t < maxTrials; t *= 4) counts.push_back(t);
+    counts.push_back(maxTrials);
+    return counts;
+}
+
+/**
+ * @brief Root-mean-square error of π̂ over repetitions.
+ * @param runs Timed repetitions (non-empty)
+ * @return sqrt(mean(|π̂ − π|²))
+ */
+inline double rootMeanSquareError(const std::vector<BenchmarkResult>& runs) {
+    double sum = 0.0;
+    for (const BenchmarkResult& run : runs) sum += run.absError * run.absError;
+    return std::sqrt(sum / static_cast<double>(std::max<std::size_t>(1, runs.size())));
+}
+
+/**
+ * @brief Least-squares fit of log RMSE against log trials.
+ * @param points Convergence sweep (points with zero error are skipped)
+ * @return Fit, `valid` only if the error falls with more trials
+ */
+inline ConvergenceFit fitConvergence(const std::vector<ConvergencePoint>& points) {
+    ConvergenceFit fit;
+    if (!points.empty()) fit.nsPerTrial = points.back().medianNs / static_cast<double>(points.back().trials);
+
+    double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    for (const ConvergencePoint& point : points) {
+        if (!(point.rmse > 0.0)) continue;
+        double lx = std::log(static_cast<double>(point.trials));
+        double ly = std::log(point.rmse);
+        n += 1.0;
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+    }
+    double denominator = n * sxx - sx * sx;
+    if (n < 2.0 || denominator <= 0.0) return fit;
+
+    fit.slope = (n * sxy - sx * sy) / denominator;
+    fit.logScale = (sy - fit.slope * sx) / n;
+    fit.valid = fit.slope < 0.0;
+    return fit;
+}
+
+/**
+ * @brief Estimated trials to reach an RMSE target, extrapolated along a fit.
+ * @param fit    Convergence fit (`valid`)
+ * @param target RMSE target
+ * @return Trials (may exceed any trial count actually run)
+ */
+inline double trialsForError(const ConvergenceFit& fit, double target) {
+    return std::exp((std::log(target) - fit.logScale) / fit.slope);
+}
+
+/**
+ * @brief Runs a method at each trial count and records RMSE and median time.
+ * @param counts Trial counts, increasing
+ * @param run    Runs and times (`measureRepeated`) one trial count; repetitions must be independent
+ * @return One point per trial count
+ */
+inline std::vector<ConvergencePoint> convergenceSweep(const std::vector<std::int64_t>& counts,
+                                                      const std::function<RepeatedResult(std::int64_t trials)>& run) {
+    std::vector<ConvergencePoint> points;
+    for (std::int64_t trials : counts) {
+        RepeatedResult repeated = run(trials);
+        points.push_back({trials, rootMeanSquareError(repeated.runs), repeated.stats.medianNs});
+    }
+    return points;
+}
+
+/**
+ * @brief Prints a convergence sweep: error against trials and against time, plus the fitted order.
+ *
+ * `RMSE·√N` is flat for i.i.d. darts and falls for strategies that converge faster; efficiency
+ * `1 / (RMSE² · t)` compares strategies at equal cost (higher is better).
+ *
+ * @param name        Method label
+ * @param points      Sweep results
+ * @param fit         Fit of the sweep
+ * @param targetError RMSE target for the time-to-precision estimate (0 = none)
+ */
+inline void printConvergenceReport(const std::string& name, const std::vector<ConvergencePoint>& points,
+                                   const ConvergenceFit& fit, double targetError) {
+    std::cout << name << " — convergence:\n"
+              << "          Trials        RMSE      Time (s)   RMSE·√N   Efficiency\n";
+
+    for (const ConvergencePoint& point : points) {
+        double seconds = point.medianNs / 1e9;
+        double efficiency = point.rmse > 0.0 && seconds > 0.0 ? 1.0 / (point.rmse * point.rmse * seconds) : 0.0;
+        std::cout << "  " << std::setw(14) << point.trials
+                  << std::scientific << std::setprecision(3) << std::setw(12) << point.rmse
+                  << std::fixed << std::setprecision(6) << std::setw(14) << seconds
+                  << std::scientific << std::setprecision(3) << std::setw(10) << point.rmse * std::sqrt(static_cast<double>(point.trials))
+                  << std::setw(13) << efficiency << "\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
 
-    std::cout << name << ":\n"
-              << "  Trials: " << trials << "\n"
-              << "  Hits: " << hits << "\n"
-              << "  Estimate: " << piEstimate << "\n"
-              << "  Time: " << (elapsed_ns / 1e9) << "s (" << elapsed_ns << " ns)\n";
+    if (!fit.valid) {
+        std::cout << "  Fit: error does not fall with trials (too few repetitions or points)\n";
+        return;
+    }
+    std::cout << "  Fit: RMSE ~ N^" << std::setprecision(3) << fit.slope << std::setprecision(6);
+    if (targetError > 0.0) {
+        double trials = trialsForError(fit, targetError);
+        std::cout << "; RMSE " << targetError << " needs ~" << std::setprecision(3) << trials << " trials (~"
+                  << trials * fit.nsPerTrial / 1e9 << " s" << (trials > points.back().trials ? ", extrapolated" : "")
+                  << ")" << std::setprecision(6);
+    }
+    std::cout << "\n";
 }
@@ -0,0 +1,438 @@
+// ========================================
+// buffered.hpp - Two-stage generate/count kernels
+// ========================================
+/**
+ * @file buffered.hpp
+ * @brief Decoupled pipeline: fill large SoA coordinate buffers, then count hits over whole buffers.
+ *
+ * `monteCarloPI_SIMD` interleaves generating one vector of darts with one compare, through
+ * tiny `randX[batch]` stack arrays, so neither the RNG nor the compare ever runs long enough to
+ * reach steady-state throughput. `SIMDBuffered` splits the work into two stages per buffer:
+ *
+ * | Stage    | Work                                                   | Bound by                     |
+ * |----------|--------------------------------------------------------|------------------------------|
+ * | generate | xoshiro256+ lanes → aligned `x[]`, `y[]` stores        | RNG ALU chain, store port    |
+ * | count    | 4× unrolled load / `x² + y² ≤ 1` / mask-accumulate     | load ports, FP multiply      |
+ *
+ * Each stage loops over a full buffer with no other work in its body, and the count stage keeps
+ * four independent vector accumulators so consecutive compares never wait on each other.
+ *
+ * ---
+ *
+ * ## Buffers
+ * - Structure of arrays: one `double` buffer per axis, 64-byte aligned for full-width loads
+ * - Allocated per call from the kernel's `thread_local PoolAllocator` (huge-page backed where
+ *   available), so after the first chunk no call touches the heap
+ * - Size is a runtime knob (`BufferConfig`, CLI `--buffer`), rounded up to a multiple of 64
+ *   trials; the default of 2048 trials is 32 KiB for both axes — one L1d. Larger values trade
+ *   L1 for L2 residency and show where the count stage becomes load-bound
+ *
+ * ## Stage Timing
+ * Each call times its two stages per buffer and publishes the totals once into
+ * `BufferedStageStats`, so the benchmark can report the generate/count split. Times are summed
+ * over workers (CPU time, not wall time); the clock reads add two `steady_clock` calls per
+ * buffer, negligible at the default size.
+ *
+ * ## Reproducibility
+ * The generate stage draws exactly the vectors `monteCarloPI_SIMD_XOSHIRO` does, in the same
+ * order, so under `--seed` both methods produce identical hit counts on the same backend.
+ */
+
+#pragma once
+
+#include "montecarlo.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// Pool size for buffered kernels: one 2 MiB huge page holds the default buffers many times over.
+constexpr std::size_t kBufferedPoolBytes = std::size_t{2} << 20;
+
+/**
+ * @brief Runtime buffer size for the two-stage kernels.
+ */
+struct BufferConfig {
+    std::size_t trials = 2048;   ///< Trials per buffer (darts per axis), a multiple of 64
+
+    /**
+     * @brief Process-wide configuration. Set before starting any run.
+     * @return Reference to the global configuration
+     */
+    static BufferConfig& global() {
+        static BufferConfig instance;
+        return instance;
+    }
+
+    /**
+     * @brief Set the buffer size, rounded up to a multiple of 64 trials.
+     * @param requested Trials per buffer (at least 1)
+     * @return Effective trials per buffer
+     */
+    static std::size_t set(std::size_t requested) {
+        global().trials = (std::max<std::size_t>(requested, 1) + 63) & ~std::size_t{63};
+        return global().trials;
+    }
+};
+
+/**
+ * @brief Generate/count time accumulated by all buffered kernel calls since `reset()`.
+ */
+struct BufferedStageStats {
+    std::atomic<long long> generateNs{0};   ///< Summed generate-stage time
+    std::atomic<long long> countNs{0};      ///< Summed count-stage time
+
+    /**
+     * @brief Process-wide stats.
+     * @return Reference to the global stats
+     */
+    static BufferedStageStats& global() {
+        static BufferedStageStats instance;
+        return instance;
+    }
+
+    /**
+     * @brief Add one call's stage times (once per call, not per buffer).
+     * @param generate Generate-stage nanoseconds
+     * @param count    Count-stage nanoseconds
+     */
+    void add(long long generate, long long count) {
+        generateNs.fetch_add(generate, std::memory_order_relaxed);
+        countNs.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Clear both totals before a run.
+     */
+    void reset() {
+        generateNs.store(0, std::memory_order_relaxed);
+        countNs.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Scalar stages: one xoshiro256+ stream per axis, four scalar accumulators.
+ */
+struct BufferedStagesScalar {
+    static constexpr int lanes = 1;   ///< Darts per generator step
+    Xoshiro256Plus genX, genY;        ///< Per-axis generators
+
+    /**
+     * @brief Seed both axis generators.
+     * @param seeder Seed sequence (consumed in X, Y order)
+     */
+    explicit BufferedStagesScalar(SplitMix64& seeder) : genX(seeder), genY(seeder) {}
+
+    /**
+     * @brief Generate stage: fill `n` darts per axis.
+     * @param x Buffer for x coordinates
+     * @param y Buffer for y coordinates
+     * @param n Darts to generate (multiple of `lanes`)
+     */
+    void fill(double* x, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = genX.nextDouble();
+            y[i] = genY.nextDouble();
+        }
+    }
+
+    /**
+     * @brief Count stage: hits among the first `n` darts.
+     * @param x Buffer of x coordinates
+     * @param y Buffer of y coordinates
+     * @param n Darts to count
+     * @return Hits inside the circle
+     */
+    std::int64_t count(const double* x, const double* y, std::size_t n) {
+        std::int64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            c0 += isInsideCircle(x[i], y[i]);
+            c1 += isInsideCircle(x[i + 1], y[i + 1]);
+            c2 += isInsideCircle(x[i + 2], y[i + 2]);
+            c3 += isInsideCircle(x[i + 3], y[i + 3]);
+        }
+        for (; i < n; ++i) c0 += isInsideCircle(x[i], y[i]);
+        return c0 + c1 + c2 + c3;
+    }
+};
+
+#ifdef USE_AVX
+/**
+ * @brief AVX2 stages: 4-lane generators, 4 × 4-lane accumulators (16 darts per count iteration).
+ *
+ * Only construct when `cpuSupportsAVX2()` is true.
+ */
+struct BufferedStagesAVX2 {
+    static constexpr int lanes = 4;   ///< Darts per generator step
+    Xoshiro256PlusAVX genX, genY;     ///< Per-axis generators
+
+    /**
+     * @brief Seed both axis generators.
+     * @param seeder Seed sequence (consumed in X, Y order)
+     */
+    MC_TARGET_AVX2 explicit BufferedStagesAVX2(SplitMix64& seeder) : genX(seeder), genY(seeder) {}
+
+    /**
+     * @brief Generate stage: fill `n` darts per axis with aligned stores.
+     * @param x Buffer for x coordinates (32-byte aligned)
+     * @param y Buffer for y coordinates (32-byte aligned)
+     * @param n Darts to generate (multiple of `lanes`)
+     */
+    MC_TARGET_AVX2 void fill(double* x, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; i += lanes) {
+            _mm256_store_pd(x + i, genX.nextDouble());
+            _mm256_store_pd(y + i, genY.nextDouble());
+        }
+    }
+
+    /**
+     * @brief Count stage: hits among the first `n` darts.
+     *
+     * Compare masks are all-ones (−1) per hit lane, so subtracting them counts hits in 64-bit lanes.
+     *
+     * @param x Buffer of x coordinates (32-byte aligned)
+     * @param y Buffer of y coordinates (32-byte aligned)
+     * @param n Darts to count
+     * @return Hits inside the circle
+     */
+    MC_TARGET_AVX2 std::int64_t count(const double* x, const double* y, std::size_t n) {
+        const __m256d one = _mm256_set1_pd(1.0);
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+        std::size_t i = 0;
+        for (; i + 4 * lanes <= n; i += 4 * lanes) {
+            acc0 = _mm256_sub_epi64(acc0, insideMask(x + i, y + i, one));
+            acc1 = _mm256_sub_epi64(acc1, insideMask(x + i + lanes, y + i + lanes, one));
+            acc2 = _mm256_sub_epi64(acc2, insideMask(x + i + 2 * lanes, y + i + 2 * lanes, one));
+            acc3 = _mm256_sub_epi64(acc3, insideMask(x + i + 3 * lanes, y + i + 3 * lanes, one));
+        }
+        for (; i + lanes <= n; i += lanes) acc0 = _mm256_sub_epi64(acc0, insideMask(x + i, y + i, one));
+
+        alignas(32) std::int64_t lanesSum[lanes];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanesSum),
+                           _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3)));
+        std::int64_t hits = lanesSum[0] + lanesSum[1] + lanesSum[2] + lanesSum[3];
+
+        for (; i < n; ++i) hits += isInsideCircle(x[i], y[i]);
+        return hits;
+    }
+
+    /**
+     * @brief All-ones lanes where `x² + y² ≤ 1` for one vector of darts.
+     * @param x   Pointer to 4 x coordinates (32-byte aligned)
+     * @param y   Pointer to 4 y coordinates (32-byte aligned)
+     * @param one Broadcast 1.0
+     * @return Compare mask as 64-bit integer lanes
+     */
+    MC_TARGET_AVX2 static __m256i insideMask(const double* x, const double* y, __m256d one) {
+        __m256d dx = _mm256_load_pd(x);
+        __m256d dy = _mm256_load_pd(y);
+        __m256d dist2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        return _mm256_castpd_si256(_mm256_cmp_pd(dist2, one, _CMP_LE_OQ));
+    }
+};
+#endif
+
+#ifdef USE_AVX512
+/**
+ * @brief AVX-512 stages: 8-lane generators, 4 × 8-lane masked accumulators (32 darts per count iteration).
+ *
+ * Only construct when `cpuSupportsAVX512()` is true.
+ */
+struct BufferedStagesAVX512 {
+    static constexpr int lanes = 8;   ///< Darts per generator step
+    Xoshiro256PlusAVX512 genX, genY;  ///< Per-axis generators
+
+    /**
+     * @brief Seed both axis generators.
+     * @param seeder Seed sequence (consumed in X, Y order)
+     */
+    MC_TARGET_AVX512 explicit BufferedStagesAVX512(SplitMix64& seeder) : genX(seeder), genY(seeder) {}
+
+    /**
+     * @brief Generate stage: fill `n` darts per axis with aligned stores.
+     * @param x Buffer for x coordinates (64-byte aligned)
+     * @param y Buffer for y coordinates (64-byte aligned)
+     * @param n Darts to generate (multiple of `lanes`)
+     */
+    MC_TARGET_AVX512 void fill(double* x, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; i += lanes) {
+            _mm512_store_pd(x + i, genX.nextDouble());
+            _mm512_store_pd(y + i, genY.nextDouble());
+        }
+    }
+
+    /**
+     * @brief Count stage: hits among the first `n` darts.
+     *
+     * The compare writes a `__mmask8`; a masked add bumps only the hit lanes of each accumulator.
+     *
+     * @param x Buffer of x coordinates (64-byte aligned)
+     * @param y Buffer of y coordinates (64-byte aligned)
+     * @param n Darts to count
+     * @return Hits inside the circle
+     */
+    MC_TARGET_AVX512 std::int64_t count(const double* x, const double* y, std::size_t n) {
+        const __m512d one = _mm512_set1_pd(1.0);
+        const __m512i increment = _mm512_set1_epi64(1);
+        __m512i acc0 = _mm512_setzero_si512(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+        std::size_t i = 0;
+        for (; i + 4 * lanes <= n; i += 4 * lanes) {
+            acc0 = _mm512_mask_add_epi64(acc0, insideMask(x + i, y + i, one), acc0, increment);
+            acc1 = _mm512_mask_add_epi64(acc1, insideMask(x + i + lanes, y + i + lanes, one), acc1, increment);
+            acc2 = _mm512_mask_add_epi64(acc2, insideMask(x + i + 2 * lanes, y + i + 2 * lanes, one), acc2, increment);
+            acc3 = _mm512_mask_add_epi64(acc3, insideMask(x + i + 3 * lanes, y + i + 3 * lanes, one), acc3, increment);
+        }
+        for (; i + lanes <= n; i += lanes) {
+            acc0 = _mm512_mask_add_epi64(acc0, insideMask(x + i, y + i, one), acc0, increment);
+        }
+
+        alignas(64) std::int64_t lanesSum[lanes];
+        _mm512_store_si512(lanesSum, _mm512_add_epi64(_mm512_add_epi64(acc0, acc1), _mm512_add_epi64(acc2, acc3)));
+        std::int64_t hits = 0;
+        for (std::int64_t lane : lanesSum) hits += lane;
+
+        for (; i < n; ++i) hits += isInsideCircle(x[i], y[i]);
+        return hits;
+    }
+
+    /**
+     * @brief Hit mask for one vector of darts.
+     * @param x   Pointer to 8 x coordinates (64-byte aligned)
+     * @param y   Pointer to 8 y coordinates (64-byte aligned)
+     * @param one Broadcast 1.0
+     * @return Bit i set when dart i is inside the circle
+     */
+    MC_TARGET_AVX512 static __mmask8 insideMask(const double* x, const double* y, __m512d one) {
+        __m512d dx = _mm512_load_pd(x);
+        __m512d dy = _mm512_load_pd(y);
+        return _mm512_cmp_pd_mask(_mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy)), one, _CMP_LE_OQ);
+    }
+};
+#endif
+
+#ifdef USE_NEON
+/**
+ * @brief NEON stages: 2-lane generators, 4 × 2-lane accumulators (8 darts per count iteration).
+ */
+struct BufferedStagesNEON {
+    static constexpr int lanes = 2;   ///< Darts per generator step
+    Xoshiro256PlusNEON genX, genY;    ///< Per-axis generators
+
+    /**
+     * @brief Seed both axis generators.
+     * @param seeder Seed sequence (consumed in X, Y order)
+     */
+    explicit BufferedStagesNEON(SplitMix64& seeder) : genX(seeder), genY(seeder) {}
+
+    /**
+     * @brief Generate stage: fill `n` darts per axis.
+     * @param x Buffer for x coordinates
+     * @param y Buffer for y coordinates
+     * @param n Darts to generate (multiple of `lanes`)
+     */
+    void fill(double* x, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; i += lanes) {
+            vst1q_f64(x + i, genX.nextDouble());
+            vst1q_f64(y + i, genY.nextDouble());
+        }
+    }
+
+    /**
+     * @brief Count stage: hits among the first `n` darts.
+     *
+     * `vcleq_f64` yields all-ones (−1) per hit lane, so subtracting it counts hits.
+     *
+     * @param x Buffer of x coordinates
+     * @param y Buffer of y coordinates
+     * @param n Darts to count
+     * @return Hits inside the circle
+     */
+    std::int64_t count(const double* x, const double* y, std::size_t n) {
+        const float64x2_t one = vdupq_n_f64(1.0);
+        uint64x2_t acc0 = vdupq_n_u64(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+        std::size_t i = 0;
+        for (; i + 4 * lanes <= n; i += 4 * lanes) {
+            acc0 = vsubq_u64(acc0, insideMask(x + i, y + i, one));
+            acc1 = vsubq_u64(acc1, insideMask(x + i + lanes, y + i + lanes, one));
+            acc2 = vsubq_u64(acc2, insideMask(x + i + 2 * lanes, y + i + 2 * lanes, one));
+            acc3 = vsubq_u64(acc3, insideMask(x + i + 3 * lanes, y + i + 3 * lanes, one));
+        }
+        for (; i + lanes <= n; i += lanes) acc0 = vsubq_u64(acc0, insideMask(x + i, y + i, one));
+
+        uint64x2_t acc = vaddq_u64(vaddq_u64(acc0, acc1), vaddq_u64(acc2, acc3));
+        std::int64_t hits = static_cast<std::int64_t>(vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1));
+
+        for (; i < n; ++i) hits += isInsideCircle(x[i], y[i]);
+        return hits;
+    }
+
+    /**
+     * @brief All-ones lanes where `x² + y² ≤ 1` for one vector of darts.
+     * @param x   Pointer to 2 x coordinates
+     * @param y   Pointer to 2 y coordinates
+     * @param one Broadcast 1.0
+     * @return Compare mask
+     */
+    static uint64x2_t insideMask(const double* x, const double* y, float64x2_t one) {
+        float64x2_t dx = vld1q_f64(x);
+        float64x2_t dy = vld1q_f64(y);
+        return vcleq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)), one);
+    }
+};
+#endif
+
+/**
+ * @brief Two-stage kernel: per buffer, generate all darts, then count all hits.
+ *
+ * Instantiated once per ISA (`Stages` = `BufferedStages<ISA>`); each instantiation keeps its
+ * own `thread_local` pool. Only call an ISA's instantiation when its CPU check passes.
+ *
+ * @tparam Stages Generate/count stage implementation
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <typename Stages>
+inline std::int64_t* runBufferedStages(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(kBufferedPoolBytes, PoolPages::Huge);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    const std::size_t bufferTrials = BufferConfig::global().trials;
+    double* bufferX = pool.allocate_array<double>(bufferTrials, 64);
+    double* bufferY = pool.allocate_array<double>(bufferTrials, 64);
+    if (!bufferX || !bufferY) throw PoolExhausted();
+
+    SplitMix64 seeder{chunkSeed()};
+    Stages stages(seeder);
+
+    std::int64_t count = 0;
+    long long generateNs = 0, countNs = 0;
+
+    for (std::int64_t done = 0; done < numberOfTrials; done += static_cast<std::int64_t>(bufferTrials)) {
+        std::size_t n = static_cast<std::size_t>(std::min<std::int64_t>(bufferTrials, numberOfTrials - done));
+        std::size_t generated = (n + Stages::lanes - 1) / Stages::lanes * Stages::lanes;
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            MC_TRACE_SCOPE_ARG("rng.fill", generated);
+            stages.fill(bufferX, bufferY, generated);
+        }
+        auto filled = std::chrono::steady_clock::now();
+        {
+            MC_TRACE_SCOPE_ARG("count", n);
+            count += stages.count(bufferX, bufferY, n);
+        }
+        auto counted = std::chrono::steady_clock::now();
+
+        generateNs += std::chrono::duration_cast<std::chrono::nanoseconds>(filled - start).count();
+        countNs += std::chrono::duration_cast<std::chrono::nanoseconds>(counted - filled).count();
+    }
+
+    BufferedStageStats::global().add(generateNs, countNs);
+    *hits = count;
+    return hits;
+}
@@ -0,0 +1,180 @@
+// ========================================
+// cli.hpp - Shared command-line parsing
+// ========================================
+/**
+ * @file cli.hpp
+ * @brief Option matching and the numeric / batch options shared by `montecarlo` and `microbench`.
+ *
+ * Both entry points accept `--name value` and `--name=value`, parse counts the same way and
+ * report invalid values with the same `[ERROR]` lines, so a flag means one thing in either binary.
+ *
+ * | Helper              | Option / argument                                    |
+ * |---------------------|------------------------------------------------------|
+ * | `takeOption`        | Any `--name value` / `--name=value` option           |
+ * | `parseTrialCount`   | Positional trial / operation count (`1e8`, `100000`)  |
+ * | `parseCountOption`  | Bounded integer options (`--threads`, `--nodes`, ...) |
+ * | `applyRepeatCount`  | `--warmup N`, `--reps N` (`RepeatConfig`)            |
+ * | `applyBufferTrials` | `--buffer N` (`BufferConfig`)                        |
+ * | `parseDeadlineMs`   | `--deadline-ms MS` (`StopCriteria`, `JobRequest`)    |
+ * | `randomBatchId`     | Default `--batch-id` of `--arrow-out`                |
+ *
+ * ## Example
+ * ```cpp
+ * for (int i = 1; i < argc; ++i) {
+ *     std::string value;
+ *     if (takeOption(argc, argv, i, "--reps", value) && !applyRepeatCount(false, value)) return EXIT_FAILURE;
+ * }
+ * ```
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "buffered.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+/**
+ * @brief Matches `argv[i]` against one option taking a value.
+ * @param argc  Number of CLI arguments
+ * @param argv  Array of CLI argument strings
+ * @param i     Index of the current argument; advanced past the value for `--name value`
+ * @param name  Option name including the dashes
+ * @param value Option value on a match
+ * @return true if `argv[i]` is `name` followed by a value, or `name=value`
+ */
+inline bool takeOption(int argc, char* argv[], int& i, const std::string& name, std::string& value) {
+    std::string arg = argv[i];
+    if (arg == name && i + 1 < argc) {
+        value = argv[++i];
+        return true;
+    }
+    if (arg.rfind(name + "=", 0) == 0) {
+        value = arg.substr(name.size() + 1);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Parses a trial count given as an integer (`100000000`) or in scientific notation (`1e11`).
+ * @param text      CLI argument
+ * @param trials    Parsed count on success
+ * @param maxTrials Largest accepted count
+ * @return false if `text` is not a positive whole number up to `maxTrials`
+ */
+inline bool parseTrialCount(const std::string& text, std::int64_t& trials,
+                            std::int64_t maxTrials = std::numeric_limits<std::int64_t>::max()) {
+    if (text.empty()) return false;
+
+    char* end = nullptr;
+    errno = 0;
+    long long integer = std::strtoll(text.c_str(), &end, 10);
+    if (*end == '\0') {
+        if (errno == ERANGE || integer <= 0 || integer > maxTrials) return false;
+        trials = integer;
+        return true;
+    }
+
+    // Scientific notation must still name a whole number of trials
+    double value = std::strtod(text.c_str(), &end);
+    if (*end != '\0' || !(value >= 1.0) || value >= 9.2e18 || value > static_cast<double>(maxTrials) ||
+        value != std::floor(value)) {
+        return false;
+    }
+    trials = static_cast<std::int64_t>(value);
+    return true;
+}
+
+/**
+ * @brief Parses a bounded integer option value such as `--threads N`.
+ * @param what    Name used in the error, e.g. `"thread count"`
+ * @param value   Option value
+ * @param minimum Smallest accepted value
+ * @param maximum Largest accepted value
+ * @param count   Parsed value on success
+ * @return false (after an `[ERROR]`) if `value` is not a whole number from `minimum` to `maximum`
+ */
+inline bool parseCountOption(const std::string& what, const std::string& value, long long minimum,
+                             long long maximum, long long& count) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno == ERANGE || parsed < minimum || parsed > maximum) {
+        std::cerr << "[ERROR] Invalid " << what << ": " << value << " (expected " << minimum << " to " << maximum
+                  << ")\n";
+        return false;
+    }
+    count = parsed;
+    return true;
+}
+
+/**
+ * @brief Applies `--warmup N` or `--reps N` to `RepeatConfig::global()`.
+ * @param warmup true for `--warmup` (0 allowed), false for `--reps` (at least 1)
+ * @param value  Option value
+ * @return false (after an `[ERROR]`) if `value` is not a whole number in range
+ */
+inline bool applyRepeatCount(bool warmup, const std::string& value) {
+    long long count = 0;
+    if (!parseCountOption(warmup ? "warmup count" : "repetition count", value, warmup ? 0 : 1, 1'000'000, count)) {
+        return false;
+    }
+    (warmup ? RepeatConfig::global().warmup : RepeatConfig::global().repetitions) = static_cast<int>(count);
+    return true;
+}
+
+/**
+ * @brief Applies `--buffer N` to `BufferConfig` (rounded up to a multiple of 64).
+ * @param value Option value
+ * @return false (after an `[ERROR]`) if `value` is not 1 to 2^30 trials
+ */
+inline bool applyBufferTrials(const std::string& value) {
+    char* end = nullptr;
+    errno = 0;
+    long long trials = std::strtoll(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno == ERANGE || trials <= 0 || trials > (1LL << 30)) {
+        std::cerr << "[ERROR] Invalid buffer size: " << value << " (expected 1 to 2^30 trials)\n";
+        return false;
+    }
+    BufferConfig::set(static_cast<std::size_t>(trials));
+    return true;
+}
+
+/**
+ * @brief Parses `--deadline-ms MS`.
+ * @param value    Option value
+ * @param deadline Parsed deadline on success
+ * @return false (after an `[ERROR]`) if `value` is not 1 to 10^9 milliseconds
+ */
+inline bool parseDeadlineMs(const std::string& value, std::chrono::milliseconds& deadline) {
+    char* end = nullptr;
+    errno = 0;
+    long long ms = std::strtoll(value.c_str(), &end, 10);
+    // The cap (about 11.6 days) keeps the deadline far from overflowing int64 nanoseconds
+    if (value.empty() || *end != '\0' || errno == ERANGE || ms <= 0 || ms > 1'000'000'000) {
+        std::cerr << "[ERROR] Invalid deadline: " << value << " (expected 1 to 1000000000 milliseconds)\n";
+        return false;
+    }
+    deadline = std::chrono::milliseconds(ms);
+    return true;
+}
+
+/**
+ * @brief Batch id used when `--arrow-out` is given without `--batch-id`.
+ * @return 8 random hex digits
+ */
+inline std::string randomBatchId() {
+    std::uint32_t id = std::random_device{}();
+    char hex[9];
+    std::snprintf(hex, sizeof(hex), "%08x", id);
+    return hex;
+}
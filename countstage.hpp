@@ -0,0 +1,187 @@
+// ========================================
+// countstage.hpp - Compare/count stage in isolation
+// ========================================
+/**
+ * @file countstage.hpp
+ * @brief Hit-count kernels over pre-generated SoA darts, so the compare/count stage is timed without the RNG.
+ *
+ * `countInsideCircle_AVX` ends every 4-lane batch with `_mm256_movemask_pd` → `popcount` → scalar
+ * add: a vector-to-GPR transfer per batch and one loop-carried scalar chain through all of them.
+ * `countHitsUnrolled_AVX2<Chains>` instead keeps per-lane counts in vector registers and
+ * subtracts the all-ones compare masks as 64-bit integers, across `Chains` independent
+ * accumulators, so consecutive compares never wait on each other and the horizontal sum runs
+ * once per buffer:
+ *
+ * | Kernel                        | Per 4 darts                          | Reduction        |
+ * |-------------------------------|--------------------------------------|------------------|
+ * | `countHitsMovemask_AVX2`      | cmp, movemask, popcnt, scalar add    | every batch      |
+ * | `countHitsUnrolled_AVX2<4/8>` | cmp, `vpsubq` into chain `i % Chains`| once per buffer  |
+ *
+ * ---
+ *
+ * ## Harness
+ * `--count-stage` (`runCountStageBenchmark`) fills one `--buffer`-sized pair of buffers with
+ * xoshiro256+ darts up front, then times each kernel over as many passes as it takes to reach
+ * argv[1] darts. All kernels must report the same hits; any mismatch is an error. With the default
+ * 2048-trial buffer the inputs stay in L1, so the numbers are the compare/count throughput
+ * ceiling; larger buffers show when the loop becomes load-bound.
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "buffered.hpp"
+#include "montecarlo.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// Count-stage kernel: hits among the first `n` darts of aligned SoA buffers.
+using CountStageFn = std::int64_t (*)(const double*, const double*, std::size_t);
+
+/**
+ * @brief One kernel of the count-stage comparison.
+ */
+struct CountStageKernel {
+    std::string name;     ///< Label (also the logged `Method`)
+    CountStageFn count;   ///< Kernel
+};
+
+/**
+ * @brief Portable reference: `isInsideCircle` per dart, one accumulator.
+ * @param x Buffer of x coordinates
+ * @param y Buffer of y coordinates
+ * @param n Darts to count
+ * @return Hits inside the circle
+ */
+inline std::int64_t countHitsScalar(const double* x, const double* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i < n; ++i) hits += isInsideCircle(x[i], y[i]);
+    return hits;
+}
+
+#ifdef USE_AVX
+/**
+ * @brief The existing per-batch count: `countInsideCircle_AVX` on every 4 darts.
+ *
+ * Only call when `cpuSupportsAVX2()` is true.
+ *
+ * @param x Buffer of x coordinates (32-byte aligned)
+ * @param y Buffer of y coordinates (32-byte aligned)
+ * @param n Darts to count
+ * @return Hits inside the circle
+ */
+MC_TARGET_AVX2 inline std::int64_t countHitsMovemask_AVX2(const double* x, const double* y, std::size_t n) {
+    std::int64_t hits = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) hits += countInsideCircle_AVX(_mm256_load_pd(x + i), _mm256_load_pd(y + i));
+    for (; i < n; ++i) hits += isInsideCircle(x[i], y[i]);
+    return hits;
+}
+
+/**
+ * @brief Vector-accumulated count over `Chains` independent 4-lane chains.
+ *
+ * Each chain subtracts its compare mask (−1 per hit lane) from 64-bit lanes, so no lane can
+ * overflow for any buffer size; the chains are summed and reduced horizontally once at the end.
+ * Only call when `cpuSupportsAVX2()` is true.
+ *
+ * @tparam Chains Independent accumulators (1–8; 16 ymm registers bound the useful range)
+ * @param x Buffer of x coordinates (32-byte aligned)
+ * @param y Buffer of y coordinates (32-byte aligned)
+ * @param n Darts to count
+ * @return Hits inside the circle
+ */
+template <int Chains>
+MC_TARGET_AVX2 inline std::int64_t countHitsUnrolled_AVX2(const double* x, const double* y, std::size_t n) {
+    static_assert(Chains >= 1 && Chains <= 8, "1 to 8 accumulator chains");
+    constexpr std::size_t lanes = 4;
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256i acc[Chains];
+    for (int c = 0; c < Chains; ++c) acc[c] = _mm256_setzero_si256();
+
+    std::size_t i = 0;
+    for (; i + Chains * lanes <= n; i += Chains * lanes) {
+        for (int c = 0; c < Chains; ++c) {
+            acc[c] = _mm256_sub_epi64(acc[c], BufferedStagesAVX2::insideMask(x + i + c * lanes, y + i + c * lanes, one));
+        }
+    }
+    for (; i + lanes <= n; i += lanes) acc[0] = _mm256_sub_epi64(acc[0], BufferedStagesAVX2::insideMask(x + i, y + i, one));
+
+    for (int c = 1; c < Chains; ++c) acc[0] = _mm256_add_epi64(acc[0], acc[c]);
+    alignas(32) std::int64_t lanesSum[lanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanesSum), acc[0]);
+    std::int64_t hits = lanesSum[0] + lanesSum[1] + lanesSum[2] + lanesSum[3];
+
+    for (; i < n; ++i) hits += isInsideCircle(x[i], y[i]);
+    return hits;
+}
+#endif
+
+/**
+ * @brief Kernels compared by `--count-stage`, baseline first.
+ * @return The AVX2 kernels when the CPU supports them, then the scalar reference
+ */
+inline std::vector<CountStageKernel> countStageKernels() {
+    std::vector<CountStageKernel> kernels;
+#ifdef USE_AVX
+    if (cpuSupportsAVX2()) {
+        kernels.push_back({"CountMovemaskAVX2", countHitsMovemask_AVX2});
+        kernels.push_back({"CountUnrolled4AVX2", countHitsUnrolled_AVX2<4>});
+        kernels.push_back({"CountUnrolled8AVX2", countHitsUnrolled_AVX2<8>});
+    }
+#endif
+    kernels.push_back({"CountScalar", countHitsScalar});
+    return kernels;
+}
+
+/**
+ * @brief Times every count-stage kernel over the same pre-generated darts.
+ * @param totalTrials  Darts to count per kernel (rounded up to whole buffer passes)
+ * @param bufferTrials Darts per buffer (`--buffer`)
+ * @param seed         Seed of the input darts
+ * @param onResult     Called with each kernel's name and repetitions (e.g. to log rows)
+ * @return false if the kernels disagreed on the hit count
+ */
+inline bool runCountStageBenchmark(std::int64_t totalTrials, std::size_t bufferTrials, std::uint64_t seed,
+                                   const std::function<void(const std::string&, const RepeatedResult&)>& onResult) {
+    PoolAllocator pool(2 * bufferTrials * sizeof(double) + 256);
+    double* x = pool.allocate_array<double>(bufferTrials, 64);
+    double* y = pool.allocate_array<double>(bufferTrials, 64);
+    SplitMix64 seeder{seed};
+    BufferedStagesScalar(seeder).fill(x, y, bufferTrials);
+
+    std::int64_t passes = (totalTrials + static_cast<std::int64_t>(bufferTrials) - 1) / static_cast<std::int64_t>(bufferTrials);
+    std::int64_t trials = passes * static_cast<std::int64_t>(bufferTrials);
+    std::cout << "[INFO] Count stage: " << bufferTrials << "-dart buffer (" << (2 * bufferTrials * sizeof(double)) / 1024
+              << " KiB x/y SoA), " << passes << " passes per kernel, RNG excluded\n";
+
+    std::int64_t expected = countHitsScalar(x, y, bufferTrials) * passes;
+    std::vector<CountStageKernel> kernels = countStageKernels();
+    double baselineNs = 0.0;
+    bool agree = true;
+    for (const CountStageKernel& kernel : kernels) {
+        RepeatedResult repeated = benchmarkRepeated(kernel.name, trials, [&]() {
+            std::int64_t hits = 0;
+            for (std::int64_t pass = 0; pass < passes; ++pass) {
+                hits += kernel.count(x, y, bufferTrials);
+                doNotOptimize(hits);
+            }
+            return hits;
+        });
+        const BenchmarkResult& result = repeated.median;
+        double ns = static_cast<double>(result.elapsedNs) / static_cast<double>(trials);
+        if (baselineNs == 0.0) baselineNs = ns;
+        std::cout << "  " << ns << " ns/dart, speedup vs " << kernels.front().name << ": "
+                  << baselineNs / ns << "x\n";
+        if (result.hits != expected) {
+            std::cerr << "[ERROR] " << kernel.name << " counted " << result.hits << " hits, expected " << expected << "\n";
+            agree = false;
+        }
+        onResult(kernel.name, repeated);
+    }
+    return agree;
+}
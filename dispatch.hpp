@@ -0,0 +1,312 @@
+// ========================================
+// dispatch.hpp - Runtime SIMD kernel dispatch
+// ========================================
+/**
+ * @file dispatch.hpp
+ * @brief Binds the fastest SIMD kernel the running CPU supports, once, at startup.
+ *
+ * All kernels for the target architecture are compiled into the same binary
+ * (see `simd.hpp`). This header collects them into a table of `SimdBackend` entries,
+ * one per instruction set, and selects one:
+ *
+ * | Backend  | Lanes (f64) | Lanes (f32) | Availability check      |
+ * |----------|-------------|-------------|-------------------------|
+ * | `avx512` | 8           | 16          | CPUID AVX-512F          |
+ * | `avx2`   | 4           | 8           | CPUID AVX2              |
+ * | `neon`   | 2           | 4           | HWCAP ASIMD (AArch64)   |
+ * | `scalar` | 1           | 1           | always                  |
+ *
+ * ## Usage
+ * ```cpp
+ * selectSimdBackend("");        // auto: fastest supported
+ * selectSimdBackend("avx2");    // force a specific backend (CLI `--kernel avx2`)
+ * std::int64_t* hits = monteCarloPI_SIMD(1'000'000);   // calls through the bound table entry
+ * ```
+ *
+ * The sampling-strategy kernels (`sampling.hpp`) are bound the same way, one per backend.
+ *
+ * `SIMD` has one kernel per (unroll, buffer) configuration in `simdVariants`
+ * (`SimdMtKernels<Ops>::run<Unroll, Buffer>`), the untuned (1, lanes) first;
+ * `selectSimdVariant` rebinds `monteCarloPI_SIMD` to another one, e.g. from the autotune cache
+ * (`autotune.hpp`).
+ *
+ * After selection, the `monteCarloPI_SIMD*` entry points below are a single indirect
+ * call per invocation — the per-trial hot loops stay inside the ISA-specific kernels.
+ */
+
+#pragma once
+
+#include "montecarlo.hpp"
+#include "buffered.hpp"
+#include "sampling.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One compile-time configuration of the `SIMD` kernel.
+ */
+struct SimdVariant {
+    int unroll;                          ///< Independent counters per step
+    int buffer;                          ///< Darts staged per refill
+    std::int64_t* (*kernel)(std::int64_t);   ///< `SimdMtKernels<Ops>::run<unroll, buffer>`
+};
+
+/**
+ * @brief One SIMD instruction set and the kernels compiled for it.
+ */
+struct SimdBackend {
+    const char* name;               ///< CLI / log name (e.g. "avx2")
+    int lanes;                      ///< Doubles per vector register
+    int lanesF32;                   ///< Floats per vector register
+    bool (*supported)();            ///< Runtime CPU feature check
+    /// Kernel signature shared by every method: trials in, pool-allocated hit counter out.
+    using Kernel = std::int64_t* (*)(std::int64_t);
+
+    Kernel simdXoshiro;             ///< `monteCarloPI_SIMD_XOSHIRO` kernel
+    Kernel simdF32;                 ///< `monteCarloPI_SIMD_F32` kernel
+    Kernel simdF32Guarded;          ///< `monteCarloPI_SIMD_F32_GUARDED` kernel
+    Kernel simdBuffered;            ///< `monteCarloPI_SIMD_BUFFERED` kernel (see `buffered.hpp`)
+    Kernel stratified;              ///< `monteCarloPI_STRATIFIED` kernel (see `sampling.hpp`)
+    Kernel latinHypercube;          ///< `monteCarloPI_LATIN_HYPERCUBE` kernel
+    Kernel sobol;                   ///< `monteCarloPI_SOBOL` kernel
+    Kernel halton;                  ///< `monteCarloPI_HALTON` kernel
+    /// Every `monteCarloPI_SIMD` configuration of this ISA, default first (see `simdVariantsFor`).
+    const std::vector<SimdVariant>& (*simdVariants)();
+};
+
+/**
+ * @brief Always-available check used by the scalar backend.
+ * @return true
+ */
+inline bool cpuSupportsScalar() {
+    return true;
+}
+
+/**
+ * @brief The `SIMD` configurations compiled for one ISA, untuned default first.
+ *
+ * Unroll depths 1, 2, 4 and 8, each with the smallest buffer (one unrolled step) and a
+ * 256-dart buffer that amortizes the refill loop.
+ *
+ * @tparam Ops SIMD ops of the ISA
+ * @return Variant table
+ */
+template <typename Ops>
+inline const std::vector<SimdVariant>& simdVariantsFor() {
+    constexpr int lanes = Ops::lanes;
+    static const std::vector<SimdVariant> variants = {
+        {1, lanes, SimdMtKernels<Ops>::template run<1, lanes>},
+        {2, 2 * lanes, SimdMtKernels<Ops>::template run<2, 2 * lanes>},
+        {4, 4 * lanes, SimdMtKernels<Ops>::template run<4, 4 * lanes>},
+        {8, 8 * lanes, SimdMtKernels<Ops>::template run<8, 8 * lanes>},
+        {1, 256, SimdMtKernels<Ops>::template run<1, 256>},
+        {2, 256, SimdMtKernels<Ops>::template run<2, 256>},
+        {4, 256, SimdMtKernels<Ops>::template run<4, 256>},
+        {8, 256, SimdMtKernels<Ops>::template run<8, 256>},
+    };
+    return variants;
+}
+
+/**
+ * @brief All backends compiled into this binary, fastest first.
+ * @return Backend table
+ */
+inline const std::vector<SimdBackend>& simdBackends() {
+    static const std::vector<SimdBackend> backends = {
+#ifdef USE_AVX512
+        {"avx512", 8, 16, cpuSupportsAVX512, monteCarloPI_SIMD_XOSHIRO_AVX512,
+            monteCarloPI_SIMD_F32_AVX512<false>, monteCarloPI_SIMD_F32_AVX512<true>,
+            runBufferedStages<BufferedStagesAVX512>, runSampledStages<BufferedStagesAVX512, StratifiedSampler>,
+            runSampledStages<BufferedStagesAVX512, LatinHypercubeSampler>, runSampledStages<BufferedStagesAVX512, SobolSampler>,
+            runSampledStages<BufferedStagesAVX512, HaltonSampler>, simdVariantsFor<SimdOpsAVX512>},
+#endif
+#ifdef USE_AVX
+        {"avx2", 4, 8, cpuSupportsAVX2, monteCarloPI_SIMD_XOSHIRO_AVX2,
+            monteCarloPI_SIMD_F32_AVX2<false>, monteCarloPI_SIMD_F32_AVX2<true>,
+            runBufferedStages<BufferedStagesAVX2>, runSampledStages<BufferedStagesAVX2, StratifiedSampler>,
+            runSampledStages<BufferedStagesAVX2, LatinHypercubeSampler>, runSampledStages<BufferedStagesAVX2, SobolSampler>,
+            runSampledStages<BufferedStagesAVX2, HaltonSampler>, simdVariantsFor<SimdOpsAVX2>},
+#endif
+#ifdef USE_NEON
+        {"neon", 2, 4, cpuSupportsNEON, monteCarloPI_SIMD_XOSHIRO_NEON,
+            monteCarloPI_SIMD_F32_NEON<false>, monteCarloPI_SIMD_F32_NEON<true>,
+            runBufferedStages<BufferedStagesNEON>, runSampledStages<BufferedStagesNEON, StratifiedSampler>,
+            runSampledStages<BufferedStagesNEON, LatinHypercubeSampler>, runSampledStages<BufferedStagesNEON, SobolSampler>,
+            runSampledStages<BufferedStagesNEON, HaltonSampler>, simdVariantsFor<SimdOpsNEON>},
+#endif
+        {"scalar", 1, 1, cpuSupportsScalar, monteCarloPI_SIMD_XOSHIRO_SCALAR,
+            monteCarloPI_SIMD_F32_SCALAR<false>, monteCarloPI_SIMD_F32_SCALAR<true>,
+            runBufferedStages<BufferedStagesScalar>, runSampledStages<BufferedStagesScalar, StratifiedSampler>,
+            runSampledStages<BufferedStagesScalar, LatinHypercubeSampler>, runSampledStages<BufferedStagesScalar, SobolSampler>,
+            runSampledStages<BufferedStagesScalar, HaltonSampler>, simdVariantsFor<SimdOpsScalar>},
+    };
+    return backends;
+}
+
+/**
+ * @brief Storage for the currently bound backend (nullptr until selected).
+ * @return Reference to the active backend pointer
+ */
+inline const SimdBackend*& activeSimdBackendSlot() {
+    static const SimdBackend* active = nullptr;
+    return active;
+}
+
+/**
+ * @brief Storage for the `SIMD` configuration bound to the active backend (nullptr = `simd`).
+ * @return Reference to the active variant pointer
+ */
+inline const SimdVariant*& activeSimdVariantSlot() {
+    static const SimdVariant* active = nullptr;
+    return active;
+}
+
+/**
+ * @brief Selects and binds a SIMD backend.
+ *
+ * With an empty name, picks the first (fastest) backend whose CPU check passes.
+ * With a name, binds exactly that backend, failing if it is not compiled in or
+ * not supported by this CPU.
+ *
+ * @param name Backend name to force, or empty for auto-detection
+ * @return Selected backend, or nullptr if the requested one is unavailable
+ */
+inline const SimdBackend* selectSimdBackend(const std::string& name) {
+    for (const SimdBackend& backend : simdBackends()) {
+        if (!name.empty() && name != backend.name) continue;
+        if (!backend.supported()) {
+            if (name.empty()) continue;
+            return nullptr;
+        }
+
+        activeSimdBackendSlot() = &backend;
+        activeSimdVariantSlot() = nullptr;
+        return &backend;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Returns the bound backend, auto-selecting on first use.
+ * @return Active backend
+ */
+inline const SimdBackend& activeSimdBackend() {
+    if (!activeSimdBackendSlot()) selectSimdBackend("");
+    return *activeSimdBackendSlot();
+}
+
+/**
+ * @brief Binds one of the active backend's `SIMD` configurations. Call before starting any run.
+ * @param unroll Independent counters per step
+ * @param buffer Darts staged per refill
+ * @return Bound variant, or nullptr (binding unchanged) if the backend has no such configuration
+ */
+inline const SimdVariant* selectSimdVariant(int unroll, int buffer) {
+    for (const SimdVariant& variant : activeSimdBackend().simdVariants()) {
+        if (variant.unroll != unroll || variant.buffer != buffer) continue;
+        activeSimdVariantSlot() = &variant;
+        return &variant;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief The `SIMD` configuration `monteCarloPI_SIMD` calls.
+ * @return Tuned variant, or the backend's default (first) one
+ */
+inline const SimdVariant& activeSimdVariant() {
+    const SimdVariant* variant = activeSimdVariantSlot();
+    return variant ? *variant : activeSimdBackend().simdVariants().front();
+}
+
+/**
+ * @brief Bound backend and `SIMD` configuration, as logged in the `SIMD Kernel` column.
+ * @return e.g. `avx512 (unroll 4, buffer 256)`
+ */
+inline std::string activeSimdKernelName() {
+    const SimdVariant& variant = activeSimdVariant();
+    return std::string(activeSimdBackend().name) + " (unroll " + std::to_string(variant.unroll) + ", buffer " +
+           std::to_string(variant.buffer) + ")";
+}
+
+/**
+ * @brief Estimates π using the selected SIMD backend and pool-allocated result storage.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD(std::int64_t numberOfTrials) {
+    return activeSimdVariant().kernel(numberOfTrials);
+}
+
+/**
+ * @brief Estimates π using the selected SIMD backend fed by its in-register xoshiro256+ PRNG.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD_XOSHIRO(std::int64_t numberOfTrials) {
+    return activeSimdBackend().simdXoshiro(numberOfTrials);
+}
+
+/**
+ * @brief Estimates π using the selected backend's float32 kernel (twice the f64 lane count).
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD_F32(std::int64_t numberOfTrials) {
+    return activeSimdBackend().simdF32(numberOfTrials);
+}
+
+/**
+ * @brief Float32 kernel that re-checks samples near the circle boundary in double precision.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD_F32_GUARDED(std::int64_t numberOfTrials) {
+    return activeSimdBackend().simdF32Guarded(numberOfTrials);
+}
+
+/**
+ * @brief Two-stage kernel: fill SoA buffers with the selected backend's PRNG, then count them.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD_BUFFERED(std::int64_t numberOfTrials) {
+    return activeSimdBackend().simdBuffered(numberOfTrials);
+}
+
+/**
+ * @brief Jittered-grid darts (one per cell), counted by the selected backend.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_STRATIFIED(std::int64_t numberOfTrials) {
+    return activeSimdBackend().stratified(numberOfTrials);
+}
+
+/**
+ * @brief Latin-hypercube darts (one per row and column band of each buffer), counted by the selected backend.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_LATIN_HYPERCUBE(std::int64_t numberOfTrials) {
+    return activeSimdBackend().latinHypercube(numberOfTrials);
+}
+
+/**
+ * @brief Digitally shifted Sobol points, counted by the selected backend.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SOBOL(std::int64_t numberOfTrials) {
+    return activeSimdBackend().sobol(numberOfTrials);
+}
+
+/**
+ * @brief Rotated Halton points (bases 2 and 3), counted by the selected backend.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_HALTON(std::int64_t numberOfTrials) {
+    return activeSimdBackend().halton(numberOfTrials);
+}
@@ -0,0 +1,602 @@
+// ========================================
+// distributed.hpp - Multi-node coordinator / worker mode
+// ========================================
+/**
+ * @file distributed.hpp
+ * @brief Lightweight TCP protocol that splits one run's chunks over several nodes and reduces their hits.
+ *
+ * One box caps trials per second at its core count. In distributed mode the same binary runs as
+ * one coordinator (`--coordinator PORT --nodes N`) and N workers (`--worker HOST:PORT`). Each
+ * worker runs its own `ThreadPool` over a disjoint, contiguous range of the run's chunk indices;
+ * the coordinator sends out the ranges, sums the 64-bit hit counts and measures what the
+ * reduction costs on top of the slowest node.
+ *
+ * ---
+ *
+ * ## Disjoint Streams
+ * Every chunk's generators are keyed by its *global* index through Philox (`philox.hpp`). The
+ * coordinator cuts `ceil(trials / kDefaultChunkTrials)` chunks into one contiguous range per
+ * node, weighted by the node's thread count, and the worker offsets its pool's chunk indices with
+ * `ThreadPool::setChunkBase()`. Ranges never overlap, so no two nodes share a stream. The
+ * coordinator always sends a run seed (`--seed`, or a random one), which makes a cluster run
+ * reproducible: under `--seed` its hit count equals a single-node run of the same trials, for
+ * any number of nodes and threads.
+ *
+ * ## Protocol
+ * Newline-terminated ASCII over one TCP connection per worker (`TCP_NODELAY`):
+ * | Direction          | Message                               | Meaning                                   |
+ * |--------------------|---------------------------------------|-------------------------------------------|
+ * | worker → coord.    | `HELLO 2 <threads> <kernel> <host>` + tab + `RunInfo` | Protocol version and node description |
+ * | coord. → worker    | `SEED <seed>`                         | Run seed for every following `RUN`        |
+ * | coord. → worker    | `RUN <method> <firstChunk> <trials>`  | Run `trials` from global chunk `firstChunk` |
+ * | worker → coord.    | `DONE <hits> <elapsedNs>`             | Hits and pool wall time of that range     |
+ * | worker → coord.    | `ERROR <message>`                     | The `RUN` could not be executed           |
+ * | coord. → worker    | `QUIT`                                | Exit                                      |
+ *
+ * The `HELLO` tail is the worker's `encodeRunInfo()` (CPU, clock policy, bound kernel, `--pin`,
+ * build), so its result rows describe the machine that produced them.
+ *
+ * `RUN` goes to every node before any reply is read, so nodes run concurrently; the reduction is
+ * the coordinator summing the replies as they arrive.
+ *
+ * ## Timing
+ * A cluster repetition is timed on the coordinator from the first `RUN` sent to the last `DONE`
+ * received. *Reduction overhead* is that wall time minus the slowest node's own pool time: the
+ * network round trip, message handling and the sum. Node throughput is the node's trials over its
+ * pool time.
+ *
+ * ## Example
+ * ```bash
+ * ./montecarlo 1e11 SIMDXoshiro --coordinator 7070 --nodes 2 --arrow-out cluster.arrows   # host a
+ * ./montecarlo --worker a:7070 --threads 64 --pin compact                                # hosts b, c
+ * ```
+ */
+
+#pragma once
+
+#include "methods.hpp"
+#include "runinfo.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #define MC_HAVE_SOCKETS 1
+#endif
+
+/// Version sent in `HELLO`; a coordinator rejects workers speaking another one.
+constexpr int kClusterProtocolVersion = 2;
+
+/// Connection attempts a worker makes (every `kClusterRetryMs`) before giving up on the coordinator.
+constexpr int kClusterConnectAttempts = 150;
+
+/// Delay between connection attempts, so workers may start before their coordinator.
+constexpr int kClusterRetryMs = 200;
+
+/**
+ * @brief One TCP connection exchanging newline-terminated messages; closes on destruction.
+ */
+class LineSocket {
+public:
+    LineSocket() = default;
+
+    /**
+     * @brief Take ownership of a connected socket.
+     * @param descriptor Socket file descriptor
+     */
+    explicit LineSocket(int descriptor) : fd(descriptor) {}
+
+    LineSocket(const LineSocket&) = delete;
+    LineSocket& operator=(const LineSocket&) = delete;
+
+    LineSocket(LineSocket&& other) noexcept : fd(other.fd), pending(std::move(other.pending)) {
+        other.fd = -1;
+    }
+
+    LineSocket& operator=(LineSocket&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd = other.fd;
+            pending = std::move(other.pending);
+            other.fd = -1;
+        }
+        return *this;
+    }
+
+    ~LineSocket() {
+        close();
+    }
+
+    /**
+     * @brief Whether the socket holds a connection.
+     * @return true if open
+     */
+    bool open() const {
+        return fd >= 0;
+    }
+
+    /**
+     * @brief Send one message; the newline is appended.
+     * @param line Message without terminator
+     * @return false if the peer is gone
+     */
+    bool send(const std::string& line) {
+#ifdef MC_HAVE_SOCKETS
+        std::string framed = line + "\n";
+        std::size_t sent = 0;
+        while (sent < framed.size()) {
+    #ifdef MSG_NOSIGNAL
+            ssize_t n = ::send(fd, framed.data() + sent, framed.size() - sent, MSG_NOSIGNAL);
+    #else
+            ssize_t n = ::send(fd, framed.data() + sent, framed.size() - sent, 0);
+    #endif
+            if (n <= 0) return false;
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+#else
+        (void)line;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Block until one whole message arrives.
+     * @param line Message without terminator
+     * @return false on disconnect
+     */
+    bool receive(std::string& line) {
+#ifdef MC_HAVE_SOCKETS
+        for (;;) {
+            std::size_t end = pending.find('\n');
+            if (end != std::string::npos) {
+                line = pending.substr(0, end);
+                pending.erase(0, end + 1);
+                return true;
+            }
+            char buffer[4096];
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) return false;
+            pending.append(buffer, static_cast<std::size_t>(n));
+        }
+#else
+        (void)line;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Close the connection (idempotent).
+     */
+    void close() {
+#ifdef MC_HAVE_SOCKETS
+        if (fd >= 0) ::close(fd);
+#endif
+        fd = -1;
+    }
+
+private:
+    int fd = -1;            ///< Socket descriptor (-1 = closed)
+    std::string pending;    ///< Bytes received past the last complete message
+};
+
+/**
+ * @brief Disable Nagle's algorithm so small control messages leave immediately.
+ * @param fd Connected TCP socket
+ */
+inline void setNoDelay(int fd) {
+#ifdef MC_HAVE_SOCKETS
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    #ifdef SO_NOSIGPIPE
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    #endif
+#else
+    (void)fd;
+#endif
+}
+
+/**
+ * @brief Name of this machine for `HELLO` and the `Node` column.
+ * @return Host name, or "unknown"
+ */
+inline std::string clusterHostName() {
+#ifdef MC_HAVE_SOCKETS
+    char name[256] = {};
+    if (::gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0') return name;
+#endif
+    return "unknown";
+}
+
+/**
+ * @brief Cut `chunkCount` chunks into one contiguous range per node, proportional to `weights`.
+ * @param chunkCount Chunks in the whole run
+ * @param weights    Relative share per node (thread counts)
+ * @return `weights.size() + 1` boundaries; node i owns chunks [b[i], b[i + 1])
+ */
+inline std::vector<std::int64_t> partitionChunks(std::int64_t chunkCount, const std::vector<unsigned>& weights) {
+    std::int64_t total = 0;
+    for (unsigned weight : weights) total += weight;
+    total = std::max<std::int64_t>(1, total);
+
+    // chunkCount · prefix / total without the 64-bit product overflowing on huge runs
+    const std::int64_t quotient = chunkCount / total, remainder = chunkCount % total;
+    std::vector<std::int64_t> bounds(weights.size() + 1, 0);
+    std::int64_t prefix = 0;
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        prefix += weights[i];
+        bounds[i + 1] = quotient * prefix + remainder * prefix / total;
+    }
+    return bounds;
+}
+
+/**
+ * @brief A worker as seen by the coordinator.
+ */
+struct ClusterNode {
+    LineSocket socket;      ///< Control connection
+    std::string name;       ///< `host#index`, the `Node` column value
+    unsigned threads = 1;   ///< Worker pool size
+    std::string kernel;     ///< SIMD backend bound on the worker
+    RunInfo info;           ///< Worker metadata for its result rows
+};
+
+/**
+ * @brief One node's share of a cluster repetition.
+ */
+struct NodeRun {
+    std::int64_t trials = 0;    ///< Trials in the node's chunk range
+    std::int64_t hits = 0;      ///< Hits reported by the node
+    long long elapsedNs = 0;    ///< Node pool wall time
+};
+
+/**
+ * @brief One reduced cluster repetition.
+ */
+struct ClusterRun {
+    std::vector<NodeRun> nodes;     ///< Per node, in connection order
+    std::int64_t hits = 0;          ///< Sum of node hits
+    long long elapsedNs = 0;        ///< Coordinator wall time (first RUN → last DONE)
+    long long reductionNs = 0;      ///< `elapsedNs` minus the slowest node's time
+};
+
+/**
+ * @brief Accepts workers, hands out chunk ranges and reduces their results.
+ */
+class ClusterCoordinator {
+public:
+    /**
+     * @brief Listen on `port` and block until `count` workers have said `HELLO`.
+     * @param port  TCP port (all interfaces)
+     * @param count Workers to wait for
+     * @return false (after an `[ERROR]`) if the port can't be bound or a worker is invalid
+     */
+    bool accept(std::uint16_t port, int count) {
+#ifdef MC_HAVE_SOCKETS
+        int listener = ::socket(AF_INET6, SOCK_STREAM, 0);
+        bool dualStack = listener >= 0;
+        if (!dualStack) listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) {
+            std::cerr << "[ERROR] Cannot create coordinator socket\n";
+            return false;
+        }
+        LineSocket guard(listener);
+        int on = 1, off = 0;
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        int bound = -1;
+        if (dualStack) {
+            ::setsockopt(listener, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+            sockaddr_in6 address{};
+            address.sin6_family = AF_INET6;
+            address.sin6_addr = in6addr_any;
+            address.sin6_port = htons(port);
+            bound = ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        } else {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+            address.sin_port = htons(port);
+            bound = ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        }
+        if (bound != 0 || ::listen(listener, count) != 0) {
+            std::cerr << "[ERROR] Cannot listen on port " << port << "\n";
+            return false;
+        }
+
+        std::cout << "[INFO] Coordinator: waiting for " << count << " worker(s) on port " << port << "\n";
+        while (static_cast<int>(nodes.size()) < count) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                std::cerr << "[ERROR] Cannot accept worker: " << std::strerror(errno) << "\n";
+                return false;
+            }
+            setNoDelay(fd);
+
+            ClusterNode node;
+            node.socket = LineSocket(fd);
+            std::string hello;
+            if (!node.socket.receive(hello) || !parseHello(hello, node)) {
+                std::cerr << "[ERROR] Worker handshake failed: " << hello << "\n";
+                return false;
+            }
+            node.name += "#" + std::to_string(nodes.size());
+            std::cout << "[INFO] Node " << node.name << ": " << node.threads << " threads, " << node.kernel << "\n";
+            nodes.push_back(std::move(node));
+        }
+        return true;
+#else
+        (void)port;
+        (void)count;
+        std::cerr << "[ERROR] Distributed mode needs POSIX sockets\n";
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Send the run seed that keys every node's chunk streams.
+     * @param seed Run seed
+     * @return false if a worker is gone
+     */
+    bool broadcastSeed(std::uint64_t seed) {
+        for (ClusterNode& node : nodes) {
+            if (!node.socket.send("SEED " + std::to_string(seed))) return disconnected(node);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run `totalTrials` of `method` across all nodes and reduce the hits.
+     * @param method      Registered pool method
+     * @param totalTrials Trials in the whole run
+     * @param run         Per-node and reduced results
+     * @return false (after an `[ERROR]`) if a worker failed or disconnected
+     */
+    bool run(const std::string& method, std::int64_t totalTrials, ClusterRun& run) {
+        const std::int64_t chunkCount = (totalTrials + kDefaultChunkTrials - 1) / kDefaultChunkTrials;
+        std::vector<unsigned> weights;
+        for (const ClusterNode& node : nodes) weights.push_back(node.threads);
+        std::vector<std::int64_t> bounds = partitionChunks(chunkCount, weights);
+
+        run = ClusterRun{};
+        run.nodes.resize(nodes.size());
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            std::int64_t begin = bounds[i] * kDefaultChunkTrials;
+            std::int64_t end = std::min(totalTrials, bounds[i + 1] * kDefaultChunkTrials);
+            run.nodes[i].trials = std::max<std::int64_t>(0, end - begin);
+            std::string message = "RUN " + method + " " + std::to_string(bounds[i]) + " " + std::to_string(run.nodes[i].trials);
+            if (!nodes[i].socket.send(message)) return disconnected(nodes[i]);
+        }
+
+        long long slowestNs = 0;
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            std::string reply;
+            if (!nodes[i].socket.receive(reply)) return disconnected(nodes[i]);
+
+            std::istringstream fields(reply);
+            std::string verb;
+            fields >> verb >> run.nodes[i].hits >> run.nodes[i].elapsedNs;
+            if (verb != "DONE" || fields.fail()) {
+                std::cerr << "[ERROR] Node " << nodes[i].name << ": " << reply << "\n";
+                return false;
+            }
+            run.hits += run.nodes[i].hits;
+            slowestNs = std::max(slowestNs, run.nodes[i].elapsedNs);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        run.elapsedNs = static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        run.reductionNs = std::max(0LL, run.elapsedNs - slowestNs);
+        return true;
+    }
+
+    /**
+     * @brief Tell every worker to exit.
+     */
+    void shutdown() {
+        for (ClusterNode& node : nodes) {
+            node.socket.send("QUIT");
+            node.socket.close();
+        }
+    }
+
+    /**
+     * @brief Connected workers, in connection order.
+     * @return Node list
+     */
+    const std::vector<ClusterNode>& workers() const {
+        return nodes;
+    }
+
+    /**
+     * @brief Sum of the workers' thread counts.
+     * @return Cluster-wide threads
+     */
+    unsigned totalThreads() const {
+        unsigned threads = 0;
+        for (const ClusterNode& node : nodes) threads += node.threads;
+        return threads;
+    }
+
+private:
+    /**
+     * @brief Parse `HELLO <version> <threads> <kernel> <host>` and its tab-separated `RunInfo` tail.
+     * @param line Received message
+     * @param node Filled with threads, kernel, host and metadata on success
+     * @return false on a malformed message or a protocol mismatch
+     */
+    static bool parseHello(const std::string& line, ClusterNode& node) {
+        std::size_t tab = line.find('\t');
+        if (tab == std::string::npos || !decodeRunInfo(line.substr(tab + 1), node.info)) return false;
+        std::istringstream fields(line.substr(0, tab));
+        std::string verb;
+        int version = 0;
+        fields >> verb >> version >> node.threads >> node.kernel >> node.name;
+        return verb == "HELLO" && version == kClusterProtocolVersion && !fields.fail() && node.threads > 0;
+    }
+
+    /**
+     * @brief Report a lost worker.
+     * @param node Worker that stopped responding
+     * @return false
+     */
+    static bool disconnected(const ClusterNode& node) {
+        std::cerr << "[ERROR] Node " << node.name << " disconnected\n";
+        return false;
+    }
+
+    std::vector<ClusterNode> nodes;   ///< Connected workers
+};
+
+/**
+ * @brief Connect to a coordinator, retrying while it starts up.
+ * @param address `HOST:PORT` (IPv6 literals as `[::1]:PORT`)
+ * @param socket  Connected socket on success
+ * @return false (after an `[ERROR]`) on a bad address or when every attempt failed
+ */
+inline bool connectToCoordinator(const std::string& address, LineSocket& socket) {
+#ifdef MC_HAVE_SOCKETS
+    std::size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+        std::cerr << "[ERROR] Invalid coordinator address: " << address << " (expected HOST:PORT)\n";
+        return false;
+    }
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+
+    for (int attempt = 0; attempt < kClusterConnectAttempts; ++attempt) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0) {
+            std::cerr << "[ERROR] Cannot resolve coordinator: " << address << "\n";
+            return false;
+        }
+        for (addrinfo* entry = results; entry; entry = entry->ai_next) {
+            int fd = ::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+            if (fd < 0) continue;
+            if (::connect(fd, entry->ai_addr, entry->ai_addrlen) == 0) {
+                ::freeaddrinfo(results);
+                setNoDelay(fd);
+                socket = LineSocket(fd);
+                return true;
+            }
+            ::close(fd);
+        }
+        ::freeaddrinfo(results);
+        std::this_thread::sleep_for(std::chrono::milliseconds(kClusterRetryMs));
+    }
+    std::cerr << "[ERROR] Cannot reach coordinator: " << address << "\n";
+    return false;
+#else
+    (void)address;
+    (void)socket;
+    std::cerr << "[ERROR] Distributed mode needs POSIX sockets\n";
+    return false;
+#endif
+}
+
+/**
+ * @brief Worker main loop: say `HELLO`, then serve `SEED` / `RUN` until `QUIT`.
+ *
+ * Chunk kernels are built once per method for this pool; `prepare` runs whenever the method
+ * changes. Only pool methods can be distributed.
+ *
+ * @param address Coordinator `HOST:PORT`
+ * @param pool    Local worker pool
+ * @param info    This worker's metadata (bound kernel and `--pin` filled in)
+ * @return 0 after `QUIT`, EXIT_FAILURE if the connection failed or was lost
+ */
+inline int serveClusterWorker(const std::string& address, ThreadPool& pool, const RunInfo& info) {
+    LineSocket socket;
+    if (!connectToCoordinator(address, socket)) return EXIT_FAILURE;
+
+    std::string hello = "HELLO " + std::to_string(kClusterProtocolVersion) + " " + std::to_string(pool.size()) + " " +
+                        activeSimdBackend().name + " " + clusterHostName() + "\t" + encodeRunInfo(info);
+    if (!socket.send(hello)) return EXIT_FAILURE;
+    std::cout << "[INFO] Worker: connected to " << address << "\n";
+
+    std::unordered_map<std::string, ThreadPool::ChunkKernel> kernels;
+    std::string lastMethod;
+    std::string line;
+    while (socket.receive(line)) {
+        std::istringstream fields(line);
+        std::string verb;
+        fields >> verb;
+
+        if (verb == "QUIT") {
+            std::cout << "[INFO] Worker: coordinator finished\n";
+            return 0;
+        }
+        if (verb == "SEED") {
+            std::uint64_t seed = 0;
+            fields >> seed;
+            setRunSeed(seed);
+            continue;
+        }
+        if (verb != "RUN") {
+            socket.send("ERROR unknown message " + verb);
+            continue;
+        }
+
+        std::string name;
+        std::uint64_t firstChunk = 0;
+        std::int64_t trials = 0;
+        fields >> name >> firstChunk >> trials;
+        const MethodInfo* method = findMethod(name);
+        if (fields.fail() || !method || method->threading != MethodThreading::Pool) {
+            socket.send("ERROR cannot run " + name);
+            continue;
+        }
+
+        std::int64_t hits = 0;
+        std::chrono::steady_clock::time_point start, end;
+        try {
+            if (name != lastMethod && method->prepare) method->prepare();
+            lastMethod = name;
+            auto kernel = kernels.find(name);
+            if (kernel == kernels.end()) kernel = kernels.emplace(name, method->makeKernel(pool.size())).first;
+
+            pool.setChunkBase(firstChunk);
+            start = std::chrono::steady_clock::now();
+            hits = pool.run(trials, kDefaultChunkTrials, kernel->second);
+            end = std::chrono::steady_clock::now();
+            pool.setChunkBase(0);
+        } catch (const std::exception& e) {
+            // Report the kernel's failure to the coordinator and rebuild its state on the next RUN
+            pool.setChunkBase(0);
+            kernels.erase(name);
+            lastMethod.clear();
+            std::string message = e.what();
+            std::replace(message.begin(), message.end(), '\n', ' ');
+            if (!socket.send("ERROR " + message)) break;
+            continue;
+        }
+
+        long long elapsed = static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        if (!socket.send("DONE " + std::to_string(hits) + " " + std::to_string(elapsed))) break;
+    }
+
+    std::cerr << "[ERROR] Worker: lost connection to " << address << "\n";
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,246 @@
+// ========================================
+// estimator.hpp - Streaming π estimator
+// ========================================
+/**
+ * @file estimator.hpp
+ * @brief Incremental, lock-free π estimator with running standard error and early stopping.
+ *
+ * The `monteCarloPI_*` entry points run a fixed trial budget. `StreamingEstimator` instead
+ * accumulates chunk results as workers produce them, so a run can stop as soon as the estimate
+ * is precise enough — or when a wall-clock deadline passes — instead of always paying for the
+ * worst-case trial count.
+ *
+ * ---
+ *
+ * ## Statistics
+ * Each trial is a Bernoulli sample with p = π/4, so for n trials and h hits:
+ * | Quantity          | Formula                          |
+ * |-------------------|----------------------------------|
+ * | Estimate          | π̂ = 4 · h / n                    |
+ * | Variance (π̂)      | 16 · p̂ (1 − p̂) / n               |
+ * | Standard error    | √variance                        |
+ * | CI half-width     | z · standard error (z = 1.96 ≈ 95%) |
+ *
+ * No per-sample state is kept, so memory is constant regardless of trial count.
+ *
+ * ## Lock-Free Feeding
+ * One `alignas(64)` slot per worker holds that worker's running trial and hit totals. Only the
+ * owner writes a slot (relaxed stores, no RMW), so feeding never contends; readers sum the slots.
+ * A snapshot taken while workers are mid-update may pair one worker's totals from adjacent
+ * chunks, which skews the estimate by at most one chunk of that worker — negligible next to the
+ * standard error it is compared against.
+ *
+ * ## Stopping
+ * `StopCriteria` combines a target CI half-width (`epsilon`) and a deadline; either triggers a
+ * stop. `runStreaming()` polls them between chunks through `ThreadPool::runUntil()`, so a run
+ * overshoots by at most one chunk per worker. `minTrials` keeps the variance estimate from
+ * tripping `epsilon` on a tiny early sample.
+ *
+ * ## Example
+ * ```cpp
+ * StopCriteria criteria;
+ * criteria.epsilon = 1e-4;
+ * criteria.deadline = std::chrono::milliseconds(500);
+ * StreamingResult result = runStreaming(pool, kernel, 10'000'000'000, kDefaultChunkTrials, criteria);
+ * ```
+ */
+
+#pragma once
+
+#include "threadpool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief When a streaming run should stop before exhausting its trial budget.
+ */
+struct StopCriteria {
+    double epsilon = 0.0;                          ///< Target CI half-width (0 = no precision target)
+    std::chrono::nanoseconds deadline{0};          ///< Wall-clock limit from start (0 = none)
+    double z = 1.96;                               ///< Normal quantile of the CI (1.96 ≈ 95%)
+    std::int64_t minTrials = 1 << 20;              ///< Trials required before `epsilon` is checked
+
+    /**
+     * @brief Whether any early-stop condition is set.
+     * @return true if `epsilon` or `deadline` is set
+     */
+    bool active() const {
+        return epsilon > 0.0 || deadline.count() > 0;
+    }
+};
+
+/// Why a streaming run ended.
+enum class StopReason {
+    Budget,      ///< Ran the full trial budget
+    Precision,   ///< CI half-width reached `epsilon`
+    Deadline,    ///< Wall-clock deadline passed
+};
+
+/**
+ * @brief Point-in-time view of a `StreamingEstimator`.
+ */
+struct EstimatorSnapshot {
+    std::int64_t trials = 0;   ///< Trials accumulated
+    std::int64_t hits = 0;     ///< Hits accumulated
+    double estimate = 0.0;     ///< π̂ = 4 · hits / trials
+    double variance = 0.0;     ///< Variance of π̂
+    double stdError = 0.0;     ///< Standard error of π̂
+
+    /**
+     * @brief Confidence-interval half-width.
+     * @param z Normal quantile (1.96 ≈ 95%)
+     * @return z · standard error
+     */
+    double halfWidth(double z) const {
+        return z * stdError;
+    }
+};
+
+/**
+ * @brief Lock-free running π estimate fed with chunk results by pool workers.
+ */
+class StreamingEstimator {
+public:
+    /**
+     * @brief Allocate one slot per worker; feeding never allocates.
+     * @param workers Number of feeding workers
+     */
+    explicit StreamingEstimator(unsigned workers) : slots(workers > 0 ? workers : 1) {}
+
+    /**
+     * @brief Add one chunk's results to `worker`'s slot.
+     *
+     * Each slot must be fed by a single thread at a time.
+     *
+     * @param worker Feeding worker's index (see `ThreadPool::currentWorker()`)
+     * @param trials Trials in the chunk
+     * @param hits   Hits in the chunk
+     */
+    void add(unsigned worker, std::int64_t trials, std::int64_t hits) {
+        Slot& slot = slots[worker % slots.size()];
+        slot.hits.store(slot.hits.load(std::memory_order_relaxed) + hits, std::memory_order_relaxed);
+        slot.trials.store(slot.trials.load(std::memory_order_relaxed) + trials, std::memory_order_release);
+    }
+
+    /**
+     * @brief Sum of all slots with the derived statistics.
+     * @return Current snapshot (all zero before the first chunk)
+     */
+    EstimatorSnapshot snapshot() const {
+        EstimatorSnapshot view;
+        for (const Slot& slot : slots) {
+            view.trials += slot.trials.load(std::memory_order_acquire);
+            view.hits += slot.hits.load(std::memory_order_relaxed);
+        }
+        if (view.trials <= 0) return view;
+
+        double n = static_cast<double>(view.trials);
+        double p = static_cast<double>(view.hits) / n;
+        view.estimate = 4.0 * p;
+        view.variance = 16.0 * p * (1.0 - p) / n;
+        view.stdError = std::sqrt(view.variance);
+        return view;
+    }
+
+    /**
+     * @brief Whether the precision target of `criteria` has been reached.
+     * @param criteria Stop criteria (only `epsilon`, `z` and `minTrials` are used)
+     * @return true once at least `minTrials` trials give a CI half-width ≤ `epsilon`
+     */
+    bool precise(const StopCriteria& criteria) const {
+        if (criteria.epsilon <= 0.0) return false;
+        EstimatorSnapshot view = snapshot();
+        return view.trials >= criteria.minTrials && view.halfWidth(criteria.z) <= criteria.epsilon;
+    }
+
+    /**
+     * @brief Clear all slots for a new run.
+     */
+    void reset() {
+        for (Slot& slot : slots) {
+            slot.trials.store(0, std::memory_order_relaxed);
+            slot.hits.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    /// Running totals of one worker; padded so workers never share a line.
+    struct alignas(64) Slot {
+        std::atomic<std::int64_t> trials{0};   ///< Trials fed by this worker
+        std::atomic<std::int64_t> hits{0};     ///< Hits fed by this worker
+    };
+
+    std::vector<Slot> slots;                   ///< One slot per worker
+};
+
+/**
+ * @brief Outcome of `runStreaming()`.
+ */
+struct StreamingResult {
+    EstimatorSnapshot estimate;                ///< Final statistics over executed trials
+    StopReason reason = StopReason::Budget;    ///< Why the run ended
+    long long elapsedNs = 0;                   ///< Wall time in nanoseconds
+};
+
+/**
+ * @brief Run a chunk kernel on `pool` until `criteria` is met or `maxTrials` is exhausted.
+ *
+ * @param pool        Worker pool
+ * @param kernel      Chunk kernel returning hits for its trials
+ * @param maxTrials   Trial budget (upper bound)
+ * @param chunkTrials Trials per chunk, and so the granularity of stop checks
+ * @param criteria    Precision target and/or deadline
+ * @return Final estimate, stop reason and wall time
+ */
+inline StreamingResult runStreaming(ThreadPool& pool, const ThreadPool::ChunkKernel& kernel, std::int64_t maxTrials,
+                                    std::int64_t chunkTrials, const StopCriteria& criteria) {
+    StreamingEstimator estimator(pool.size());
+    const auto start = std::chrono::steady_clock::now();
+    const bool hasDeadline = criteria.deadline.count() > 0;
+
+    // Written by whichever worker sees a condition first; Budget if none ever fires
+    std::atomic<int> reason{static_cast<int>(StopReason::Budget)};
+
+    ThreadPool::ChunkKernel feed = [&](std::int64_t trials) {
+        std::int64_t hits = kernel(trials);
+        estimator.add(ThreadPool::currentWorker(), trials, hits);
+        return hits;
+    };
+    ThreadPool::StopCondition stop = [&]() {
+        if (reason.load(std::memory_order_relaxed) != static_cast<int>(StopReason::Budget)) return true;
+        if (hasDeadline && std::chrono::steady_clock::now() - start >= criteria.deadline) {
+            reason.store(static_cast<int>(StopReason::Deadline), std::memory_order_relaxed);
+            return true;
+        }
+        if (estimator.precise(criteria)) {
+            reason.store(static_cast<int>(StopReason::Precision), std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    };
+
+    pool.runUntil(maxTrials, chunkTrials, feed, stop);
+
+    StreamingResult result;
+    result.elapsedNs = static_cast<long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    result.estimate = estimator.snapshot();
+    result.reason = static_cast<StopReason>(reason.load(std::memory_order_relaxed));
+    return result;
+}
+
+/**
+ * @brief Printable name of a stop reason.
+ * @param reason Stop reason
+ * @return "budget", "precision" or "deadline"
+ */
+inline const char* stopReasonName(StopReason reason) {
+    switch (reason) {
+        case StopReason::Precision: return "precision";
+        case StopReason::Deadline:  return "deadline";
+        default:                    return "budget";
+    }
+}
@@ -0,0 +1,77 @@
+// ========================================
+// falsesharing.hpp - False-sharing penalty benchmark
+// ========================================
+/**
+ * @file falsesharing.hpp
+ * @brief Deliberately packed vs. cache-line-padded per-worker counters, to measure false sharing.
+ *
+ * The production kernels keep hit counts in registers and publish once per run into padded
+ * slots, so they never share a cache line. These two methods undo that on purpose: every trial
+ * writes a per-worker counter in memory, and the only difference between them is layout.
+ *
+ * | Method        | Slot type       | Slot size | Workers per 64 B line |
+ * |---------------|-----------------|-----------|-----------------------|
+ * | `PackedSlots` | `PackedCounter` | 8 B       | 8 (false sharing)     |
+ * | `PaddedSlots` | `PaddedCounter` | 64 B      | 1                     |
+ *
+ * Each worker writes only its own slot, so the extra time of `PackedSlots` over `PaddedSlots`
+ * is purely the coherence traffic of neighbours invalidating each other's line.
+ *
+ * ## Why Atomics?
+ * Counters are `std::atomic<int64_t>` updated with relaxed load + store (not an RMW).
+ * That compiles to a plain load/store, but the compiler may not keep the value in a register
+ * across iterations — which is exactly the write-per-hit pattern being measured.
+ *
+ * ## Example
+ * ```cpp
+ * auto slots = std::make_shared<std::vector<PackedCounter>>(pool.size());
+ * pool.run(trials, kDefaultChunkTrials, [slots](std::int64_t n) {
+ *     return monteCarloPI_SLOTS(*slots, ThreadPool::currentWorker(), n);
+ * });
+ * ```
+ */
+
+#pragma once
+
+#include "montecarlo.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/// Counter without padding: eight of them share one cache line.
+struct PackedCounter {
+    std::atomic<std::int64_t> value{0};   ///< Hits written by one worker
+};
+
+/// Counter padded to a full cache line.
+struct alignas(64) PaddedCounter {
+    std::atomic<std::int64_t> value{0};   ///< Hits written by one worker
+};
+
+static_assert(sizeof(PackedCounter) == 8, "PackedCounter must stay unpadded");
+static_assert(sizeof(PaddedCounter) == 64, "PaddedCounter must fill one cache line");
+
+/**
+ * @brief Estimates π while writing every hit to this worker's counter in `slots`.
+ *
+ * @tparam Slot `PackedCounter` or `PaddedCounter`
+ * @param slots  One counter per worker
+ * @param worker Calling worker's index
+ * @param numberOfTrials Total number of darts to throw
+ * @return Hits inside the circle for this call
+ */
+template <typename Slot>
+inline std::int64_t monteCarloPI_SLOTS(std::vector<Slot>& slots, unsigned worker, std::int64_t numberOfTrials) {
+    std::atomic<std::int64_t>& counter = slots[worker % slots.size()].value;
+    const std::int64_t before = counter.load(std::memory_order_relaxed);
+
+    SplitMix64 seeder{chunkSeed()};
+    Xoshiro256Plus genX(seeder), genY(seeder);
+
+    // One store per trial (branchless), so every iteration touches the slot's cache line
+    for (std::int64_t i = 0; i < numberOfTrials; ++i) {
+        bool inside = isInsideCircle(genX.nextDouble(), genY.nextDouble());
+        counter.store(counter.load(std::memory_order_relaxed) + inside, std::memory_order_relaxed);
+    }
+    return counter.load(std::memory_order_relaxed) - before;
+}
@@ -0,0 +1,187 @@
+// ========================================
+// gpu.cu - CUDA π kernel with on-device Philox darts
+// ========================================
+/**
+ * @file gpu.cu
+ * @brief Device side of `gpu.hpp`: Philox darts, warp-shuffle / shared-memory reduction.
+ *
+ * Compiled only with `-DMC_ENABLE_CUDA=ON`. One persistent stream, a device counter and a pinned
+ * host word are created on first use; every run is memset → kernel → 8-byte copy on that stream,
+ * bracketed by CUDA events so callers get the device time without a host-side sync in between.
+ *
+ * The grid is `kGpuBlocksPerSm` blocks of `kGpuBlockThreads` threads per multiprocessor (capped by
+ * the trial count) and walks the darts with a grid-stride loop, so the dart → (x, y) mapping does
+ * not depend on the grid shape.
+ */
+
+#include "gpu.hpp"
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int kGpuBlockThreads = 256;   ///< Threads per block (8 warps)
+constexpr int kGpuBlocksPerSm = 8;      ///< Resident blocks per multiprocessor to hide latency
+constexpr int kWarpSize = 32;
+
+/**
+ * @brief Philox4x32-10 block function, same rounds and constants as `philox4x32` in `philox.hpp`.
+ * @param counter 128-bit counter
+ * @param key     64-bit key
+ * @return Four pseudo-random 32-bit words
+ */
+__device__ __forceinline__ uint4 philox4x32Device(uint4 counter, uint2 key) {
+#pragma unroll
+    for (int round = 0; round < 10; ++round) {
+        unsigned int hi0 = __umulhi(0xD2511F53u, counter.x);
+        unsigned int lo0 = 0xD2511F53u * counter.x;
+        unsigned int hi1 = __umulhi(0xCD9E8D57u, counter.z);
+        unsigned int lo1 = 0xCD9E8D57u * counter.z;
+        counter = make_uint4(hi1 ^ counter.y ^ key.x, lo1, hi0 ^ counter.w ^ key.y, lo0);
+        key.x += 0x9E3779B9u;
+        key.y += 0xBB67AE85u;
+    }
+    return counter;
+}
+
+/**
+ * @brief Top 53 bits of two 32-bit words as a double in [0, 1).
+ */
+__device__ __forceinline__ double unitDouble(unsigned int hi, unsigned int lo) {
+    unsigned long long bits = (static_cast<unsigned long long>(hi) << 21) | (lo >> 11);
+    return static_cast<double>(bits) * 0x1.0p-53;
+}
+
+/**
+ * @brief Sums a value over the 32 lanes of a warp; lane 0 holds the total.
+ */
+__device__ __forceinline__ unsigned long long warpSum(unsigned long long value) {
+#pragma unroll
+    for (int offset = kWarpSize / 2; offset > 0; offset /= 2) value += __shfl_down_sync(0xFFFFFFFFu, value, offset);
+    return value;
+}
+
+/**
+ * @brief Throws `trials` Philox darts and adds the hits to `*hits`.
+ * @param hits   Device counter (zeroed by the host)
+ * @param trials Darts to throw
+ * @param key    Philox key (run seed)
+ */
+__global__ void countHitsKernel(unsigned long long* hits, unsigned long long trials, uint2 key) {
+    __shared__ unsigned long long warpHits[kGpuBlockThreads / kWarpSize];
+
+    unsigned long long local = 0;
+    unsigned long long stride = static_cast<unsigned long long>(gridDim.x) * blockDim.x;
+    for (unsigned long long dart = static_cast<unsigned long long>(blockIdx.x) * blockDim.x + threadIdx.x;
+         dart < trials; dart += stride) {
+        uint4 words = philox4x32Device(
+            make_uint4(static_cast<unsigned int>(dart), static_cast<unsigned int>(dart >> 32), kGpuStreamTag, 0u), key);
+        double x = unitDouble(words.x, words.y);
+        double y = unitDouble(words.z, words.w);
+        local += (x * x + y * y <= 1.0) ? 1ull : 0ull;
+    }
+
+    // Warp shuffle, then one shared-memory slot per warp, then a single atomic per block
+    unsigned int lane = threadIdx.x % kWarpSize;
+    unsigned int warp = threadIdx.x / kWarpSize;
+    local = warpSum(local);
+    if (lane == 0) warpHits[warp] = local;
+    __syncthreads();
+
+    if (warp == 0) {
+        local = lane < blockDim.x / kWarpSize ? warpHits[lane] : 0ull;
+        local = warpSum(local);
+        if (lane == 0) atomicAdd(hits, local);
+    }
+}
+
+/**
+ * @brief Throws `std::runtime_error` with a message if a CUDA call failed.
+ * @param status Return value of the call
+ * @param what   Call description for the message
+ */
+void checkCuda(cudaError_t status, const char* what) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(std::string("CUDA ") + what + ": " + cudaGetErrorString(status));
+    }
+}
+
+/**
+ * @brief Stream, events and counters reused by every run.
+ */
+struct GpuState {
+    cudaStream_t stream = nullptr;
+    cudaEvent_t start = nullptr;
+    cudaEvent_t stop = nullptr;
+    unsigned long long* deviceHits = nullptr;   ///< Device counter
+    unsigned long long* hostHits = nullptr;     ///< Pinned copy target
+
+    /**
+     * @brief Lazily created process-wide state (device 0).
+     * @return Reference to the state
+     */
+    static GpuState& global() {
+        static GpuState state = [] {
+            GpuState created;
+            checkCuda(cudaSetDevice(0), "set device");
+            checkCuda(cudaStreamCreateWithFlags(&created.stream, cudaStreamNonBlocking), "stream create");
+            checkCuda(cudaEventCreate(&created.start), "event create");
+            checkCuda(cudaEventCreate(&created.stop), "event create");
+            checkCuda(cudaMalloc(&created.deviceHits, sizeof(unsigned long long)), "malloc");
+            checkCuda(cudaMallocHost(&created.hostHits, sizeof(unsigned long long)), "host malloc");
+            return created;
+        }();
+        return state;
+    }
+};
+
+}  // namespace
+
+const GpuDevice& gpuDevice() {
+    static const GpuDevice device = [] {
+        GpuDevice probed;
+        int count = 0;
+        cudaError_t status = cudaGetDeviceCount(&count);
+        if (status != cudaSuccess || count == 0) {
+            probed.status = status != cudaSuccess ? cudaGetErrorString(status) : "no CUDA device found";
+            return probed;
+        }
+        cudaDeviceProp properties;
+        checkCuda(cudaGetDeviceProperties(&properties, 0), "device properties");
+        probed.available = true;
+        probed.name = properties.name;
+        probed.multiprocessors = properties.multiProcessorCount;
+        return probed;
+    }();
+    return device;
+}
+
+void gpuLaunchHits(std::uint64_t seed, std::int64_t trials) {
+    if (!gpuDevice().available) {
+        throw std::runtime_error("GPU run requested, but " + gpuDevice().status);
+    }
+    GpuState& state = GpuState::global();
+    checkCuda(cudaMemsetAsync(state.deviceHits, 0, sizeof(unsigned long long), state.stream), "memset");
+    checkCuda(cudaEventRecord(state.start, state.stream), "event record");
+    if (trials > 0) {
+        long long wanted = (trials + kGpuBlockThreads - 1) / kGpuBlockThreads;
+        int blocks = static_cast<int>(std::min<long long>(wanted, 1LL * gpuDevice().multiprocessors * kGpuBlocksPerSm));
+        uint2 key = make_uint2(static_cast<unsigned int>(seed), static_cast<unsigned int>(seed >> 32));
+        countHitsKernel<<<blocks, kGpuBlockThreads, 0, state.stream>>>(
+            state.deviceHits, static_cast<unsigned long long>(trials), key);
+        checkCuda(cudaGetLastError(), "kernel launch");
+    }
+    checkCuda(cudaEventRecord(state.stop, state.stream), "event record");
+    checkCuda(cudaMemcpyAsync(state.hostHits, state.deviceHits, sizeof(unsigned long long), cudaMemcpyDeviceToHost,
+                              state.stream), "copy");
+}
+
+GpuHits gpuWaitHits() {
+    GpuState& state = GpuState::global();
+    checkCuda(cudaStreamSynchronize(state.stream), "stream sync");
+    float ms = 0.0f;
+    checkCuda(cudaEventElapsedTime(&ms, state.start, state.stop), "event time");
+    return {static_cast<std::int64_t>(*state.hostHits), static_cast<std::int64_t>(static_cast<double>(ms) * 1e6)};
+}
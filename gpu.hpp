@@ -0,0 +1,111 @@
+// ========================================
+// gpu.hpp - CUDA offload backend (host API)
+// ========================================
+/**
+ * @file gpu.hpp
+ * @brief Host interface of the GPU π kernel in `gpu.cu`, with stubs when CUDA is not compiled in.
+ *
+ * The device kernel throws every dart on the GPU and returns a single 64-bit hit count, so the only
+ * host↔device traffic per run is one memset and one 8-byte copy:
+ * - Each thread draws its darts from Philox4x32-10 keyed by the run seed, one block per dart
+ *   (x from words 0–1, y from words 2–3, 53-bit doubles), so no generator state lives in memory
+ * - Darts are indexed over a grid-stride loop, so any grid size draws the same darts
+ * - Per-thread counts are summed with `__shfl_down_sync` inside each warp, then across the block's
+ *   warps through shared memory, and one `atomicAdd` per block folds them into the device counter
+ *
+ * Counter word 2 carries `kGpuStreamTag`, while the CPU chunk seeds (`philoxStreamSeed`) keep it
+ * zero, so GPU darts never replay a CPU stream even when both sides share the run seed.
+ *
+ * ---
+ *
+ * ## Build
+ * CUDA is opt-in: `cmake -DMC_ENABLE_CUDA=ON` compiles `gpu.cu` and defines `MC_HAVE_CUDA`.
+ * Without it these functions are stubs, `gpuDevice().available` is false, and the GPU methods are
+ * left out of `All` and `--list=names`.
+ *
+ * ## Example
+ * ```cpp
+ * if (gpuDevice().available) {
+ *     gpuLaunchHits(seed, 1'000'000'000);     // asynchronous
+ *     GpuHits result = gpuWaitHits();         // hits and device time
+ * }
+ * ```
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/// Philox counter word 2 of every GPU dart ("GPU1"); CPU chunk seeds use 0 there.
+constexpr std::uint32_t kGpuStreamTag = 0x47505531u;
+
+/**
+ * @brief The CUDA device used by the GPU methods (device 0).
+ */
+struct GpuDevice {
+    bool available = false;     ///< Whether a usable device was found
+    std::string name;           ///< Device name, e.g. "NVIDIA A100-SXM4-40GB"
+    std::string status;         ///< Why the device is unavailable (empty when available)
+    int multiprocessors = 0;    ///< Streaming multiprocessors, sizes the grid
+};
+
+/**
+ * @brief Result of one GPU run.
+ */
+struct GpuHits {
+    std::int64_t hits = 0;       ///< Darts inside the quarter circle
+    std::int64_t deviceNs = 0;   ///< Kernel time measured by CUDA events
+};
+
+#ifdef MC_HAVE_CUDA
+
+/**
+ * @brief Probes the CUDA runtime once and describes device 0.
+ * @return Device description (cached)
+ */
+const GpuDevice& gpuDevice();
+
+/**
+ * @brief Starts a GPU run on the backend's stream and returns immediately.
+ * @param seed   Philox key of the run
+ * @param trials Darts to throw (0 launches nothing)
+ * @throws std::runtime_error without a usable device or when a CUDA call fails
+ */
+void gpuLaunchHits(std::uint64_t seed, std::int64_t trials);
+
+/**
+ * @brief Waits for the run started by `gpuLaunchHits`.
+ * @return Hit count and device time
+ * @throws std::runtime_error when a CUDA call fails
+ */
+GpuHits gpuWaitHits();
+
+#else
+
+inline const GpuDevice& gpuDevice() {
+    static const GpuDevice none{false, "", "built without CUDA (configure with -DMC_ENABLE_CUDA=ON)", 0};
+    return none;
+}
+
+inline void gpuLaunchHits(std::uint64_t, std::int64_t) {
+    throw std::runtime_error("GPU run requested, but " + gpuDevice().status);
+}
+
+inline GpuHits gpuWaitHits() {
+    return {};
+}
+
+#endif
+
+/**
+ * @brief Runs `trials` darts on the GPU and waits for the count.
+ * @param seed   Philox key of the run
+ * @param trials Darts to throw
+ * @return Darts inside the quarter circle
+ */
+inline std::int64_t gpuCountHits(std::uint64_t seed, std::int64_t trials) {
+    gpuLaunchHits(seed, trials);
+    return gpuWaitHits().hits;
+}
@@ -0,0 +1,414 @@
+// ========================================
+// integrand.hpp - Generic vectorized Monte Carlo integration
+// ========================================
+/**
+ * @file integrand.hpp
+ * @brief Templated region / expectation kernels, specialized at compile time per ISA and lane count.
+ *
+ * The π kernels hard-wire one integrand: the quarter disc `x² + y² ≤ 1`. This header factors the
+ * machinery around it — per-lane xoshiro256+ streams, 32-bit hit blocks, masked tails — into two
+ * engines parameterized on a vector ISA (`Ops`) and a functor:
+ *
+ * | Engine             | Functor provides                          | Result                         |
+ * |--------------------|-------------------------------------------|--------------------------------|
+ * | `countRegionHits`  | `inside<Ops>(x) → Ops::Mask`              | Darts inside the region         |
+ * | `expectationSums`  | `value<Ops>(x) → Ops::Vec`                | Σ f and Σ f² over the darts     |
+ *
+ * `x` is an array of `Dim` coordinate vectors, each uniform on [0, 1). The functor is written
+ * once against the `Ops` vocabulary (`add`, `mul`, `fmadd`, `lessEqual`, ...) and instantiated
+ * per backend, so it compiles to AVX-512, AVX2, NEON or scalar code with no runtime dispatch in
+ * the hot loop.
+ *
+ * ---
+ *
+ * ## Ops
+ * | Ops             | `Vec`         | `Mask`        | Lanes | Generator               |
+ * |-----------------|---------------|---------------|-------|-------------------------|
+ * | `SimdOpsAVX512` | `__m512d`     | `__mmask8`    | 8     | `Xoshiro256PlusAVX512`  |
+ * | `SimdOpsAVX2`   | `__m256d`     | `__m256d`     | 4     | `Xoshiro256PlusAVX`     |
+ * | `SimdOpsNEON`   | `float64x2_t` | `uint64x2_t`  | 2     | `Xoshiro256PlusNEON`    |
+ * | `SimdOpsScalar` | `double`      | `bool`        | 1     | `Xoshiro256Plus`        |
+ *
+ * x86 `Ops` functions carry their ISA's target attribute. Engines are generic templates marked
+ * `MC_FLATTEN`, entered through `IntegrandEngine<Ops>`, whose members carry the same attribute,
+ * so the loop, the functor and every `Ops` call inline into one ISA-specific function.
+ *
+ * ## Streams
+ * Coordinates are drawn from `kIntegrandStreams` independent generators (coordinate d from
+ * stream d mod 2), seeded in order from one SplitMix64 sequence. Two chains keep the
+ * per-iteration dependency short for any `Dim`, and for `Dim = 2` the draws are exactly those of
+ * the original X / Y generators — `SIMDXoshiro` is `UnitBall<2>` on this engine, hit for hit.
+ *
+ * ## Writing an Integrand
+ * ```cpp
+ * struct Annulus {                       // quarter annulus 0.25 ≤ x² + y² ≤ 1
+ *     static constexpr int dimensions = 2;
+ *     template <typename Ops>
+ *     static typename Ops::Mask inside(const typename Ops::Vec (&x)[2]) {
+ *         typename Ops::Vec r2 = Ops::fmadd(x[0], x[0], Ops::mul(x[1], x[1]));
+ *         return Ops::maskAnd(Ops::lessEqual(Ops::set1(0.25), r2), Ops::lessEqual(r2, Ops::set1(1.0)));
+ *     }
+ * };
+ * std::int64_t hits = estimateVolume<Annulus>(pool, 100'000'000).hits;   // integrate.hpp
+ * ```
+ * Functors carry no target attribute, so GCC's `-Wpsabi` flags their vector returns; the build
+ * passes `-Wno-psabi` because they are always flattened into a targeted caller and never called
+ * across that ABI.
+ */
+
+#pragma once
+
+#include "rng.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define MC_FLATTEN __attribute__((flatten))
+#else
+    #define MC_FLATTEN
+#endif
+
+/**
+ * @brief Trials per 32-bit accumulation block in the vector kernels.
+ *
+ * Hot loops count hits in a `uint32_t` (a block's hits always fit) and widen into the
+ * 64-bit total once per block, so 64-bit trial counts add nothing to the per-iteration cost.
+ * Must be a multiple of every batch size (≤ 16).
+ */
+constexpr std::int64_t kHitBlockTrials = std::int64_t{1} << 30;
+
+/**
+ * @brief Number of full batches in the next accumulation block.
+ * @param remaining Vectorizable trials not yet processed
+ * @param batch     Trials per vector iteration
+ * @return Iteration count for a 32-bit block loop
+ */
+inline std::uint32_t blockIterations(std::int64_t remaining, int batch) {
+    return static_cast<std::uint32_t>(std::min(kHitBlockTrials, remaining) / batch);
+}
+
+/// Independent coordinate generators per engine call (coordinate d uses stream d mod this).
+constexpr int kIntegrandStreams = 2;
+
+/**
+ * @brief Scalar ops: one dart per step, plain `double` arithmetic.
+ */
+struct SimdOpsScalar {
+    using Vec = double;                       ///< One coordinate
+    using Mask = bool;                        ///< One lane flag
+    using Generator = Xoshiro256Plus;         ///< Per-stream generator
+    static constexpr int lanes = 1;           ///< Darts per step
+
+    static Vec uniform(Generator& gen) { return gen.nextDouble(); }   ///< Uniform [0, 1)
+    static Vec set1(double v) { return v; }                           ///< Broadcast
+    static Vec load(const double* p) { return *p; }                   ///< Load one coordinate
+    static Vec add(Vec a, Vec b) { return a + b; }                    ///< a + b
+    static Vec sub(Vec a, Vec b) { return a - b; }                    ///< a − b
+    static Vec mul(Vec a, Vec b) { return a * b; }                    ///< a · b
+    static Vec fmadd(Vec a, Vec b, Vec c) { return a * b + c; }       ///< a · b + c
+    static Mask lessEqual(Vec a, Vec b) { return a <= b; }            ///< a ≤ b per lane
+    static Mask maskAnd(Mask a, Mask b) { return a && b; }            ///< Lane-wise and
+    static Mask firstLanes(int n) { return n > 0; }                   ///< Lanes [0, n)
+    static int countMask(Mask m) { return static_cast<int>(m); }      ///< Set lanes
+    static Vec select(Mask m, Vec v) { return m ? v : 0.0; }          ///< v where set, else 0
+    static double reduceAdd(Vec v) { return v; }                      ///< Sum of lanes
+};
+
+#ifdef USE_AVX
+/**
+ * @brief AVX2 ops: 4 doubles per step; masks are all-ones compare lanes.
+ *
+ * `fmadd` is a multiply then add (the AVX2 target does not assume FMA), matching `countInsideCircle_AVX`.
+ */
+struct SimdOpsAVX2 {
+    using Vec = __m256d;                      ///< Four coordinates
+    using Mask = __m256d;                     ///< All-ones / all-zeros lanes
+    using Generator = Xoshiro256PlusAVX;      ///< Per-stream generator
+    static constexpr int lanes = 4;           ///< Darts per step
+
+    MC_TARGET_AVX2 static Vec uniform(Generator& gen) { return gen.nextDouble(); }
+    MC_TARGET_AVX2 static Vec set1(double v) { return _mm256_set1_pd(v); }
+    MC_TARGET_AVX2 static Vec load(const double* p) { return _mm256_load_pd(p); }
+    MC_TARGET_AVX2 static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    MC_TARGET_AVX2 static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+    MC_TARGET_AVX2 static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    MC_TARGET_AVX2 static Vec fmadd(Vec a, Vec b, Vec c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+    MC_TARGET_AVX2 static Mask lessEqual(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    MC_TARGET_AVX2 static Mask maskAnd(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+    MC_TARGET_AVX2 static Mask firstLanes(int n) {
+        return _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3)));
+    }
+    MC_TARGET_AVX2 static int countMask(Mask m) { return __builtin_popcount(_mm256_movemask_pd(m)); }
+    MC_TARGET_AVX2 static Vec select(Mask m, Vec v) { return _mm256_and_pd(m, v); }
+    MC_TARGET_AVX2 static double reduceAdd(Vec v) {
+        __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+};
+#endif
+
+#ifdef USE_AVX512
+/**
+ * @brief AVX-512 ops: 8 doubles per step; compares write `__mmask8` registers.
+ */
+struct SimdOpsAVX512 {
+    using Vec = __m512d;                      ///< Eight coordinates
+    using Mask = __mmask8;                    ///< One bit per lane
+    using Generator = Xoshiro256PlusAVX512;   ///< Per-stream generator
+    static constexpr int lanes = 8;           ///< Darts per step
+
+    MC_TARGET_AVX512 static Vec uniform(Generator& gen) { return gen.nextDouble(); }
+    MC_TARGET_AVX512 static Vec set1(double v) { return _mm512_set1_pd(v); }
+    MC_TARGET_AVX512 static Vec load(const double* p) { return _mm512_load_pd(p); }
+    MC_TARGET_AVX512 static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+    MC_TARGET_AVX512 static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+    MC_TARGET_AVX512 static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+    MC_TARGET_AVX512 static Vec fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_pd(a, b, c); }
+    MC_TARGET_AVX512 static Mask lessEqual(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    MC_TARGET_AVX512 static Mask maskAnd(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+    MC_TARGET_AVX512 static Mask firstLanes(int n) { return static_cast<Mask>((1u << n) - 1); }
+    MC_TARGET_AVX512 static int countMask(Mask m) { return __builtin_popcount(static_cast<unsigned>(m)); }
+    MC_TARGET_AVX512 static Vec select(Mask m, Vec v) { return _mm512_maskz_mov_pd(m, v); }
+    MC_TARGET_AVX512 static double reduceAdd(Vec v) {
+        // Spilled rather than _mm512_reduce_add_pd, which trips GCC 12's -Wuninitialized
+        alignas(64) double lane[lanes];
+        _mm512_store_pd(lane, v);
+        return ((lane[0] + lane[1]) + (lane[2] + lane[3])) + ((lane[4] + lane[5]) + (lane[6] + lane[7]));
+    }
+};
+#endif
+
+#ifdef USE_NEON
+/**
+ * @brief NEON ops: 2 doubles per step; masks are all-ones compare lanes.
+ */
+struct SimdOpsNEON {
+    using Vec = float64x2_t;                  ///< Two coordinates
+    using Mask = uint64x2_t;                  ///< All-ones / all-zeros lanes
+    using Generator = Xoshiro256PlusNEON;     ///< Per-stream generator
+    static constexpr int lanes = 2;           ///< Darts per step
+
+    static Vec uniform(Generator& gen) { return gen.nextDouble(); }
+    static Vec set1(double v) { return vdupq_n_f64(v); }
+    static Vec load(const double* p) { return vld1q_f64(p); }
+    static Vec add(Vec a, Vec b) { return vaddq_f64(a, b); }
+    static Vec sub(Vec a, Vec b) { return vsubq_f64(a, b); }
+    static Vec mul(Vec a, Vec b) { return vmulq_f64(a, b); }
+    static Vec fmadd(Vec a, Vec b, Vec c) { return vaddq_f64(vmulq_f64(a, b), c); }
+    static Mask lessEqual(Vec a, Vec b) { return vcleq_f64(a, b); }
+    static Mask maskAnd(Mask a, Mask b) { return vandq_u64(a, b); }
+    static Mask firstLanes(int n) {
+        const std::uint64_t index[2] = {0, 1};
+        return vcltq_u64(vld1q_u64(index), vdupq_n_u64(static_cast<std::uint64_t>(n)));
+    }
+    static int countMask(Mask m) { return static_cast<int>(vaddvq_u64(vshrq_n_u64(m, 63))); }
+    static Vec select(Mask m, Vec v) { return vreinterpretq_f64_u64(vandq_u64(m, vreinterpretq_u64_f64(v))); }
+    static double reduceAdd(Vec v) { return vaddvq_f64(v); }
+};
+#endif
+
+/**
+ * @brief Seeds `Count` generators from one sequence, in index order.
+ * @param seeder Seed sequence
+ * @return Generators 0 .. Count−1
+ */
+template <typename Generator, std::size_t... Index>
+inline std::array<Generator, sizeof...(Index)> makeStreams(SplitMix64& seeder, std::index_sequence<Index...>) {
+    // Braced initializers are evaluated left to right, so stream i always gets the i-th seeds
+    return {{(static_cast<void>(Index), Generator(seeder))...}};
+}
+
+/**
+ * @brief Draws one dart per lane: coordinate d from stream d mod `kIntegrandStreams`.
+ * @param streams Coordinate generators
+ * @param x       Output coordinate vectors
+ */
+template <typename Ops, int Dim, std::size_t Streams>
+inline void drawDarts(std::array<typename Ops::Generator, Streams>& streams, typename Ops::Vec (&x)[Dim]) {
+    for (int d = 0; d < Dim; ++d) x[d] = Ops::uniform(streams[static_cast<std::size_t>(d) % Streams]);
+}
+
+/**
+ * @brief Darts inside `Region` among `trials` uniform darts on [0, 1)^Dim.
+ *
+ * Full vectors are counted in 32-bit blocks; the `trials mod lanes` remainder comes from one
+ * extra draw under a lane mask.
+ *
+ * @tparam Ops    ISA ops
+ * @tparam Region Indicator functor (`dimensions`, `inside<Ops>`)
+ * @param seeder Seed sequence for the coordinate streams
+ * @param trials Darts to throw
+ * @return Hits inside the region
+ */
+template <typename Ops, typename Region>
+inline std::int64_t regionHitsLoop(SplitMix64& seeder, std::int64_t trials) {
+    constexpr int dim = Region::dimensions;
+    constexpr std::size_t streamCount = dim < kIntegrandStreams ? dim : kIntegrandStreams;
+    auto streams = makeStreams<typename Ops::Generator>(seeder, std::make_index_sequence<streamCount>{});
+
+    constexpr int batch = Ops::lanes;
+    std::int64_t loopEnd = trials - (trials % batch);
+    std::int64_t count = 0;
+    typename Ops::Vec x[dim];
+
+    for (std::int64_t block = 0; block < loopEnd; block += kHitBlockTrials) {
+        std::uint32_t iterations = blockIterations(loopEnd - block, batch);
+        std::uint32_t blockCount = 0;
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            drawDarts<Ops>(streams, x);
+            blockCount += static_cast<std::uint32_t>(Ops::countMask(Region::template inside<Ops>(x)));
+        }
+        count += blockCount;
+    }
+
+    if (trials > loopEnd) {
+        drawDarts<Ops>(streams, x);
+        typename Ops::Mask active = Ops::firstLanes(static_cast<int>(trials - loopEnd));
+        count += Ops::countMask(Ops::maskAnd(Region::template inside<Ops>(x), active));
+    }
+    return count;
+}
+
+/**
+ * @brief Running sums of an expectation estimate.
+ */
+struct IntegralSums {
+    double sum = 0.0;           ///< Σ f(x)
+    double sumSquares = 0.0;    ///< Σ f(x)²
+};
+
+/**
+ * @brief Σ f and Σ f² of `Function` over `trials` uniform darts on [0, 1)^Dim.
+ * @tparam Ops      ISA ops
+ * @tparam Function Value functor (`dimensions`, `value<Ops>`)
+ * @param seeder Seed sequence for the coordinate streams
+ * @param trials Darts to throw
+ * @return Sums over all darts (the tail is masked)
+ */
+template <typename Ops, typename Function>
+inline IntegralSums expectationSumsLoop(SplitMix64& seeder, std::int64_t trials) {
+    constexpr int dim = Function::dimensions;
+    constexpr std::size_t streamCount = dim < kIntegrandStreams ? dim : kIntegrandStreams;
+    auto streams = makeStreams<typename Ops::Generator>(seeder, std::make_index_sequence<streamCount>{});
+
+    constexpr int batch = Ops::lanes;
+    std::int64_t loopEnd = trials - (trials % batch);
+    typename Ops::Vec sum = Ops::set1(0.0), sumSquares = Ops::set1(0.0);
+    typename Ops::Vec x[dim];
+
+    for (std::int64_t i = 0; i < loopEnd; i += batch) {
+        drawDarts<Ops>(streams, x);
+        typename Ops::Vec value = Function::template value<Ops>(x);
+        sum = Ops::add(sum, value);
+        sumSquares = Ops::fmadd(value, value, sumSquares);
+    }
+
+    if (trials > loopEnd) {
+        drawDarts<Ops>(streams, x);
+        typename Ops::Vec value = Ops::select(Ops::firstLanes(static_cast<int>(trials - loopEnd)),
+                                              Function::template value<Ops>(x));
+        sum = Ops::add(sum, value);
+        sumSquares = Ops::fmadd(value, value, sumSquares);
+    }
+    return {Ops::reduceAdd(sum), Ops::reduceAdd(sumSquares)};
+}
+
+/**
+ * @brief ISA entry points of the engines; each specialization carries its ISA's target attribute.
+ * @tparam Ops ISA ops
+ */
+template <typename Ops>
+struct IntegrandEngine {
+    /// @copydoc regionHitsLoop
+    template <typename Region>
+    MC_FLATTEN static std::int64_t countRegionHits(SplitMix64& seeder, std::int64_t trials) {
+        return regionHitsLoop<Ops, Region>(seeder, trials);
+    }
+
+    /// @copydoc expectationSumsLoop
+    template <typename Function>
+    MC_FLATTEN static IntegralSums expectationSums(SplitMix64& seeder, std::int64_t trials) {
+        return expectationSumsLoop<Ops, Function>(seeder, trials);
+    }
+};
+
+#ifdef USE_AVX
+/// AVX2 entry points (see the primary template).
+template <>
+struct IntegrandEngine<SimdOpsAVX2> {
+    template <typename Region>
+    MC_TARGET_AVX2 MC_FLATTEN static std::int64_t countRegionHits(SplitMix64& seeder, std::int64_t trials) {
+        return regionHitsLoop<SimdOpsAVX2, Region>(seeder, trials);
+    }
+
+    template <typename Function>
+    MC_TARGET_AVX2 MC_FLATTEN static IntegralSums expectationSums(SplitMix64& seeder, std::int64_t trials) {
+        return expectationSumsLoop<SimdOpsAVX2, Function>(seeder, trials);
+    }
+};
+#endif
+
+#ifdef USE_AVX512
+/// AVX-512 entry points (see the primary template).
+template <>
+struct IntegrandEngine<SimdOpsAVX512> {
+    template <typename Region>
+    MC_TARGET_AVX512 MC_FLATTEN static std::int64_t countRegionHits(SplitMix64& seeder, std::int64_t trials) {
+        return regionHitsLoop<SimdOpsAVX512, Region>(seeder, trials);
+    }
+
+    template <typename Function>
+    MC_TARGET_AVX512 MC_FLATTEN static IntegralSums expectationSums(SplitMix64& seeder, std::int64_t trials) {
+        return expectationSumsLoop<SimdOpsAVX512, Function>(seeder, trials);
+    }
+};
+#endif
+
+/**
+ * @brief Orthant of the unit `Dim`-ball: Σ xᵢ² ≤ 1 on [0, 1)^Dim, volume π^(Dim/2) / Γ(Dim/2 + 1) / 2^Dim.
+ *
+ * `UnitBall<2>` is the π quarter disc. Squares are accumulated from the last coordinate down,
+ * so for `Dim = 2` the sum is `fmadd(x, x, y · y)` — bit-identical to `countInsideCircle_*`.
+ */
+template <int Dim>
+struct UnitBall {
+    static_assert(Dim >= 1, "UnitBall needs at least one dimension");
+    static constexpr int dimensions = Dim;   ///< Coordinates per dart
+
+    /**
+     * @brief Lanes inside the ball.
+     * @param x Coordinate vectors
+     * @return Lane mask
+     */
+    template <typename Ops>
+    static typename Ops::Mask inside(const typename Ops::Vec (&x)[Dim]) {
+        typename Ops::Vec r2 = Ops::mul(x[Dim - 1], x[Dim - 1]);
+        for (int d = Dim - 2; d >= 0; --d) r2 = Ops::fmadd(x[d], x[d], r2);
+        return Ops::lessEqual(r2, Ops::set1(1.0));
+    }
+};
+
+/**
+ * @brief Σ xᵢ² on [0, 1)^Dim; its expectation is Dim / 3 (a smoke test for the expectation engine).
+ */
+template <int Dim>
+struct SquaredNorm {
+    static_assert(Dim >= 1, "SquaredNorm needs at least one dimension");
+    static constexpr int dimensions = Dim;   ///< Coordinates per dart
+
+    /**
+     * @brief Function value per lane.
+     * @param x Coordinate vectors
+     * @return Σ xᵢ²
+     */
+    template <typename Ops>
+    static typename Ops::Vec value(const typename Ops::Vec (&x)[Dim]) {
+        typename Ops::Vec r2 = Ops::mul(x[Dim - 1], x[Dim - 1]);
+        for (int d = Dim - 2; d >= 0; --d) r2 = Ops::fmadd(x[d], x[d], r2);
+        return r2;
+    }
+};
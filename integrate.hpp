@@ -0,0 +1,230 @@
+// ========================================
+// integrate.hpp - Threaded integrals on the integrand engine
+// ========================================
+/**
+ * @file integrate.hpp
+ * @brief Runs `integrand.hpp` functors on the active SIMD backend across a `ThreadPool`.
+ *
+ * `integrand.hpp` compiles one loop per (ISA, functor) pair; this header picks the instance that
+ * matches `activeSimdBackend()` once per call and splits the trials into pool chunks, each seeded
+ * through `chunkSeed()` like every π kernel. Results come back as an estimate with its standard
+ * error, so callers never handle raw hit counts.
+ *
+ * | Function                        | Functor        | Estimates                              |
+ * |---------------------------------|----------------|----------------------------------------|
+ * | `estimateVolume<Region>`        | `inside<Ops>`  | Volume of the region inside [0, 1)^Dim |
+ * | `estimateExpectation<Function>` | `value<Ops>`   | E[f(U)] for U uniform on [0, 1)^Dim    |
+ *
+ * ## Determinism
+ * Volumes are integer hit counts, so under `--seed` they are identical for any thread count.
+ * Expectation sums are accumulated per worker in `alignas(64)` slots and combined after the run;
+ * the value is reproducible to rounding, since which worker sums which chunk can vary.
+ *
+ * ## Example
+ * ```cpp
+ * ThreadPool pool(8);
+ * IntegralEstimate ball = estimateVolume<UnitBall<5>>(pool, 100'000'000);
+ * double volume = ball.value * 32.0;   // full 5-ball from one orthant: 8π²/15 ≈ 5.2638
+ * ```
+ *
+ * `montecarlo --integrate` runs `integralChecks()` — integrals with a closed form — and fails when
+ * an estimate lands more than `kIntegralCheckSigmas` standard errors from it, so CI catches an
+ * engine instance that compiles but computes the wrong thing.
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "integrand.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Monte Carlo estimate with its one-sigma error.
+ */
+struct IntegralEstimate {
+    double value = 0.0;            ///< Estimated volume or expectation
+    double standardError = 0.0;    ///< Standard error of `value`
+    std::int64_t samples = 0;      ///< Darts used
+    std::int64_t hits = 0;         ///< Darts inside the region (volumes only)
+};
+
+/// Region kernel for one ISA: seed sequence and trials in, hits out.
+using RegionKernel = std::int64_t (*)(SplitMix64&, std::int64_t);
+
+/// Expectation kernel for one ISA: seed sequence and trials in, sums out.
+using ExpectationKernel = IntegralSums (*)(SplitMix64&, std::int64_t);
+
+/**
+ * @brief `IntegrandEngine` instance for a backend, by name.
+ * @tparam Region Indicator functor
+ * @param backend Backend whose ISA to use (falls back to scalar for unknown names)
+ * @return Region kernel for that ISA
+ */
+template <typename Region>
+inline RegionKernel regionKernelFor(const SimdBackend& backend) {
+#ifdef USE_AVX512
+    if (std::strcmp(backend.name, "avx512") == 0) return IntegrandEngine<SimdOpsAVX512>::countRegionHits<Region>;
+#endif
+#ifdef USE_AVX
+    if (std::strcmp(backend.name, "avx2") == 0) return IntegrandEngine<SimdOpsAVX2>::countRegionHits<Region>;
+#endif
+#ifdef USE_NEON
+    if (std::strcmp(backend.name, "neon") == 0) return IntegrandEngine<SimdOpsNEON>::countRegionHits<Region>;
+#endif
+    (void)backend;
+    return IntegrandEngine<SimdOpsScalar>::countRegionHits<Region>;
+}
+
+/**
+ * @brief `IntegrandEngine` instance for a backend, by name.
+ * @tparam Function Value functor
+ * @param backend Backend whose ISA to use (falls back to scalar for unknown names)
+ * @return Expectation kernel for that ISA
+ */
+template <typename Function>
+inline ExpectationKernel expectationKernelFor(const SimdBackend& backend) {
+#ifdef USE_AVX512
+    if (std::strcmp(backend.name, "avx512") == 0) return IntegrandEngine<SimdOpsAVX512>::expectationSums<Function>;
+#endif
+#ifdef USE_AVX
+    if (std::strcmp(backend.name, "avx2") == 0) return IntegrandEngine<SimdOpsAVX2>::expectationSums<Function>;
+#endif
+#ifdef USE_NEON
+    if (std::strcmp(backend.name, "neon") == 0) return IntegrandEngine<SimdOpsNEON>::expectationSums<Function>;
+#endif
+    (void)backend;
+    return IntegrandEngine<SimdOpsScalar>::expectationSums<Function>;
+}
+
+/**
+ * @brief Volume of `Region` within the unit cube, on the active backend.
+ * @tparam Region Indicator functor (`dimensions`, `inside<Ops>`)
+ * @param pool   Workers to run chunks on
+ * @param trials Darts to throw
+ * @return Hit fraction and its binomial standard error
+ */
+template <typename Region>
+inline IntegralEstimate estimateVolume(ThreadPool& pool, std::int64_t trials) {
+    RegionKernel kernel = regionKernelFor<Region>(activeSimdBackend());
+    std::int64_t hits = pool.run(trials, kDefaultChunkTrials, [kernel](std::int64_t n) {
+        SplitMix64 seeder{chunkSeed()};
+        return kernel(seeder, n);
+    });
+
+    IntegralEstimate estimate;
+    estimate.samples = trials;
+    estimate.hits = hits;
+    if (trials <= 0) return estimate;
+    double p = static_cast<double>(hits) / static_cast<double>(trials);
+    estimate.value = p;
+    estimate.standardError = std::sqrt(p * (1.0 - p) / static_cast<double>(trials));
+    return estimate;
+}
+
+/// Per-worker expectation sums, one cache line each.
+struct alignas(64) PaddedSums {
+    IntegralSums sums;   ///< Σ f and Σ f² over this worker's chunks
+};
+
+/**
+ * @brief E[f(U)] for U uniform on [0, 1)^Dim, on the active backend.
+ * @tparam Function Value functor (`dimensions`, `value<Ops>`)
+ * @param pool   Workers to run chunks on
+ * @param trials Darts to throw
+ * @return Sample mean and its standard error
+ */
+template <typename Function>
+inline IntegralEstimate estimateExpectation(ThreadPool& pool, std::int64_t trials) {
+    ExpectationKernel kernel = expectationKernelFor<Function>(activeSimdBackend());
+    auto slots = std::make_shared<std::vector<PaddedSums>>(pool.size());
+    pool.run(trials, kDefaultChunkTrials, [kernel, slots](std::int64_t n) {
+        SplitMix64 seeder{chunkSeed()};
+        IntegralSums chunk = kernel(seeder, n);
+        IntegralSums& total = (*slots)[ThreadPool::currentWorker()].sums;
+        total.sum += chunk.sum;
+        total.sumSquares += chunk.sumSquares;
+        return std::int64_t{0};
+    });
+
+    IntegralSums total;
+    for (const PaddedSums& slot : *slots) {
+        total.sum += slot.sums.sum;
+        total.sumSquares += slot.sums.sumSquares;
+    }
+
+    IntegralEstimate estimate;
+    estimate.samples = trials;
+    if (trials <= 0) return estimate;
+    double n = static_cast<double>(trials);
+    double mean = total.sum / n;
+    double variance = std::max(0.0, total.sumSquares / n - mean * mean);
+    estimate.value = mean;
+    estimate.standardError = std::sqrt(variance / n);
+    return estimate;
+}
+
+/// Standard errors an `--integrate` estimate may miss its closed form by before the check fails.
+constexpr double kIntegralCheckSigmas = 5.0;
+
+/**
+ * @brief One integral with a known value, for `--integrate`.
+ */
+struct IntegralCheck {
+    const char* name;                                                   ///< Printed name
+    const char* description;                                            ///< What is estimated
+    double scale;                                                       ///< Estimate multiplier (e.g. orthants)
+    double exact;                                                       ///< Closed form of `scale · value`
+    std::function<IntegralEstimate(ThreadPool&, std::int64_t)> estimate;   ///< Runs the engine
+};
+
+/**
+ * @brief The integrals `--integrate` checks: a volume and an expectation off the π path.
+ * @return Checks, in print order
+ */
+inline std::vector<IntegralCheck> integralChecks() {
+    return {
+        {"Ball5", "volume of the unit 5-ball, 32 orthants", 32.0, 8.0 * kPi * kPi / 15.0,
+         estimateVolume<UnitBall<5>>},
+        {"Expectation3", "E[|U|^2] for U uniform on [0, 1)^3", 1.0, 1.0, estimateExpectation<SquaredNorm<3>>},
+    };
+}
+
+/**
+ * @brief Runs every `integralChecks()` entry on the active backend and compares it with its closed form.
+ * @param pool   Workers to run chunks on
+ * @param trials Darts per integral
+ * @return false if an estimate is more than `kIntegralCheckSigmas` standard errors off
+ */
+inline bool runIntegralChecks(ThreadPool& pool, std::int64_t trials) {
+    std::cout << "[INFO] Integrals: " << trials << " darts each on " << activeSimdBackend().name << ", "
+              << pool.size() << " threads, tolerance " << kIntegralCheckSigmas << " standard errors\n";
+    bool ok = true;
+    for (const IntegralCheck& check : integralChecks()) {
+        auto start = std::chrono::steady_clock::now();
+        IntegralEstimate estimate = check.estimate(pool, trials);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double value = check.scale * estimate.value;
+        double error = check.scale * estimate.standardError;
+        double z = (value - check.exact) / std::max(error, 1e-300);
+        std::cout << check.name << " (" << check.description << "):\n"
+                  << "  Estimate: " << value << " +/- " << error << " (exact " << check.exact << ", z " << z << ")\n"
+                  << "  Time: " << seconds << "s (" << static_cast<double>(trials) / seconds / 1e6 << " M darts/s)\n";
+        if (!(std::fabs(value - check.exact) <= kIntegralCheckSigmas * error + 1e-12)) {
+            std::cerr << "[ERROR] " << check.name << " estimate " << value << " is " << z
+                      << " standard errors from its closed form " << check.exact << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,437 @@
+// ========================================
+// jobs.hpp - Asynchronous job API for embedding the engine
+// ========================================
+/**
+ * @file jobs.hpp
+ * @brief Non-blocking submission of (method, trials, deadline) jobs to one shared set of workers.
+ *
+ * `ThreadPool::run()` blocks its caller and runs one job at a time, which suits the CLI but not a
+ * request-serving process. `JobScheduler` keeps a fixed set of workers and a queue of active jobs;
+ * `submit()` returns a `JobHandle` immediately, with a future for the result, a progress snapshot
+ * and cancellation:
+ * - **Multiplexing:** a worker pops the job at the front of the queue, claims one chunk of it and
+ *   puts the job back at the end while chunks remain, so concurrent jobs interleave chunk by
+ *   chunk and a small job never waits behind a large one. No thread is created per job
+ * - **Deadlines and cancellation:** both are checked before each chunk is claimed. The job then
+ *   stops claiming chunks, waits for its running ones, and resolves with the trials done so far —
+ *   still a valid (less precise) estimate
+ * - **Errors:** a kernel that throws (e.g. `PoolExhausted`) fails only its own job; the message is
+ *   returned in `JobResult::error` and the workers keep serving the other jobs. Unknown or
+ *   unavailable methods and invalid trial counts resolve the handle as `Failed` at once
+ *
+ * ---
+ *
+ * ## Kernels
+ * Only `Pool` methods can be submitted: their chunk kernels are what the workers interleave.
+ * Chunks run with the same `RunSeed::currentChunk()` indices as on a `ThreadPool`, so under
+ * `--seed` a job's hits do not depend on how it was interleaved, and `ThreadPool::currentWorker()`
+ * reports the scheduler worker. `prepare` / `report` hooks are not run.
+ *
+ * ## C++17
+ * The tree builds as C++17, so results come through `std::shared_future` and an optional
+ * `onComplete` callback (run on the worker that finishes the job) rather than a C++20 awaitable;
+ * a coroutine wrapper can resume from that callback.
+ *
+ * ## Example
+ * ```cpp
+ * JobScheduler scheduler(8);
+ * JobHandle job = scheduler.submit({"SIMDXoshiro", 50'000'000, std::chrono::milliseconds(20)});
+ * JobProgress seen = job.progress();       // trials done so far, any time
+ * JobResult result = job.wait();           // Completed, or DeadlineExceeded with a partial estimate
+ * ```
+ */
+
+#pragma once
+
+#include "affinity.hpp"
+#include "methods.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Lifecycle of a submitted job.
+enum class JobStatus {
+    Pending,            ///< Queued, no chunk started yet
+    Running,            ///< At least one chunk started
+    Completed,          ///< Every trial ran
+    Cancelled,          ///< Stopped by `JobHandle::cancel()` (or scheduler shutdown)
+    DeadlineExceeded,   ///< Stopped at its deadline
+    Failed,             ///< Rejected at submission or a kernel threw
+};
+
+/**
+ * @brief Name of a job status for logs.
+ * @param status Job status
+ * @return Lower-case label
+ */
+inline const char* jobStatusName(JobStatus status) {
+    switch (status) {
+    case JobStatus::Pending: return "pending";
+    case JobStatus::Running: return "running";
+    case JobStatus::Completed: return "completed";
+    case JobStatus::Cancelled: return "cancelled";
+    case JobStatus::DeadlineExceeded: return "deadline exceeded";
+    case JobStatus::Failed: return "failed";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Parameters of one job.
+ */
+struct JobRequest {
+    std::string method;                                  ///< Registered `Pool` method name
+    std::int64_t trials = 0;                             ///< Trial budget
+    std::chrono::milliseconds deadline{0};               ///< Time limit from submission (0 = none)
+    std::int64_t chunkTrials = kDefaultChunkTrials;      ///< Trials per chunk (granularity of interleaving)
+};
+
+/**
+ * @brief Final state of a job.
+ */
+struct JobResult {
+    JobStatus status = JobStatus::Pending;   ///< Completed, Cancelled, DeadlineExceeded or Failed
+    std::string error;                       ///< Why the job failed (empty otherwise)
+    std::int64_t trials = 0;                 ///< Trials actually run
+    std::int64_t hits = 0;                   ///< Hits among them
+    double estimate = 0.0;                   ///< π estimate over `trials` (0 if none ran)
+    long long elapsedNs = 0;                 ///< Submission to resolution
+};
+
+/**
+ * @brief Progress of a running job.
+ */
+struct JobProgress {
+    std::int64_t trials = 0;        ///< Trials finished so far
+    std::int64_t hits = 0;          ///< Hits among them
+    std::int64_t totalTrials = 0;   ///< Trial budget
+
+    /**
+     * @brief Fraction of the budget finished.
+     * @return Value in [0, 1]
+     */
+    double fraction() const {
+        return totalTrials > 0 ? static_cast<double>(trials) / static_cast<double>(totalTrials) : 1.0;
+    }
+};
+
+/**
+ * @brief Shared state of one job, owned by its handle and the scheduler queue.
+ *
+ * Chunk bookkeeping is guarded by the scheduler mutex; progress counters and the cancel flag are
+ * atomics so handles can read and set them without it.
+ */
+struct JobState {
+    JobRequest request;                          ///< Parameters as submitted
+    ThreadPool::ChunkKernel kernel;              ///< Built from the method for the scheduler's size
+    std::function<void(const JobResult&)> onComplete;   ///< Optional resolution callback
+    std::chrono::steady_clock::time_point submitted;    ///< Submission time
+    std::int64_t chunkCount = 0;                 ///< Chunks in the budget
+
+    std::int64_t nextChunk = 0;                  ///< Next unclaimed chunk (scheduler mutex)
+    unsigned inFlight = 0;                       ///< Chunks running now (scheduler mutex)
+    bool closed = false;                         ///< No further chunks will be claimed (scheduler mutex)
+    JobStatus stopReason = JobStatus::Completed; ///< Why claiming stopped early (scheduler mutex)
+    std::string error;                           ///< First kernel error (scheduler mutex)
+
+    std::atomic<JobStatus> status{JobStatus::Pending};   ///< Current status
+    std::atomic<bool> cancelRequested{false};    ///< Set by `JobHandle::cancel()`
+    std::atomic<std::int64_t> trialsDone{0};     ///< Finished trials
+    std::atomic<std::int64_t> hits{0};           ///< Hits of finished trials
+
+    std::promise<JobResult> promise;             ///< Fulfilled once
+    std::shared_future<JobResult> future;        ///< Shared by every handle copy
+
+    /**
+     * @brief Resolves the job: publishes the status, fulfils the future, runs the callback.
+     *
+     * Called exactly once, without the scheduler mutex held.
+     *
+     * @param finalStatus Terminal status
+     * @param message     Error text for `Failed`
+     */
+    void resolve(JobStatus finalStatus, std::string message) {
+        JobResult result;
+        result.status = finalStatus;
+        result.error = std::move(message);
+        result.trials = trialsDone.load();
+        result.hits = hits.load();
+        result.estimate = result.trials > 0 ? 4.0 * static_cast<double>(result.hits) / static_cast<double>(result.trials)
+                                            : 0.0;
+        result.elapsedNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - submitted).count();
+
+        status.store(finalStatus);
+        promise.set_value(result);
+        if (onComplete) onComplete(result);
+    }
+};
+
+/**
+ * @brief Caller's view of a submitted job; cheap to copy.
+ */
+class JobHandle {
+public:
+    /**
+     * @brief Wrap a job's shared state.
+     * @param state State created by `JobScheduler::submit()`
+     */
+    explicit JobHandle(std::shared_ptr<JobState> state) : state(std::move(state)) {}
+
+    /**
+     * @brief Future of the final result.
+     * @return Shared future, ready once the job resolves
+     */
+    const std::shared_future<JobResult>& result() const {
+        return state->future;
+    }
+
+    /**
+     * @brief Blocks until the job resolves.
+     * @return Final result
+     */
+    JobResult wait() const {
+        return state->future.get();
+    }
+
+    /**
+     * @brief Current status.
+     * @return Status (terminal once the future is ready)
+     */
+    JobStatus status() const {
+        return state->status.load();
+    }
+
+    /**
+     * @brief Trials finished so far.
+     * @return Progress snapshot
+     */
+    JobProgress progress() const {
+        return {state->trialsDone.load(), state->hits.load(), state->request.trials};
+    }
+
+    /**
+     * @brief Asks the job to stop; chunks already running finish and count.
+     *
+     * The future resolves as `Cancelled` unless every chunk had already been claimed.
+     */
+    void cancel() const {
+        state->cancelRequested.store(true);
+    }
+
+private:
+    std::shared_ptr<JobState> state;   ///< Shared with the scheduler
+};
+
+/**
+ * @brief Fixed set of workers that interleave the chunks of many concurrent jobs.
+ */
+class JobScheduler {
+public:
+    /// Called once per job, on the worker that resolves it (or on the submitting thread if rejected); must not throw.
+    using CompletionCallback = std::function<void(const JobResult&)>;
+
+    /**
+     * @brief Start a fixed number of worker threads, optionally pinned to CPUs.
+     * @param workerCount Number of workers (at least 1)
+     * @param cpus        CPU per worker, reused cyclically; empty leaves workers unpinned
+     */
+    explicit JobScheduler(unsigned workerCount, std::vector<int> cpus = {}) : cpuList(std::move(cpus)) {
+        workerCount = std::max(1u, workerCount);
+        workers.reserve(workerCount);
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    /**
+     * @brief Cancel every queued job, let running chunks finish, and join the workers.
+     */
+    ~JobScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (const std::shared_ptr<JobState>& job : ready) job->cancelRequested.store(true);
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    /**
+     * @brief Number of worker threads.
+     * @return Worker count
+     */
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    /**
+     * @brief Queues a job and returns without waiting for it.
+     * @param request    Method, trial budget, deadline and chunk size
+     * @param onComplete Optional callback with the final result
+     * @return Handle to the job; already `Failed` if the request was rejected
+     */
+    JobHandle submit(const JobRequest& request, CompletionCallback onComplete = {}) {
+        auto job = std::make_shared<JobState>();
+        job->request = request;
+        job->request.chunkTrials = std::max<std::int64_t>(1, request.chunkTrials);
+        job->onComplete = std::move(onComplete);
+        job->submitted = std::chrono::steady_clock::now();
+        job->future = job->promise.get_future().share();
+
+        std::string rejected = validate(request);
+        if (!rejected.empty()) {
+            job->resolve(JobStatus::Failed, rejected);
+            return JobHandle(job);
+        }
+
+        job->kernel = findMethod(request.method)->makeKernel(size());
+        job->chunkCount = (request.trials + job->request.chunkTrials - 1) / job->request.chunkTrials;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(job);
+        }
+        wake.notify_one();
+        return JobHandle(job);
+    }
+
+private:
+    /**
+     * @brief Checks a request against the registry.
+     * @param request Job parameters
+     * @return Rejection reason, or empty if the job can run
+     */
+    static std::string validate(const JobRequest& request) {
+        const MethodInfo* method = findMethod(request.method);
+        if (!method) return "Unknown method: " + request.method;
+        if (!methodAvailable(*method)) return request.method + " is unavailable: " + gpuDevice().status;
+        if (method->threading != MethodThreading::Pool) {
+            return request.method + " runs on the calling thread; submit a threaded method";
+        }
+        if (request.trials <= 0) return "Invalid trial count: " + std::to_string(request.trials);
+        return {};
+    }
+
+    /**
+     * @brief Why a job must stop claiming chunks before its budget is done.
+     * @param job Job at the front of the queue (scheduler mutex held)
+     * @param now Current time
+     * @return `Running` if it may continue, otherwise the terminal status to report
+     */
+    static JobStatus stopStatus(const JobState& job, std::chrono::steady_clock::time_point now) {
+        if (!job.error.empty()) return JobStatus::Failed;
+        if (job.cancelRequested.load()) return JobStatus::Cancelled;
+        if (job.request.deadline.count() > 0 && now - job.submitted >= job.request.deadline) {
+            return JobStatus::DeadlineExceeded;
+        }
+        return JobStatus::Running;
+    }
+
+    /**
+     * @brief Terminal status of a closed job whose chunks have all finished.
+     * @param job Job (scheduler mutex held)
+     * @return Completed if the whole budget ran, else the reason claiming stopped
+     */
+    static JobStatus finalStatus(const JobState& job) {
+        if (!job.error.empty()) return JobStatus::Failed;
+        return job.trialsDone.load() == job.request.trials ? JobStatus::Completed : job.stopReason;
+    }
+
+    /**
+     * @brief Worker main loop: take the front job, run one of its chunks, requeue it.
+     * @param self Worker index (`ThreadPool::currentWorker()` inside kernels)
+     */
+    void workerLoop(unsigned self) {
+        ThreadPool::workerIndexSlot() = self;
+        TraceLog::nameCurrentThread("job worker " + std::to_string(self));
+        if (!cpuList.empty()) pinCurrentThread(cpuList[self % cpuList.size()]);
+
+        for (;;) {
+            std::shared_ptr<JobState> job;
+            std::shared_ptr<JobState> finished;
+            std::int64_t chunk = -1;
+            bool more = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !ready.empty(); });
+                if (ready.empty()) return;
+
+                job = std::move(ready.front());
+                ready.pop_front();
+                JobStatus stop = stopStatus(*job, std::chrono::steady_clock::now());
+                if (stop == JobStatus::Running) {
+                    chunk = job->nextChunk++;
+                    ++job->inFlight;
+                    if (job->nextChunk < job->chunkCount) {
+                        ready.push_back(job);
+                    } else {
+                        job->closed = true;
+                    }
+                } else {
+                    job->closed = true;
+                    job->stopReason = stop;
+                    if (job->inFlight == 0) finished = job;
+                }
+                more = !ready.empty();
+            }
+            // Hand the rest of the queue to an idle worker before running this chunk
+            if (more) wake.notify_one();
+
+            if (finished) {
+                finished->resolve(finalStatus(*finished), finished->error);
+                continue;
+            }
+
+            // Same chunk → stream mapping as ThreadPool::runUntil (see philox.hpp)
+            job->status.store(JobStatus::Running);
+            RunSeed::currentChunk() = static_cast<std::uint64_t>(chunk);
+            std::int64_t begin = chunk * job->request.chunkTrials;
+            std::int64_t trials = std::min(job->request.chunkTrials, job->request.trials - begin);
+            std::string error;
+            try {
+                MC_TRACE_SCOPE_ARG("chunk", trials);
+                std::int64_t hits = job->kernel(trials);
+                job->hits.fetch_add(hits);
+                job->trialsDone.fetch_add(trials);
+            } catch (const std::exception& e) {
+                error = e.what();
+            } catch (...) {
+                error = "unknown error in chunk kernel";
+            }
+
+            bool resolve = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error.empty() && job->error.empty()) job->error = error;
+                --job->inFlight;
+                resolve = job->closed && job->inFlight == 0;
+            }
+            // Still-queued jobs (even failed ones) resolve when a worker drops them from the queue
+            if (resolve) job->resolve(finalStatus(*job), job->error);
+        }
+    }
+
+    std::vector<std::thread> workers;              ///< Persistent worker threads
+    std::vector<int> cpuList;                      ///< CPU per worker (empty = unpinned)
+
+    std::mutex mutex;                              ///< Guards the queue and every job's chunk bookkeeping
+    std::condition_variable wake;                  ///< Signals queued work (or shutdown) to workers
+    std::deque<std::shared_ptr<JobState>> ready;   ///< Jobs with chunks left, in round-robin order
+    bool stopping = false;                         ///< Set on destruction
+};
@@ -13,63 +13,572 @@
  * ./montecarlo                     # Run all methods (default trials = 100M)
  * ./montecarlo 5000000            # Run all methods with 5M trials
  * ./montecarlo 1e7 SIMD           # Run only SIMD with 10M trials
+ * ./montecarlo 1e11 SIMDXoshiro   # 64-bit trial counts: 100 billion trials
+ * ./montecarlo 1e7 SIMD --kernel avx2   # Force the AVX2 kernel on an AVX-512 machine
+ * ./montecarlo 1e8 Pool --threads 64 --pin scatter   # 64 workers spread across NUMA nodes
+ * ./montecarlo 1e8 SIMD --sweep strong --threads 32  # Scaling report for 1, 2, 4, ..., 32 threads
+ * ./montecarlo 1e11 SIMDXoshiro --epsilon 1e-5 --deadline-ms 2000   # Stop at ±1e-5 or after 2 s
+ * ./montecarlo 1e8 All --seed 42 --threads 8   # Same hits for every method regardless of --threads
+ * ./montecarlo 1e8 SIMDXoshiro,SIMDBuffered   # Several methods side by side in one process
+ * ./montecarlo --list                          # Registered methods, threading model and ISAs
+ * ./montecarlo 1e8 SIMDXoshiro --counters       # Hardware counters of the timed region only
+ * ./montecarlo 1e8 Pool --warmup 2 --reps 21     # Median / p90 / p99 over 21 warm repetitions
+ * ./montecarlo 1e8 All --counters --arrow-out results.arrows   # Rows for the perf pipeline
+ * ./montecarlo 1e8 SIMDXoshiro,Stratified,Sobol --convergence --target-error 1e-6   # Error vs trials / time
+ * ./montecarlo 1e11 SIMDXoshiro --coordinator 7070 --nodes 4   # Split the run over 4 worker nodes
+ * ./montecarlo --worker host-a:7070 --threads 64                 # One of those workers
+ * ./montecarlo 1e9 --count-stage --reps 5      # Compare/count kernels alone on pre-generated darts
+ * ./montecarlo 1e8 --integrate                  # 5-ball volume and E[|U|^2] against their closed forms
+ * ./montecarlo --autotune                       # Time every SIMD instantiation, cache the fastest for this CPU
+ * ./montecarlo 1e6 SIMDXoshiro --jobs 256 --deadline-ms 50   # 256 concurrent async jobs, latency p50/p99
+ * ./montecarlo 1e8 SIMDBuffered --trace trace.json   # Per-thread timeline (build with -DMC_ENABLE_TRACE=ON)
+ * ./montecarlo --spec sweep.json --counters --arrow-out results.arrows   # Whole matrix in one process
  * ```
  *
  * ## CLI Arguments
- * - `argv[1]` — Number of simulation trials (optional, default: 100_000_000)
- * - `argv[2]` — Method name: `Sequential`, `Heap`, `Pool`, `SIMD`, or `All` (optional, default: All)
+ * - `argv[1]` — Number of simulation trials, integer or scientific notation (optional, default: 100_000_000)
+ * - `argv[2]` — A registered method name (see `--list`), a comma-separated list of names run in that
+ *              order, or `All` for every method in registry order (optional, default: All)
+ *
+ * ## CLI Options
+ * Unknown `--` options, options missing their value and a third positional argument are errors.
+ * - `--kernel NAME` — Force a SIMD backend: `avx512`, `avx2`, `neon`, or `scalar` (default: fastest supported)
+ * - `--threads N`   — Worker threads for threaded methods (default: `std::thread::hardware_concurrency()`)
+ * - `--pin POLICY`  — Pin workers: `compact`, `scatter`, or a CPU list like `0-3,8` (default: unpinned)
+ * - `--sweep MODE`  — Thread-scaling sweep up to `--threads`: `strong` (argv[1] = total trials) or
+ *                     `weak` (argv[1] = trials per thread); `All` sweeps every threaded method
+ * - `--epsilon E`   — Stop threaded methods once the 95% CI half-width of π̂ is ≤ E; argv[1] becomes
+ *                     the trial budget (see `estimator.hpp`)
+ * - `--deadline-ms MS` — Stop threaded methods after MS milliseconds of wall time
+ * - `--buffer N`    — Trials per SoA buffer for `SIMDBuffered` (default: 2048, rounded up to a multiple of 64)
+ * - `--seed S`      — Reproducible run: each chunk draws from its own Philox stream keyed by (S, chunk),
+ *                     so hit counts are identical for any `--threads` / `--pin` (see `philox.hpp`)
+ * - `--warmup N`    — Untimed calls per method before measuring (default: 0)
+ * - `--reps N`      — Timed repetitions per method; prints min / median / p90 / p99 / MAD and reports
+ *                     the median repetition (default: 1; early-stop runs always run once)
+ * - `--counters`    — Count cycles, instructions, cache/L1/dTLB/branch events around each timed run
+ *                     with `perf_event_open` and print a `[PERF]` record per result (see `perfcounters.hpp`)
+ * - `--arrow-out PATH` — Append one row per timed repetition (pipeline `SCHEMA` columns) to an Arrow
+ *                     IPC stream file, one record batch per process (see `arrowlog.hpp`)
+ * - `--batch-id ID` — `BatchID` column of those rows (default: random 8 hex digits)
+ * - `--convergence` — For each method, measure the RMSE of π̂ over `--reps` repetitions (10 if not
+ *                     given) at 4096, 16384, ... trials up to argv[1], with median time and fitted order
+ * - `--target-error E` — With `--convergence`: estimate trials and time each method needs for RMSE E
+ * - `--coordinator PORT` — Distributed run: wait for `--nodes N` workers on PORT, split each threaded
+ *                     method's chunks over them and reduce their hits (see `distributed.hpp`)
+ * - `--nodes N`     — Workers the coordinator waits for
+ * - `--worker HOST:PORT` — Serve a coordinator with this process's `--threads` / `--pin` / `--kernel`
+ *                     pool until it finishes; positional arguments are ignored
+ * - `--count-stage` — Time only the hit-count kernels (movemask vs vector-accumulated AVX2) on one
+ *                     pre-generated `--buffer` of darts, argv[1] darts each (see `countstage.hpp`)
+ * - `--integrate`   — Estimate the `integrate.hpp` checks (5-ball volume, E[|U|²] in 3-D) with argv[1]
+ *                     darts each on the pool and fail if one misses its closed form by > 5 standard errors
+ * - `--autotune`    — Time every (unroll, buffer) instantiation of the `SIMD` kernel on the active backend,
+ *                     store the fastest for this CPU model in the tuning cache and exit (see `autotune.hpp`)
+ * - `--tune-cache PATH` — Tuning cache read at startup and written by `--autotune`
+ *                     (default: `montecarlo_tuning.tsv`; `none` disables it)
+ * - `--jobs N`      — Submit N concurrent asynchronous jobs of argv[1] trials per threaded method to a
+ *                     `JobScheduler` with `--threads` workers and report job latency percentiles and
+ *                     throughput; `--deadline-ms` becomes the per-job deadline (see `jobs.hpp`)
+ * - `--trace PATH`  — Record pool, chunk, RNG-fill, count and reduction spans per thread and write them as
+ *                     Chrome trace JSON at exit; rows gain the load-balance columns. Needs a build with
+ *                     `-DMC_ENABLE_TRACE=ON` (see `trace.hpp`)
+ * - `--spec PATH`   — Run the JSON matrix of methods × `trials` × `threads` × `kernels` in this process,
+ *                     one persistent pool per thread count, and print a summary table; replaces the
+ *                     positional arguments (see `sweepspec.hpp`)
+ * - `--list[=FORMAT]` — Print the method registry and exit: a table by default, or one name per line
+ *                     with `names` (every method) or `threaded` (pool methods only)
  *
  * ## Methods
+ * Methods are registered in `methods.hpp`; `--list` prints the current table.
  * - Sequential:     Single-threaded naive implementation
+ * - SequentialThreaded: Sequential's scalar loop chunked on the pool — the threaded baseline
  * - Heap (Threaded): Threaded heap allocation per thread
  * - Pool (Threaded): Threaded use of a bump allocator (fast reuse, aligned)
  * - SIMD (Threaded): Threaded SIMD-enhanced Monte Carlo with vectorization
+ * - SIMDXoshiro (Threaded): SIMD kernel fed by an in-register xoshiro256+ PRNG
+ * - SIMDF32 (Threaded): float32 variant of SIMDXoshiro with twice the lanes
+ * - SIMDF32Guard (Threaded): SIMDF32 with double-precision re-check of borderline samples
+ * - SIMDBuffered (Threaded): two-stage pipeline — fill SoA x/y buffers, then count them unrolled
+ * - Stratified (Threaded): jittered grid, one dart per cell (see `sampling.hpp`)
+ * - LatinHypercube (Threaded): one dart per row and column band of each buffer
+ * - Sobol (Threaded): digitally shifted 2-D Sobol sequence
+ * - Halton (Threaded): rotated 2-D Halton sequence, bases 2 and 3
+ * - PackedSlots (Threaded): writes every trial to per-worker counters packed 8 per cache line
+ * - PaddedSlots (Threaded): same, with each counter on its own cache line (see `falsesharing.hpp`)
+ * - GPU:            Philox darts on the CUDA device, one 64-bit count back (CUDA builds, see `gpu.hpp`)
+ * - Hybrid:         splits each run between the GPU and SIMDXoshiro workers by measured throughput
  *
  * ## Output
  * Each benchmark logs:
  * - Estimated π value
  * - Runtime in seconds and nanoseconds
  * - Total hits (inside circle) used to compute the estimate
+ * - Absolute error of the estimate against π
+ * - For float32 methods run alongside SIMDXoshiro: speedup and accuracy delta vs float64
+ * - For PaddedSlots run alongside PackedSlots: the false-sharing penalty
+ * - For SIMDBuffered: share of CPU time spent in the generate and count stages
+ * - For Hybrid: the GPU/CPU split of the last run and both measured rates
+ * - In sweep mode: time, trials/s, speedup and parallel efficiency per thread count
+ * - With `--epsilon` / `--deadline-ms`: trials actually run, CI half-width and why the run stopped
+ * - With `--reps`: the median repetition, then the wall-time distribution and outlier count
+ * - With `--convergence`: RMSE, time, RMSE·√N and efficiency per trial count, the fitted order and,
+ *   with `--target-error`, the estimated cost of that precision and the cheapest method
+ * - With `--counters`: IPC, cycles per trial and one `[PERF]` line per repetition in
+ *   `gen_perf_parquet_logs.py` argument format
+ * - With `--integrate`: each integral's estimate ± standard error, closed form, z-score and darts/s
+ * - With `--jobs`: job statuses, latency median / p90 / p99, trials/s and jobs/s, and the pooled estimate
+ * - With `--spec`: every point's block, then one summary line per point (kernel, threads, method,
+ *   trials, time, trials/s, error) and the wall time of the whole matrix
+ * - With `--coordinator`: the reduced cluster result, then each node's trials, time and
+ *   throughput and the reduction overhead (coordinator time beyond the slowest node)
  *
  * ## Notes
- * - Uses fixed thread count (4) for parallel methods
- * - AVX2/NEON support is detected at runtime and reported
- * - Each threaded method aggregates results manually
+ * - Parallel methods share a persistent `ThreadPool` created once with `--threads` workers
+ * - With `--pin`, workers are pinned before their thread-local pools are first touched, so
+ *   pool memory is NUMA-local (see `affinity.hpp`)
+ * - Threaded methods split trials into chunks (remainder included) with work stealing
+ * - SIMD kernels are selected at runtime via CPUID/HWCAP (see `dispatch.hpp`); the selected
+ *   kernel is reported in the `[INFO] SIMD:` line
+ * - Kernel errors (e.g. `PoolExhausted`) are exceptions; the CLI prints them as `[ERROR]` and exits non-zero
  */
 
-#include "montecarlo.hpp"
-#include "benchmark.hpp"
+#include "methods.hpp"
+#include "affinity.hpp"
+#include "arrowlog.hpp"
+#include "autotune.hpp"
+#include "cli.hpp"
+#include "countstage.hpp"
+#include "distributed.hpp"
+#include "estimator.hpp"
+#include "integrate.hpp"
+#include "jobs.hpp"
+#include "sweepspec.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
 #include <iostream>
-#include <random>
+#include <limits>
+#include <string>
 #include <thread>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/utsname.h>
+#endif
+
 /**
- * @brief Prints detected platform architecture and SIMD capability.
+ * @brief Prints detected platform architecture, the selected SIMD kernel and the build.
  *
- * Detects and logs support for AVX2 (x86) or NEON (ARM) at runtime.
- * Helps validate compatibility for SIMD-accelerated paths.
+ * The `[INFO] SIMD:` line reports the backend actually bound by `dispatch.hpp`,
+ * not just what the compiler was told to target. The `[INFO] Build:` line gives the
+ * compiler and git revision that `--arrow-out` rows record (`runinfo.hpp`).
  */
 void print_arch_info() {
     std::cout << "[INFO] Detected platform: ";
-    system("uname -m");
-
-#if defined(__AVX2__)
-    std::cout << "[INFO] SIMD: AVX2 enabled\n";
-#elif defined(__ARM_NEON)
-    std::cout << "[INFO] SIMD: NEON enabled\n";
+#if defined(__unix__) || defined(__APPLE__)
+    utsname info{};
+    if (uname(&info) == 0) std::cout << info.machine << "\n";
+    else std::cout << "unknown\n";
 #else
-    std::cout << "[WARN] No SIMD support detected\n";
+    std::cout << "unknown\n";
 #endif
+
+    const SimdBackend& backend = activeSimdBackend();
+    if (backend.lanes > 1) {
+        std::cout << "[INFO] SIMD: " << backend.name << " (" << backend.lanes << " x f64 lanes)\n";
+    } else {
+        std::cout << "[WARN] SIMD: scalar fallback, no vector kernel selected\n";
+    }
+    printCpuFrequencyInfo();
+
+    std::string revision = MC_GIT_REVISION;
+    std::cout << "[INFO] Build: " << compilerVersion() << ", revision " << (revision.empty() ? "unknown" : revision)
+              << "\n";
 }
 
 /**
- * @brief Entry point for running Monte Carlo simulations via CLI.
+ * @brief Prints the worker count and CPU placement of the thread pool.
+ * @param pool   Constructed thread pool
+ * @param policy `--pin` policy (empty if unpinned)
+ * @param cpus   Resolved CPU list
+ */
+void print_thread_info(const ThreadPool& pool, const std::string& policy, const std::vector<int>& cpus) {
+    std::cout << "[INFO] Threads: " << pool.size();
+    if (policy.empty()) {
+        std::cout << " (unpinned)\n";
+        return;
+    }
+
+    std::cout << " (pin " << policy << ":";
+    for (unsigned i = 0; i < pool.size() && i < 16; ++i) std::cout << " " << cpus[i % cpus.size()];
+    if (pool.size() > 16) std::cout << " ...";
+    std::cout << ")\n";
+
+    if (pool.pinnedCount() < pool.size()) {
+        std::cout << "[WARN] Only " << pool.pinnedCount() << " of " << pool.size()
+                  << " workers could be pinned\n";
+    }
+    if (pool.size() > cpus.size()) {
+        std::cout << "[WARN] More threads than pinned CPUs; workers share cores\n";
+    }
+}
+
+/**
+ * @brief Runs a threaded method under early-stop criteria and prints it like `benchmark()`.
+ * @param name        Benchmark label
+ * @param pool        Worker pool
+ * @param kernel      Chunk kernel of the method
+ * @param totalTrials Trial budget
+ * @param criteria    Precision target and/or deadline
+ * @return Timing and accuracy over the trials actually run
+ */
+BenchmarkResult benchmark_streaming(const std::string& name, ThreadPool& pool, const ThreadPool::ChunkKernel& kernel,
+                                    std::int64_t totalTrials, const StopCriteria& criteria) {
+    PerfRegion region;
+    TraceRegion trace;
+    StreamingResult streamed = runStreaming(pool, kernel, totalTrials, kDefaultChunkTrials, criteria);
+    TraceBalance balance = trace.stop();
+    PerfSample counters = region.stop();
+    const EstimatorSnapshot& view = streamed.estimate;
+
+    BenchmarkResult result{name, view.trials, view.hits, view.estimate, std::fabs(view.estimate - kPi), streamed.elapsedNs,
+                           counters, balance};
+    printBenchmarkResult(result);
+    printBenchmarkRecords({result});
+    std::cout << "  CI half-width: " << view.halfWidth(criteria.z) << " (std error " << view.stdError << ")\n"
+              << "  Stopped: " << stopReasonName(streamed.reason) << " (" << view.trials << " of " << totalTrials
+              << " trials)\n";
+    return result;
+}
+
+/**
+ * @brief Runs strong- or weak-scaling sweeps and prints one report per method.
+ * @param methods    Threaded methods to sweep
+ * @param mode       Sweep mode
+ * @param trials     Total trials (strong) or trials per thread (weak)
+ * @param maxThreads Largest thread count
+ * @param cpus       Pinning CPU list (empty = unpinned)
+ */
+void run_scaling_sweeps(const std::vector<const MethodInfo*>& methods, ScalingMode mode, std::int64_t trials,
+                        unsigned maxThreads, const std::vector<int>& cpus) {
+    for (const MethodInfo* method : methods) {
+        ThreadPool::ChunkKernel kernel = method->makeKernel(maxThreads);
+
+        auto points = scalingSweep(mode, trials, sweepThreadCounts(maxThreads), [&](unsigned threads, std::int64_t pointTrials) {
+            ThreadPool sweepPool(threads, cpus);
+            RepeatedResult repeated = measureRepeated(method->name, pointTrials, [&]() {
+                return sweepPool.run(pointTrials, kDefaultChunkTrials, kernel);
+            });
+            ResultLog::global().add(method->name, threads, repeated.runs);
+            return repeated.median;
+        });
+
+        printScalingReport(method->label(), mode, trials, points);
+    }
+}
+
+/**
+ * @brief One point of a `--spec` matrix.
+ */
+struct SpecPoint {
+    std::string kernel;         ///< SIMD backend (`-` for methods that do not use one)
+    unsigned threads;           ///< Worker threads (1 for single-threaded methods)
+    std::string method;         ///< Method name
+    BenchmarkResult result;     ///< Median repetition
+};
+
+/**
+ * @brief Prints one line per `--spec` point.
+ * @param points  Points in run order
+ * @param seconds Wall time of the whole matrix
+ */
+void print_spec_summary(const std::vector<SpecPoint>& points, double seconds) {
+    std::cout << "Sweep summary (" << points.size() << " points, median repetition each):\n"
+              << "  Kernel    Threads  Method                       Trials      Time (s)      Trials/s     Error\n";
+    for (const SpecPoint& point : points) {
+        const BenchmarkResult& result = point.result;
+        double throughput = result.elapsedNs > 0 ? static_cast<double>(result.trials) * 1e9 / result.elapsedNs : 0.0;
+        std::cout << "  " << std::left << std::setw(8) << point.kernel << std::right << std::setw(9) << point.threads
+                  << "  " << std::left << std::setw(20) << point.method << std::right << std::setw(15) << result.trials
+                  << std::fixed << std::setprecision(6) << std::setw(14) << result.elapsedNs / 1e9
+                  << std::scientific << std::setprecision(3) << std::setw(14) << throughput
+                  << std::setprecision(2) << std::setw(10) << result.absError << "\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    std::cout << "[INFO] Sweep spec finished in " << seconds << " s\n";
+}
+
+/**
+ * @brief Runs every point of a `--spec` matrix, reusing one pool per thread count.
  *
- * Parses CLI arguments and dispatches benchmark runs using one of the
- * available simulation methods: Sequential, Heap, Pool, SIMD, or All.
+ * Kernels only multiply `MethodIsa::SimdBackend` methods, and single-threaded methods run at
+ * the first thread count only (see `sweepspec.hpp`).
+ *
+ * @param spec      Matrix with `threads` and `kernels` filled in (kernels already checked to be supported)
+ * @param methods   Methods of the spec, in run order
+ * @param cpus      Pinning CPU list (empty = unpinned)
+ * @param pin       `--pin` policy (empty if unpinned)
+ * @param tuneCache Tuning cache re-read after each kernel switch (`none` = off)
+ */
+void run_sweep_spec(const SweepSpec& spec, const std::vector<const MethodInfo*>& methods, const std::vector<int>& cpus,
+                    const std::string& pin, const std::string& tuneCache) {
+    const std::vector<unsigned>& threadCounts = spec.threads;
+    const std::vector<std::string>& kernels = spec.kernels;
+    auto started = std::chrono::steady_clock::now();
+    std::vector<SpecPoint> points;
+
+    for (std::size_t t = 0; t < threadCounts.size(); ++t) {
+        ThreadPool pool(threadCounts[t], cpus);
+        print_thread_info(pool, pin, cpus);
+
+        for (std::size_t k = 0; k < kernels.size(); ++k) {
+            // Binding a backend resets its SIMD variant, so the tuning is looked up again
+            if (kernels.size() > 1) {
+                selectSimdBackend(kernels[k]);
+                if (tuneCache != "none") applyTuningCache(tuneCache);
+                std::cout << "[INFO] SIMD: " << kernels[k] << "\n";
+            }
+            ResultLog::global().setSimdKernel(activeSimdKernelName());
+
+            for (const MethodInfo* entry : methods) {
+                bool single = entry->threading == MethodThreading::Single;
+                bool simd = entry->isa == MethodIsa::SimdBackend;
+                if ((single && t > 0) || (!simd && k > 0)) continue;
+                if (entry->prepare) entry->prepare();
+
+                ThreadPool::ChunkKernel chunkKernel = entry->makeKernel(pool.size());
+                unsigned threads = single ? 1 : pool.size();
+                for (std::int64_t trials : spec.trials) {
+                    std::int64_t pointTrials = spec.weak && !single ? trials * threads : trials;
+                    RepeatedResult repeated = benchmarkRepeated(entry->label(), pointTrials, [&]() {
+                        return single ? chunkKernel(pointTrials) : pool.run(pointTrials, kDefaultChunkTrials, chunkKernel);
+                    });
+                    ResultLog::global().add(entry->name, threads, repeated.runs);
+                    points.push_back({simd ? kernels[k] : "-", threads, entry->name, repeated.median});
+                }
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    print_spec_summary(points, seconds);
+}
+
+/**
+ * @brief Runs a convergence sweep per method and ranks them by time to a target error.
+ * @param methods     Methods to measure
+ * @param pool        Worker pool for threaded methods
+ * @param maxTrials   Largest trial count
+ * @param targetError RMSE target (0 = no ranking)
+ */
+void run_convergence_sweeps(const std::vector<const MethodInfo*>& methods, ThreadPool& pool, std::int64_t maxTrials,
+                            double targetError) {
+    std::vector<std::pair<double, std::string>> costs;
+
+    for (const MethodInfo* method : methods) {
+        if (method->prepare) method->prepare();
+        ThreadPool::ChunkKernel kernel = method->makeKernel(pool.size());
+        unsigned threads = method->threading == MethodThreading::Pool ? pool.size() : 1;
+
+        auto points = convergenceSweep(convergenceTrialCounts(maxTrials), [&](std::int64_t trials) {
+            RepeatedResult repeated = measureRepeated(method->name, trials, [&]() {
+                return method->threading == MethodThreading::Pool ? pool.run(trials, kDefaultChunkTrials, kernel)
+                                                                  : kernel(trials);
+            });
+            ResultLog::global().add(method->name, threads, repeated.runs);
+            return repeated;
+        });
+
+        ConvergenceFit fit = fitConvergence(points);
+        printConvergenceReport(method->label(), points, fit, targetError);
+        if (targetError > 0.0 && fit.valid) {
+            costs.emplace_back(trialsForError(fit, targetError) * fit.nsPerTrial / 1e9, method->label());
+        }
+    }
+
+    if (costs.empty()) return;
+    std::sort(costs.begin(), costs.end());
+    std::cout << "[INFO] Cheapest to RMSE " << targetError << ":";
+    for (std::size_t i = 0; i < costs.size(); ++i) {
+        std::cout << (i == 0 ? " " : ", ") << costs[i].second << " (~" << costs[i].first << " s)";
+    }
+    std::cout << "\n";
+}
+
+/**
+ * @brief Runs each method across the cluster and prints the reduced and per-node results.
+ * @param methods     Threaded methods to run
+ * @param cluster     Coordinator with every worker connected
+ * @param totalTrials Trials per run, split over the nodes
+ * @return false if a worker failed or disconnected
+ */
+bool run_distributed(const std::vector<const MethodInfo*>& methods, ClusterCoordinator& cluster, std::int64_t totalTrials) {
+    const std::vector<ClusterNode>& nodes = cluster.workers();
+    const int nodeCount = static_cast<int>(nodes.size());
+
+    for (const MethodInfo* method : methods) {
+        std::vector<ClusterRun> calls;
+        bool failed = false;
+        RepeatedResult repeated = measureRepeated(method->label(), totalTrials, [&]() {
+            ClusterRun run;
+            if (failed || !cluster.run(method->name, totalTrials, run)) {
+                failed = true;
+                return std::int64_t{0};
+            }
+            calls.push_back(run);
+            return run.hits;
+        });
+        if (failed) return false;
+
+        // Warmup calls were reduced too; keep the timed repetitions, aligned with repeated.runs
+        calls.erase(calls.begin(), calls.begin() + RepeatConfig::global().warmup);
+
+        printBenchmarkResult(repeated.median);
+        if (repeated.stats.repetitions > 1) printRunStatistics(repeated.stats);
+
+        const ClusterRun& shown = calls[repeated.medianIndex];
+        for (int i = 0; i < nodeCount; ++i) {
+            const NodeRun& node = shown.nodes[i];
+            std::cout << "  Node " << nodes[i].name << " (" << nodes[i].threads << " threads): " << node.trials
+                      << " trials in " << node.elapsedNs / 1e9 << "s ("
+                      << static_cast<double>(node.trials) / std::max(1.0, static_cast<double>(node.elapsedNs)) * 1e3
+                      << " M trials/s)\n";
+        }
+        std::cout << "  Reduction overhead: " << shown.reductionNs / 1e9 << "s (" << shown.reductionNs << " ns)\n";
+
+        // Node rows describe their worker; the cluster row keeps what all workers share
+        std::vector<RunInfo> infos;
+        for (const ClusterNode& node : nodes) infos.push_back(node.info);
+        RunInfo clusterInfo = commonRunInfo(infos);
+        ResultNode reduced{"cluster", nodeCount, {}};
+        for (const ClusterRun& call : calls) reduced.overheadNs.push_back(call.reductionNs);
+        ResultLog::global().add(method->name, cluster.totalThreads(), repeated.runs, reduced, &clusterInfo);
+
+        for (int i = 0; i < nodeCount; ++i) {
+            std::vector<BenchmarkResult> nodeRuns;
+            for (const ClusterRun& call : calls) {
+                const NodeRun& node = call.nodes[i];
+                double estimate = node.trials > 0 ? 4.0 * static_cast<double>(node.hits) / static_cast<double>(node.trials) : 0.0;
+                nodeRuns.push_back({method->label(), node.trials, node.hits, estimate, std::fabs(estimate - kPi), node.elapsedNs, {}});
+            }
+            ResultLog::global().add(method->name, nodes[i].threads, nodeRuns, ResultNode{nodes[i].name, nodeCount, {}},
+                                    &nodes[i].info);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Submits `jobCount` concurrent jobs per method and prints their latency and throughput.
+ * @param methods     Threaded methods to load
+ * @param scheduler   Job scheduler shared by every job
+ * @param jobCount    Jobs submitted at once per method
+ * @param jobTrials   Trials per job
+ * @param deadline    Per-job deadline (0 = none)
+ * @return false if any job failed
+ */
+bool run_job_load(const std::vector<const MethodInfo*>& methods, JobScheduler& scheduler, int jobCount,
+                  std::int64_t jobTrials, std::chrono::milliseconds deadline) {
+    bool ok = true;
+    for (const MethodInfo* method : methods) {
+        std::vector<JobHandle> handles;
+        handles.reserve(static_cast<std::size_t>(jobCount));
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < jobCount; ++i) handles.push_back(scheduler.submit({method->name, jobTrials, deadline}));
+
+        std::vector<BenchmarkResult> runs;
+        int statusCounts[static_cast<int>(JobStatus::Failed) + 1] = {};
+        std::int64_t trials = 0;
+        std::int64_t hits = 0;
+        for (const JobHandle& handle : handles) {
+            JobResult job = handle.wait();
+            ++statusCounts[static_cast<int>(job.status)];
+            if (job.status == JobStatus::Failed) {
+                if (ok) std::cerr << "[ERROR] " << method->name << " job failed: " << job.error << "\n";
+                ok = false;
+                continue;
+            }
+            trials += job.trials;
+            hits += job.hits;
+            runs.push_back({method->name + " (Jobs)", job.trials, job.hits, job.estimate, std::fabs(job.estimate - kPi),
+                            job.elapsedNs, {}});
+        }
+        long long wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << method->name << " (Jobs):\n"
+                  << "  Jobs: " << jobCount << " x " << jobTrials << " trials on " << scheduler.size() << " workers (";
+        const char* separator = "";
+        for (int status = 0; status <= static_cast<int>(JobStatus::Failed); ++status) {
+            if (statusCounts[status] == 0) continue;
+            std::cout << separator << statusCounts[status] << " " << jobStatusName(static_cast<JobStatus>(status));
+            separator = ", ";
+        }
+        std::cout << ")\n";
+        if (runs.empty()) continue;
+
+        RunStatistics latency = computeRunStatistics(runs);
+        double estimate = trials > 0 ? 4.0 * static_cast<double>(hits) / static_cast<double>(trials) : 0.0;
+        std::cout << "  Latency: median " << latency.medianNs / 1e6 << " ms, p90 " << latency.p90Ns / 1e6 << " ms, p99 "
+                  << latency.p99Ns / 1e6 << " ms\n";
+        std::cout << "  Throughput: " << static_cast<double>(trials) / std::max(1.0, static_cast<double>(wallNs)) * 1e3
+                  << " M trials/s, " << static_cast<double>(jobCount) / (static_cast<double>(wallNs) / 1e9) << " jobs/s\n"
+                  << "  Estimate (pooled): " << estimate << " (error " << std::fabs(estimate - kPi) << ", " << trials
+                  << " trials)\n";
+        ResultLog::global().add(method->name, scheduler.size(), runs);
+    }
+    return ok;
+}
+
+/**
+ * @brief Resolves the method argument against the registry.
+ * @param text    `All`, one method name, or a comma-separated list of names
+ * @param methods Registry entries in run order on success
+ * @return false (after printing the valid names) if any name is unknown
+ */
+bool resolveMethods(const std::string& text, std::vector<const MethodInfo*>& methods) {
+    if (text == "All") {
+        for (const MethodInfo& method : methodRegistry()) {
+            if (methodAvailable(method)) methods.push_back(&method);
+        }
+        return true;
+    }
+
+    std::size_t begin = 0;
+    while (begin <= text.size()) {
+        std::size_t end = text.find(',', begin);
+        if (end == std::string::npos) end = text.size();
+        std::string name = text.substr(begin, end - begin);
+        const MethodInfo* method = findMethod(name);
+        if (!method) {
+            std::cerr << "[ERROR] Unknown method: " << name << "\n";
+            std::cerr << "Valid options:";
+            for (const MethodInfo& entry : methodRegistry()) std::cerr << " " << entry.name;
+            std::cerr << " All (or a comma-separated list; see --list)\n";
+            return false;
+        }
+        if (!methodAvailable(*method)) {
+            std::cerr << "[ERROR] " << name << " is unavailable: " << gpuDevice().status << "\n";
+            return false;
+        }
+        methods.push_back(method);
+        begin = end + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the CLI: parses arguments and dispatches benchmark runs.
+ *
+ * Parses CLI arguments and dispatches benchmark runs through the method
+ * registry (`methods.hpp`): one method, a list of methods, or All.
  *
  * Runs timing and aggregation logic per method and prints π estimates
  * and execution times.
@@ -77,105 +586,479 @@ void print_arch_info() {
  * @param argc Number of CLI arguments
  * @param argv Array of CLI argument strings
  * @return 0 on success, non-zero on invalid method or failure
+ * @throws Kernel errors such as `PoolExhausted` (reported by `main`)
  */
-int main(int argc, char* argv[]) {
-    print_arch_info();
-
-    int totalTrials = 100'000'000;
+int run_cli(int argc, char* argv[]) {
+    std::int64_t totalTrials = 100'000'000;
     std::string method = "All";
+    std::string kernel;
+    std::string pin;
+    std::string sweep;
+    std::string epsilon;
+    std::string deadlineMs;
+    std::string seed;
+    std::string buffer;
+    std::string list;
+    bool counters = false;
+    bool convergence = false;
+    bool countStage = false;
+    bool integrate = false;
+    bool autotune = false;
+    std::string tuneCache = kDefaultTuneCache;
+    std::string targetError;
+    std::string arrowOut;
+    std::string batchId;
+    std::string coordinator;
+    std::string nodes;
+    std::string worker;
+    std::string jobs;
+    std::string tracePath;
+    std::string specPath;
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount <= 0) threadCount = 4;
+    long long coordinatorPort = 0;
+    long long nodeCount = 0;
+    long long jobCount = 0;
 
-    if (argc > 1) totalTrials = std::atoi(argv[1]);
-    if (argc > 2) method = argv[2];
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
 
-    std::unordered_set<std::string> validMethods = {
-        "Sequential", "Heap", "Pool", "SIMD", "All"
-    };
-    if (!validMethods.count(method)) {
-        std::cerr << "[ERROR] Unknown method: " << method << "\n";
-        std::cerr << "Valid options: Sequential, Heap, Pool, SIMD, All\n";
+        // Accepts both `--name value` and `--name=value`
+        auto option = [&](const std::string& name, std::string& value) { return takeOption(argc, argv, i, name, value); };
+
+        std::string value;
+        if (arg == "--list") {
+            list = "table";
+        } else if (arg == "--counters") {
+            counters = true;
+        } else if (arg == "--convergence") {
+            convergence = true;
+        } else if (arg == "--count-stage") {
+            countStage = true;
+        } else if (arg == "--integrate") {
+            integrate = true;
+        } else if (arg == "--autotune") {
+            autotune = true;
+        } else if (option("--kernel", kernel) || option("--pin", pin) || option("--sweep", sweep) ||
+            option("--epsilon", epsilon) || option("--deadline-ms", deadlineMs) || option("--seed", seed) ||
+            option("--buffer", buffer) || option("--list", list) || option("--arrow-out", arrowOut) ||
+            option("--batch-id", batchId) || option("--target-error", targetError) || option("--worker", worker) ||
+            option("--tune-cache", tuneCache) || option("--trace", tracePath) || option("--spec", specPath)) {
+            continue;
+        } else if (option("--warmup", value) || option("--reps", value)) {
+            if (!applyRepeatCount(arg.rfind("--warmup", 0) == 0, value)) return EXIT_FAILURE;
+        } else if (option("--threads", value)) {
+            long long count = 0;
+            if (!parseCountOption("thread count", value, 1, 65536, count)) return EXIT_FAILURE;
+            threadCount = static_cast<int>(count);
+        } else if (option("--coordinator", coordinator)) {
+            if (!parseCountOption("coordinator port", coordinator, 1, 65535, coordinatorPort)) return EXIT_FAILURE;
+        } else if (option("--nodes", nodes)) {
+            if (!parseCountOption("node count", nodes, 1, 4096, nodeCount)) return EXIT_FAILURE;
+        } else if (option("--jobs", jobs)) {
+            if (!parseCountOption("job count", jobs, 1, 1'000'000, jobCount)) return EXIT_FAILURE;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "[ERROR] Unknown option or missing value: " << arg << "\n";
+            return EXIT_FAILURE;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    // `--list` only describes the registry, so it runs before any other validation
+    if (!list.empty()) {
+        if (list == "table") {
+            printMethodList();
+        } else if (list == "names" || list == "threaded") {
+            for (const MethodInfo& entry : methodRegistry()) {
+                if (!methodAvailable(entry)) continue;
+                if (list == "names" || entry.threading == MethodThreading::Pool) std::cout << entry.name << "\n";
+            }
+        } else {
+            std::cerr << "[ERROR] Invalid list format: " << list << "\n";
+            std::cerr << "Valid options: names, threaded (or bare --list for the table)\n";
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+
+    if (positional.size() > 2) {
+        std::cerr << "[ERROR] Unexpected argument: " << positional[2] << "\n";
+        std::cerr << "Expected at most a trial count and a method\n";
+        return EXIT_FAILURE;
+    }
+    if (positional.size() > 0 && !parseTrialCount(positional[0], totalTrials)) {
+        std::cerr << "[ERROR] Invalid trial count: " << positional[0] << "\n";
+        std::cerr << "Expected a positive integer, e.g. 100000000 or 1e11\n";
         return EXIT_FAILURE;
     }
+    if (positional.size() > 1) method = positional[1];
 
-    int threadCount = 4;
+    if (!seed.empty()) {
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long value = std::strtoull(seed.c_str(), &end, 0);
+        if (*end != '\0' || errno == ERANGE || seed[0] == '-') {
+            std::cerr << "[ERROR] Invalid seed: " << seed << " (expected an unsigned 64-bit integer)\n";
+            return EXIT_FAILURE;
+        }
+        setRunSeed(value);
+    }
 
-    if (method == "Sequential" || method == "All") {
-        benchmark("Sequential", totalTrials, [&]() {
-            return monteCarloPI_SEQUENTIAl(totalTrials);
-        });
+    if (!buffer.empty() && !applyBufferTrials(buffer)) return EXIT_FAILURE;
+
+    StopCriteria criteria;
+    if (!epsilon.empty()) {
+        char* end = nullptr;
+        criteria.epsilon = std::strtod(epsilon.c_str(), &end);
+        if (*end != '\0' || !std::isfinite(criteria.epsilon) || !(criteria.epsilon > 0.0)) {
+            std::cerr << "[ERROR] Invalid epsilon: " << epsilon << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (!deadlineMs.empty()) {
+        std::chrono::milliseconds deadline{0};
+        if (!parseDeadlineMs(deadlineMs, deadline)) return EXIT_FAILURE;
+        criteria.deadline = deadline;
     }
 
-    if (method == "Heap" || method == "All") {
-        benchmark("Heap (Threaded)", totalTrials, [&]() {
-            std::vector<std::thread> threads;
-            std::vector<int*> results(threadCount);
-            int perThread = totalTrials / threadCount;
+    double targetRmse = 0.0;
+    if (!targetError.empty()) {
+        char* end = nullptr;
+        targetRmse = std::strtod(targetError.c_str(), &end);
+        if (*end != '\0' || !std::isfinite(targetRmse) || !(targetRmse > 0.0)) {
+            std::cerr << "[ERROR] Invalid target error: " << targetError << "\n";
+            return EXIT_FAILURE;
+        }
+        if (!convergence) {
+            std::cerr << "[ERROR] --target-error requires --convergence\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (convergence && (criteria.active() || !sweep.empty())) {
+        std::cerr << "[ERROR] --convergence cannot be combined with --sweep, --epsilon or --deadline-ms\n";
+        return EXIT_FAILURE;
+    }
 
-            for (int t = 0; t < threadCount; ++t) {
-                threads.emplace_back([&, t]() {
-                    results[t] = monteCarloPI_HEAP(perThread);
-                });
-            }
+    if (coordinatorPort > 0) {
+        if (nodeCount == 0) {
+            std::cerr << "[ERROR] --coordinator requires --nodes N (1 to 4096)\n";
+            return EXIT_FAILURE;
+        }
+        if (!worker.empty() || convergence || criteria.active() || !sweep.empty() || counters) {
+            std::cerr << "[ERROR] --coordinator cannot be combined with --worker, --convergence, --sweep, "
+                         "--epsilon, --deadline-ms or --counters\n";
+            return EXIT_FAILURE;
+        }
+    } else if (nodeCount > 0) {
+        std::cerr << "[ERROR] --nodes requires --coordinator\n";
+        return EXIT_FAILURE;
+    }
+    if (countStage && (convergence || criteria.active() || !sweep.empty() || !coordinator.empty() || !worker.empty())) {
+        std::cerr << "[ERROR] --count-stage cannot be combined with --convergence, --sweep, --epsilon, "
+                     "--deadline-ms, --coordinator or --worker\n";
+        return EXIT_FAILURE;
+    }
 
-            for (auto& th : threads) th.join();
+    if (jobCount > 0) {
+        if (convergence || criteria.epsilon > 0.0 || !sweep.empty() || !coordinator.empty() || !worker.empty() ||
+            countStage || counters) {
+            std::cerr << "[ERROR] --jobs cannot be combined with --convergence, --epsilon, --sweep, --coordinator, "
+                         "--worker, --count-stage or --counters\n";
+            return EXIT_FAILURE;
+        }
+    }
 
-            int totalHits = 0;
-            for (auto ptr : results) {
-                totalHits += *ptr;
-                delete ptr;
+    if (integrate && (positional.size() > 1 || convergence || criteria.active() || !sweep.empty() ||
+                      !coordinator.empty() || !worker.empty() || jobCount > 0 || countStage || autotune ||
+                      !specPath.empty())) {
+        std::cerr << "[ERROR] --integrate takes only a trial count and cannot be combined with --convergence, "
+                     "--epsilon, --deadline-ms, --sweep, --coordinator, --worker, --jobs, --count-stage, --autotune "
+                     "or --spec\n";
+        return EXIT_FAILURE;
+    }
+
+    // The spec replaces the positional arguments and overrides --threads / --pin / --reps / --warmup
+    SweepSpec spec;
+    if (!specPath.empty()) {
+        if (!positional.empty() || convergence || criteria.active() || !sweep.empty() || !coordinator.empty() ||
+            !worker.empty() || jobCount > 0 || countStage || autotune) {
+            std::cerr << "[ERROR] --spec cannot be combined with positional arguments, --convergence, --epsilon, "
+                         "--deadline-ms, --sweep, --coordinator, --worker, --jobs, --count-stage or --autotune\n";
+            return EXIT_FAILURE;
+        }
+        if (!loadSweepSpec(specPath, spec)) return EXIT_FAILURE;
+        method = spec.methods;
+        if (spec.hasPin) pin = spec.pin;
+        if (spec.reps > 0) RepeatConfig::global().repetitions = spec.reps;
+        if (spec.warmup >= 0) RepeatConfig::global().warmup = spec.warmup;
+        if (spec.threads.empty()) spec.threads.push_back(static_cast<unsigned>(threadCount));
+        if (!sweepSpecTrialsFit(spec)) {
+            std::cerr << "[ERROR] Sweep spec " << specPath << ": weak scaling overflows the 64-bit trial count\n";
+            return EXIT_FAILURE;
+        }
+        for (const std::string& name : spec.kernels) {
+            bool supported = false;
+            for (const SimdBackend& backend : simdBackends()) supported |= name == backend.name && backend.supported();
+            if (!supported) {
+                std::cerr << "[ERROR] Sweep spec kernel not available on this CPU/build: " << name << "\n";
+                return EXIT_FAILURE;
             }
+        }
+        // The first kernel is bound for the banner, the tuning lookup and the metadata columns
+        if (!spec.kernels.empty()) kernel = spec.kernels.front();
+    }
 
-            return totalHits;
-        });
+    if (!selectSimdBackend(kernel)) {
+        std::cerr << "[ERROR] SIMD kernel not available on this CPU/build: " << kernel << "\n";
+        std::cerr << "Compiled kernels:";
+        for (const SimdBackend& backend : simdBackends()) {
+            std::cerr << " " << backend.name << (backend.supported() ? "" : " (unsupported)");
+        }
+        std::cerr << "\n";
+        return EXIT_FAILURE;
     }
 
-    
-    if (method == "Pool" || method == "All") {
-        benchmark("Pool (Threaded)", totalTrials, [&]() {
-            std::vector<std::thread> threads;
-            std::vector<int*> results(threadCount);
-            int perThread = totalTrials / threadCount;
+    print_arch_info();
 
-            for (int t = 0; t < threadCount; ++t) {
-                threads.emplace_back([&, t]() {
-                    results[t] = monteCarloPI_POOL(perThread);
-                });
-            }
+    // Tuning is keyed by CPU model and backend, so it is resolved once the backend is bound
+    if (autotune) {
+        SimdTuning best = autotuneSimd();
+        if (tuneCache == "none") return 0;
+        if (!writeTuningCache(tuneCache, best)) return EXIT_FAILURE;
+        std::cout << "[INFO] Saved to " << tuneCache << " for " << best.cpu << "\n";
+        return 0;
+    }
+    if (tuneCache != "none") applyTuningCache(tuneCache);
+    if (counters) PerfCounters::global().enable();
+    if (!tracePath.empty()) {
+        if (!TraceLog::global().open(tracePath)) return EXIT_FAILURE;
+        std::cout << "[INFO] Trace: recording spans for " << tracePath << "\n";
+    }
+    // Tuning is applied and the backend bound by now, so the kernel column names what actually runs
+    RunInfo info = RunInfo::capture();
+    info.simdKernel = activeSimdKernelName();
+    info.pinning = pin.empty() ? "none" : pin;
+    if (!arrowOut.empty()) {
+        if (batchId.empty()) batchId = randomBatchId();
+        ResultLog::global().open(arrowOut, batchId, info);
+        std::cout << "[INFO] Arrow results: " << arrowOut << " (batch " << batchId << ")\n";
+    }
+    if (RunSeed::global().enabled) std::cout << "[INFO] Seed: " << RunSeed::global().value << " (reproducible)\n";
 
-            for (auto& th : threads) th.join();
+    // Count-stage kernels are not registry methods: one pre-generated buffer, no pool, no RNG in the timing
+    if (countStage) {
+        std::uint64_t inputSeed = RunSeed::global().enabled ? RunSeed::global().value : entropySeed();
+        bool agree = runCountStageBenchmark(totalTrials, BufferConfig::global().trials, inputSeed,
+                                            [](const std::string& name, const RepeatedResult& repeated) {
+                                                ResultLog::global().add(name, 1, repeated.runs);
+                                            });
+        return agree && ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+    }
 
-            int totalHits = 0;
-            for (auto ptr : results) {
-                // NOTE: No delete required — memory allocated from PoolAllocator
-                totalHits += *ptr;
-            }
+    std::vector<const MethodInfo*> methods;
+    if (!resolveMethods(method, methods)) return EXIT_FAILURE;
 
-            return totalHits;
-        });
+    // The trial budget is only an upper bound under early stop, so single-threaded methods can't honour it
+    if (criteria.active() && method != "All") {
+        for (const MethodInfo* entry : methods) {
+            if (entry->threading == MethodThreading::Pool) continue;
+            std::cerr << "[ERROR] --epsilon / --deadline-ms require a threaded method, got: " << entry->name << "\n";
+            return EXIT_FAILURE;
+        }
     }
 
-    if (method == "SIMD" || method == "All") {
-        benchmark("SIMD (Threaded)", totalTrials, [&]() {
-            std::vector<std::thread> threads;
-            std::vector<int*> results(threadCount);
-            int perThread = totalTrials / threadCount;
+    std::vector<int> cpus;
+    if (!resolvePinning(pin, cpus)) {
+        std::cerr << "[ERROR] Invalid pin policy: " << pin << "\n";
+        std::cerr << "Valid options: compact, scatter, or a CPU list such as 0-3,8\n";
+        return EXIT_FAILURE;
+    }
+    PinConfig::global().cpus = cpus;
 
-            for (int t = 0; t < threadCount; ++t) {
-                threads.emplace_back([&, t]() {
-                    results[t] = monteCarloPI_SIMD(perThread);
-                });
+    // Integrals are not registry methods: their estimates are volumes and means, not π
+    if (integrate) {
+        ThreadPool integralPool(static_cast<unsigned>(threadCount), cpus);
+        print_thread_info(integralPool, pin, cpus);
+        return runIntegralChecks(integralPool, totalTrials) ? 0 : EXIT_FAILURE;
+    }
+
+    if (!specPath.empty()) {
+        if (spec.kernels.empty()) spec.kernels.push_back(activeSimdBackend().name);
+        std::size_t points = 0;
+        for (const MethodInfo* entry : methods) {
+            std::size_t threadPoints = entry->threading == MethodThreading::Single ? 1 : spec.threads.size();
+            std::size_t kernelPoints = entry->isa == MethodIsa::SimdBackend ? spec.kernels.size() : 1;
+            points += threadPoints * kernelPoints * spec.trials.size();
+        }
+        std::cout << "[INFO] Sweep spec: " << specPath << ", " << points << " points (" << methods.size() << " methods, "
+                  << spec.trials.size() << " trial counts, " << spec.threads.size() << " thread counts, "
+                  << spec.kernels.size() << " kernels, " << (spec.weak ? "weak" : "strong") << " scaling), "
+                  << RepeatConfig::global().repetitions << " timed + " << RepeatConfig::global().warmup
+                  << " warmup each\n";
+        run_sweep_spec(spec, methods, cpus, pin, tuneCache);
+        return ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+    }
+
+    if (!worker.empty()) {
+        ThreadPool workerPool(static_cast<unsigned>(threadCount), cpus);
+        print_thread_info(workerPool, pin, cpus);
+        return serveClusterWorker(worker, workerPool, info);
+    }
+
+    if (!sweep.empty()) {
+        if (sweep != "strong" && sweep != "weak") {
+            std::cerr << "[ERROR] Invalid sweep mode: " << sweep << "\n";
+            std::cerr << "Valid options: strong, weak\n";
+            return EXIT_FAILURE;
+        }
+        if (criteria.active()) {
+            std::cerr << "[ERROR] --epsilon / --deadline-ms cannot be combined with --sweep\n";
+            return EXIT_FAILURE;
+        }
+        std::vector<const MethodInfo*> threaded;
+        for (const MethodInfo* entry : methods) {
+            if (entry->threading == MethodThreading::Pool) {
+                threaded.push_back(entry);
+            } else if (method != "All") {
+                std::cerr << "[ERROR] Sweep requires a threaded method, got: " << entry->name << "\n";
+                return EXIT_FAILURE;
             }
+        }
+
+        ScalingMode mode = sweep == "strong" ? ScalingMode::Strong : ScalingMode::Weak;
+        if (mode == ScalingMode::Weak && totalTrials > std::numeric_limits<std::int64_t>::max() / threadCount) {
+            std::cerr << "[ERROR] Weak sweep overflows the 64-bit trial count at " << threadCount << " threads\n";
+            return EXIT_FAILURE;
+        }
 
-            for (auto& th : threads) th.join();
+        std::cout << "[INFO] Sweep: " << sweep << " scaling, 1 to " << threadCount << " threads"
+                  << (pin.empty() ? " (unpinned)" : " (pin " + pin + ")") << "\n";
+        run_scaling_sweeps(threaded, mode, totalTrials, static_cast<unsigned>(threadCount), cpus);
+        return ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+    }
 
-            int totalHits = 0;
-            for (auto ptr : results) {
-                // NOTE: No delete required — memory allocated from PoolAllocator
-                totalHits += *ptr;
+    if (coordinatorPort > 0) {
+        std::vector<const MethodInfo*> threaded;
+        for (const MethodInfo* entry : methods) {
+            if (entry->threading == MethodThreading::Pool) {
+                threaded.push_back(entry);
+            } else if (method != "All") {
+                std::cerr << "[ERROR] Distributed runs require a threaded method, got: " << entry->name << "\n";
+                return EXIT_FAILURE;
             }
+        }
 
-            return totalHits;
-        });
+        ClusterCoordinator cluster;
+        if (!cluster.accept(static_cast<std::uint16_t>(coordinatorPort), static_cast<int>(nodeCount))) return EXIT_FAILURE;
+
+        // Workers always run seeded, so their chunk ranges are disjoint Philox streams
+        const RunSeed& runSeed = RunSeed::global();
+        std::uint64_t clusterSeed = runSeed.enabled ? runSeed.value : entropySeed();
+        if (!runSeed.enabled) std::cout << "[INFO] Seed: " << clusterSeed << " (cluster streams)\n";
+        bool ok = cluster.broadcastSeed(clusterSeed) && run_distributed(threaded, cluster, totalTrials);
+        cluster.shutdown();
+        return ok && ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+    }
+
+    if (jobCount > 0) {
+        std::vector<const MethodInfo*> threaded;
+        for (const MethodInfo* entry : methods) {
+            if (entry->threading == MethodThreading::Pool) {
+                threaded.push_back(entry);
+            } else if (method != "All") {
+                std::cerr << "[ERROR] --jobs requires a threaded method, got: " << entry->name << "\n";
+                return EXIT_FAILURE;
+            }
+        }
+
+        JobScheduler scheduler(static_cast<unsigned>(threadCount), cpus);
+        std::cout << "[INFO] Jobs: " << jobCount << " concurrent per method, " << totalTrials << " trials each, "
+                  << scheduler.size() << " workers" << (pin.empty() ? " (unpinned)" : " (pin " + pin + ")");
+        if (criteria.deadline.count() > 0) std::cout << ", deadline " << deadlineMs << " ms per job";
+        std::cout << "\n";
+        bool ok = run_job_load(threaded, scheduler, static_cast<int>(jobCount), totalTrials,
+                               std::chrono::duration_cast<std::chrono::milliseconds>(criteria.deadline));
+        return ok && ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+    }
+
+    ThreadPool pool(static_cast<unsigned>(threadCount), cpus);
+    print_thread_info(pool, pin, cpus);
+
+    if (convergence) {
+        // RMSE needs independent repetitions; one sample per point would just be |error|
+        if (RepeatConfig::global().repetitions == 1) RepeatConfig::global().repetitions = kConvergenceRepetitions;
+        std::cout << "[INFO] Convergence: 4096 to " << totalTrials << " trials, "
+                  << RepeatConfig::global().repetitions << " repetitions per point\n";
+        if (RunSeed::global().enabled) {
+            std::cout << "[WARN] --seed makes repetitions identical; RMSE is the error of a single sample\n";
+        }
+        run_convergence_sweeps(methods, pool, totalTrials, targetRmse);
+        return ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+    }
+
+    if (criteria.active()) {
+        std::cout << "[INFO] Early stop:";
+        if (criteria.epsilon > 0.0) std::cout << " CI half-width <= " << criteria.epsilon;
+        if (criteria.deadline.count() > 0) std::cout << " deadline " << deadlineMs << " ms";
+        std::cout << " (budget " << totalTrials << " trials)\n";
+        if (RepeatConfig::global().warmup > 0 || RepeatConfig::global().repetitions > 1) {
+            std::cout << "[WARN] --warmup / --reps are ignored under early stop (one streaming run per method)\n";
+        }
+    } else if (RepeatConfig::global().repetitions > 1 || RepeatConfig::global().warmup > 0) {
+        std::cout << "[INFO] Repetitions: " << RepeatConfig::global().repetitions << " timed, "
+                  << RepeatConfig::global().warmup << " warmup per method\n";
     }
 
-    return 0;
+    // Earlier results feed the comparison lines printed by later methods' report hooks
+    MethodResults results;
+    for (const MethodInfo* entry : methods) {
+        if (criteria.active() && entry->threading == MethodThreading::Single) {
+            std::cout << "[WARN] Skipping " << entry->name << " (no early stop)\n";
+            continue;
+        }
+        if (entry->prepare) entry->prepare();
+
+        ThreadPool::ChunkKernel chunkKernel = entry->makeKernel(pool.size());
+        RepeatedResult repeated;
+        if (entry->threading == MethodThreading::Single) {
+            repeated = benchmarkRepeated(entry->label(), totalTrials, [&]() { return chunkKernel(totalTrials); });
+        } else if (criteria.active()) {
+            // Threaded methods stream until the early-stop criteria are met
+            repeated.median = benchmark_streaming(entry->label(), pool, chunkKernel, totalTrials, criteria);
+            repeated.runs = {repeated.median};
+        } else {
+            repeated = benchmarkRepeated(entry->label(), totalTrials, [&]() {
+                return pool.run(totalTrials, kDefaultChunkTrials, chunkKernel);
+            });
+        }
+        const BenchmarkResult& result = repeated.median;
+        ResultLog::global().add(entry->name, entry->threading == MethodThreading::Pool ? pool.size() : 1, repeated.runs);
+
+        if (entry->report) entry->report(result, results);
+        results[entry->name] = result;
+    }
+
+    return ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+}
+
+/**
+ * @brief Entry point for running Monte Carlo simulations via CLI.
+ *
+ * Kernels report failures as exceptions so they can be embedded (`jobs.hpp`); here they end the
+ * process with an `[ERROR]` line, as before.
+ *
+ * @param argc Number of CLI arguments
+ * @param argv Array of CLI argument strings
+ * @return 0 on success, non-zero on invalid method or failure
+ */
+int main(int argc, char* argv[]) {
+    try {
+        int status = run_cli(argc, argv);
+        return TraceLog::global().flush() ? status : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
 }
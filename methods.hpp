@@ -0,0 +1,287 @@
+// ========================================
+// methods.hpp - Benchmark method registry
+// ========================================
+/**
+ * @file methods.hpp
+ * @brief Single table of every benchmarkable method: name, kernel, threading model and ISAs.
+ *
+ * `main.cpp`, `--list`, `All` and the sweep mode all iterate this table, and
+ * `scripts/run_perf.sh` reads it through `montecarlo --list=names`. Adding a method means adding
+ * one `MethodInfo` entry here — no other file has to learn its name.
+ *
+ * ---
+ *
+ * ## Entry Fields
+ * | Field        | Meaning                                                                |
+ * |--------------|------------------------------------------------------------------------|
+ * | `name`       | CLI / log name, also the `Method` column in the perf pipeline          |
+ * | `threading`  | `Single` (runs on the calling thread) or `Pool` (chunked on `ThreadPool`) |
+ * | `isa`        | `Portable` (plain C++), `SimdBackend` (one kernel per `dispatch.hpp` backend) or `Gpu` |
+ * | `makeKernel` | Builds the chunk kernel; `workers` sizes any per-worker state          |
+ * | `prepare`    | Optional: runs before the timed run (e.g. reset stage counters)        |
+ * | `report`     | Optional: prints extra lines after the result, given earlier results   |
+ *
+ * `Single` methods run their kernel once over all trials; `Pool` kernels get one chunk per call
+ * and may use `ThreadPool::currentWorker()` / `RunSeed::currentChunk()`.
+ *
+ * `Gpu` methods stay in the table but are skipped by `All` and `--list=names` when no CUDA device
+ * is usable (`methodAvailable()`), so `run_perf.sh` only picks them up on GPU builds.
+ *
+ * ## Example
+ * ```cpp
+ * for (const MethodInfo& method : methodRegistry()) {
+ *     std::cout << method.name << (method.threading == MethodThreading::Pool ? " (Threaded)" : "") << "\n";
+ * }
+ * ```
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "buffered.hpp"
+#include "dispatch.hpp"
+#include "falsesharing.hpp"
+#include "offload.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// How a method uses threads.
+enum class MethodThreading {
+    Single,   ///< One call over all trials on the calling thread
+    Pool,     ///< One call per chunk on the `ThreadPool`
+};
+
+/// Which instruction sets a method has kernels for.
+enum class MethodIsa {
+    Portable,      ///< Plain C++, runs anywhere
+    SimdBackend,   ///< One kernel per compiled `SimdBackend`, bound at startup (`--kernel`)
+    Gpu,           ///< Offloads to the CUDA device (`gpu.hpp`); unavailable without one
+};
+
+/// Results of methods already run in this invocation, by method name.
+using MethodResults = std::unordered_map<std::string, BenchmarkResult>;
+
+/**
+ * @brief One registered benchmark method.
+ */
+struct MethodInfo {
+    std::string name;                                                 ///< CLI / log name
+    std::string description;                                          ///< One-line summary for `--list`
+    MethodThreading threading;                                        ///< Threading model
+    MethodIsa isa;                                                    ///< Instruction-set coverage
+    std::function<ThreadPool::ChunkKernel(unsigned workers)> makeKernel;  ///< Chunk (or whole-run) kernel
+    std::function<void()> prepare;                                    ///< Optional pre-run hook
+    std::function<void(const BenchmarkResult&, const MethodResults&)> report;  ///< Optional post-run hook
+
+    /**
+     * @brief Label used in benchmark output.
+     * @return `name`, plus " (Threaded)" for pool methods
+     */
+    std::string label() const {
+        return threading == MethodThreading::Pool ? name + " (Threaded)" : name;
+    }
+};
+
+/**
+ * @brief Wall time per trial, so runs that stopped early at different trial counts compare fairly.
+ * @param result Benchmark result
+ * @return Nanoseconds per trial
+ */
+inline double nsPerTrial(const BenchmarkResult& result) {
+    return static_cast<double>(result.elapsedNs) / static_cast<double>(std::max<std::int64_t>(1, result.trials));
+}
+
+/**
+ * @brief Prints speedup and accuracy delta of a float32 run against the float64 baseline.
+ * @param f32 Result of a float32 method
+ * @param f64 Result of `SIMDXoshiro` from the same invocation
+ */
+inline void printPrecisionComparison(const BenchmarkResult& f32, const BenchmarkResult& f64) {
+    double speedup = nsPerTrial(f64) / nsPerTrial(f32);
+    std::cout << "  vs " << f64.name << ": speedup " << speedup << "x"
+              << ", accuracy delta " << (f32.absError - f64.absError)
+              << " (|err| " << f32.absError << " vs " << f64.absError << ")\n";
+}
+
+/**
+ * @brief Prints how much slower packed per-worker counters were than padded ones.
+ * @param padded Result of `PaddedSlots`
+ * @param packed Result of `PackedSlots` from the same invocation
+ */
+inline void printFalseSharingPenalty(const BenchmarkResult& padded, const BenchmarkResult& packed) {
+    double penalty = nsPerTrial(packed) / nsPerTrial(padded);
+    std::cout << "  False-sharing penalty (" << packed.name << " / " << padded.name << "): "
+              << penalty << "x\n";
+}
+
+/**
+ * @brief Prints how the buffered kernels' CPU time divides between their two stages.
+ * @param stats Stage totals of the last `SIMDBuffered` run
+ */
+inline void printStageSplit(const BufferedStageStats& stats) {
+    double generate = static_cast<double>(stats.generateNs.load());
+    double count = static_cast<double>(stats.countNs.load());
+    double total = std::max(1.0, generate + count);
+    auto percent = [total](double ns) { return std::round(1000.0 * ns / total) / 10.0; };
+    std::cout << "  Stages (CPU time over workers): generate " << percent(generate) << "% (" << generate / 1e9
+              << "s), count " << percent(count) << "% (" << count / 1e9 << "s)\n";
+}
+
+/**
+ * @brief Wraps a kernel that returns a pool-allocated counter (no delete required).
+ * @param kernel Kernel returning a pointer into its `thread_local` PoolAllocator
+ * @return Kernel factory returning the hit count by value
+ */
+inline std::function<ThreadPool::ChunkKernel(unsigned)> pooledKernel(std::int64_t* (*kernel)(std::int64_t)) {
+    return [kernel](unsigned) -> ThreadPool::ChunkKernel {
+        return [kernel](std::int64_t trials) { return *kernel(trials); };
+    };
+}
+
+/**
+ * @brief Kernel factory for the per-worker slot benchmarks in `falsesharing.hpp`.
+ * @tparam Slot `PackedCounter` or `PaddedCounter`
+ * @return Factory allocating one slot per worker
+ */
+template <typename Slot>
+inline std::function<ThreadPool::ChunkKernel(unsigned)> slotKernel() {
+    return [](unsigned workers) -> ThreadPool::ChunkKernel {
+        auto slots = std::make_shared<std::vector<Slot>>(std::max(1u, workers));
+        return [slots](std::int64_t trials) { return monteCarloPI_SLOTS(*slots, ThreadPool::currentWorker(), trials); };
+    };
+}
+
+/**
+ * @brief Post-run hook comparing a float32 method to `SIMDXoshiro`, when that ran earlier.
+ * @return Report hook
+ */
+inline std::function<void(const BenchmarkResult&, const MethodResults&)> comparePrecision() {
+    return [](const BenchmarkResult& result, const MethodResults& earlier) {
+        auto baseline = earlier.find("SIMDXoshiro");
+        if (baseline != earlier.end()) printPrecisionComparison(result, baseline->second);
+    };
+}
+
+/**
+ * @brief Every method, in `All` order.
+ * @return Method table
+ */
+inline const std::vector<MethodInfo>& methodRegistry() {
+    static const std::vector<MethodInfo> methods = {
+        {"Sequential", "Single-threaded naive implementation", MethodThreading::Single, MethodIsa::Portable,
+            [](unsigned) -> ThreadPool::ChunkKernel { return monteCarloPI_SEQUENTIAl; }, {}, {}},
+        {"SequentialThreaded", "Sequential's scalar loop as a per-chunk kernel: the threaded baseline",
+            MethodThreading::Pool, MethodIsa::Portable,
+            [](unsigned) -> ThreadPool::ChunkKernel { return monteCarloPI_SEQUENTIAl; }, {}, {}},
+        {"Heap", "Threaded heap allocation per chunk", MethodThreading::Pool, MethodIsa::Portable,
+            [](unsigned) -> ThreadPool::ChunkKernel {
+                return [](std::int64_t trials) {
+                    std::int64_t* result = monteCarloPI_HEAP(trials);
+                    std::int64_t hits = *result;
+                    delete result;
+                    return hits;
+                };
+            }, {}, {}},
+        {"Pool", "Threaded use of a bump allocator (fast reuse, aligned)", MethodThreading::Pool, MethodIsa::Portable,
+            pooledKernel(monteCarloPI_POOL), {}, {}},
+        {"SIMD", "Vectorized compare fed by mt19937_64", MethodThreading::Pool, MethodIsa::SimdBackend,
+            pooledKernel(monteCarloPI_SIMD), {}, {}},
+        {"SIMDXoshiro", "SIMD kernel fed by an in-register xoshiro256+ PRNG", MethodThreading::Pool,
+            MethodIsa::SimdBackend, pooledKernel(monteCarloPI_SIMD_XOSHIRO), {}, {}},
+        {"SIMDF32", "float32 variant of SIMDXoshiro with twice the lanes", MethodThreading::Pool,
+            MethodIsa::SimdBackend, pooledKernel(monteCarloPI_SIMD_F32), {}, comparePrecision()},
+        {"SIMDF32Guard", "SIMDF32 with double-precision re-check of borderline samples", MethodThreading::Pool,
+            MethodIsa::SimdBackend, pooledKernel(monteCarloPI_SIMD_F32_GUARDED), {}, comparePrecision()},
+        {"SIMDBuffered", "Two-stage pipeline: fill SoA x/y buffers, then count them unrolled",
+            MethodThreading::Pool, MethodIsa::SimdBackend, pooledKernel(monteCarloPI_SIMD_BUFFERED),
+            []() {
+                std::size_t bufferTrials = BufferConfig::global().trials;
+                std::cout << "[INFO] Buffer: " << bufferTrials << " trials ("
+                          << (2 * bufferTrials * sizeof(double)) / 1024 << " KiB x/y SoA per worker)\n";
+                BufferedStageStats::global().reset();
+            },
+            [](const BenchmarkResult&, const MethodResults&) { printStageSplit(BufferedStageStats::global()); }},
+        {"Stratified", "Jittered grid: one dart per cell of a sqrt(n) x sqrt(n) grid per chunk",
+            MethodThreading::Pool, MethodIsa::SimdBackend, pooledKernel(monteCarloPI_STRATIFIED), {}, {}},
+        {"LatinHypercube", "One dart per row and column band of each buffer", MethodThreading::Pool,
+            MethodIsa::SimdBackend, pooledKernel(monteCarloPI_LATIN_HYPERCUBE), {}, {}},
+        {"Sobol", "Digitally shifted 2-D Sobol sequence (quasi-random)", MethodThreading::Pool,
+            MethodIsa::SimdBackend, pooledKernel(monteCarloPI_SOBOL), {}, {}},
+        {"Halton", "Rotated 2-D Halton sequence, bases 2 and 3 (quasi-random)", MethodThreading::Pool,
+            MethodIsa::SimdBackend, pooledKernel(monteCarloPI_HALTON), {}, {}},
+        {"PackedSlots", "Writes every trial to per-worker counters packed 8 per cache line",
+            MethodThreading::Pool, MethodIsa::Portable, slotKernel<PackedCounter>(), {}, {}},
+        {"PaddedSlots", "Same as PackedSlots with each counter on its own cache line", MethodThreading::Pool,
+            MethodIsa::Portable, slotKernel<PaddedCounter>(), {},
+            [](const BenchmarkResult& result, const MethodResults& earlier) {
+                auto packed = earlier.find("PackedSlots");
+                if (packed != earlier.end()) printFalseSharingPenalty(result, packed->second);
+            }},
+        {"GPU", "Philox darts on the CUDA device, warp-shuffle reduced to one count", MethodThreading::Single,
+            MethodIsa::Gpu, [](unsigned) -> ThreadPool::ChunkKernel { return monteCarloPI_GPU; },
+            []() { std::cout << "[INFO] GPU: " << gpuDevice().name << " (" << gpuDevice().multiprocessors << " SMs)\n"; },
+            {}},
+        {"Hybrid", "Splits each run between the GPU and SIMDXoshiro workers by measured throughput",
+            MethodThreading::Single, MethodIsa::Gpu,
+            [](unsigned workers) -> ThreadPool::ChunkKernel {
+                auto pool = std::make_shared<ThreadPool>(std::max(1u, workers), PinConfig::global().cpus);
+                return [pool](std::int64_t trials) { return monteCarloPI_HYBRID(*pool, trials); };
+            },
+            []() { HybridSplit::global().reset(); },
+            [](const BenchmarkResult&, const MethodResults&) { printHybridSplit(HybridSplit::global()); }},
+    };
+    return methods;
+}
+
+/**
+ * @brief Looks up a method by name.
+ * @param name CLI method name
+ * @return Registry entry, or nullptr if unknown
+ */
+inline const MethodInfo* findMethod(const std::string& name) {
+    for (const MethodInfo& method : methodRegistry()) {
+        if (method.name == name) return &method;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Whether a method can run in this build on this machine.
+ * @param method Registry entry
+ * @return false for `Gpu` methods without a usable CUDA device
+ */
+inline bool methodAvailable(const MethodInfo& method) {
+    return method.isa != MethodIsa::Gpu || gpuDevice().available;
+}
+
+/**
+ * @brief Prints the registry as a table (`--list`).
+ */
+inline void printMethodList() {
+    std::string backends;
+    for (const SimdBackend& backend : simdBackends()) {
+        if (!backend.supported()) continue;
+        backends += (backends.empty() ? "" : ",") + std::string(backend.name);
+    }
+
+    std::cout << "Method              Threading  ISAs                 Description\n";
+    for (const MethodInfo& method : methodRegistry()) {
+        std::string threading = method.threading == MethodThreading::Pool ? "pool" : "single";
+        std::string isas = method.isa == MethodIsa::SimdBackend ? backends
+                           : method.isa == MethodIsa::Gpu ? (methodAvailable(method) ? "cuda" : "unavailable")
+                                                          : "portable";
+        std::cout << method.name << std::string(method.name.size() < 20 ? 20 - method.name.size() : 1, ' ')
+                  << threading << std::string(11 - threading.size(), ' ')
+                  << isas << std::string(isas.size() < 21 ? 21 - isas.size() : 1, ' ')
+                  << method.description << "\n";
+    }
+    if (!gpuDevice().available) std::cout << "\nGPU methods unavailable: " << gpuDevice().status << "\n";
+}
@@ -0,0 +1,186 @@
+// ========================================
+// microbench.cpp - Microbenchmark Launcher
+// ========================================
+/**
+ * @file microbench.cpp
+ * @brief CLI runner for the RNG, allocator and count-kernel microbenchmarks in `microbench.hpp`.
+ *
+ * ## Usage
+ * ```bash
+ * ./microbench                          # Every case, 10M operations each
+ * ./microbench 1e8 --reps 11 --warmup 1 # Median / p90 / p99 over 11 warm repetitions
+ * ./microbench 1e7 --filter RNG         # Only cases whose name contains "RNG"
+ * ./microbench 1e8 --buffer 1048576     # Count kernels on a DRAM-sized buffer
+ * ./microbench 1e8 --counters --arrow-out results.arrows   # Rows for the perf pipeline
+ * ./microbench --list                   # Case names, one per line
+ * ```
+ *
+ * ## CLI Arguments
+ * - `argv[1]` — Operations per case, integer or scientific notation (optional, default: 10_000_000),
+ *              rounded up to a multiple of 16 (and to whole buffers for the `Count` group)
+ *
+ * ## CLI Options
+ * - `--filter TEXT` — Run only cases whose name contains TEXT (e.g. `Alloc`, `AVX512`)
+ * - `--buffer N`    — Darts per pre-filled `Count` buffer (default: 2048, L1-resident; multiple of 64)
+ * - `--warmup N`, `--reps N`, `--counters`, `--arrow-out PATH`, `--batch-id ID` — as in `montecarlo`
+ * - `--list`        — Print the case names this CPU can run and exit
+ *
+ * ## Output
+ * One block per case: operations, checksum, time, ns and millions of operations per second, plus
+ * the repetition statistics with `--reps` and IPC / cycles per operation with `--counters`.
+ */
+
+#include "microbench.hpp"
+#include "arrowlog.hpp"
+#include "buffered.hpp"
+#include "cli.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs the filtered cases and prints one block per case.
+ * @param cases Cases to run, in order
+ * @return false if a checked case returned the wrong checksum
+ */
+bool run_micro_benchmarks(const std::vector<MicroBenchmark>& cases) {
+    bool ok = true;
+    for (const MicroBenchmark& entry : cases) {
+        RepeatedResult repeated = measureRepeated(entry.name, entry.operations, entry.run);
+        const BenchmarkResult& result = repeated.median;
+        double nsPerOp = static_cast<double>(result.elapsedNs) / static_cast<double>(result.trials);
+
+        std::cout << entry.name << ":\n"
+                  << "  Operations: " << result.trials << " (" << entry.unit << ")\n"
+                  << "  Checksum: " << result.hits << "\n"
+                  << "  Time: " << result.elapsedNs / 1e9 << "s (" << result.elapsedNs << " ns)\n"
+                  << "  Cost: " << nsPerOp << " ns/" << entry.unit << ", " << 1e3 / nsPerOp << " M " << entry.unit
+                  << "s/s\n";
+        const PerfSample& counters = result.counters;
+        if (counters.has(PerfEvent::Cycles) && counters.has(PerfEvent::Instructions)) {
+            std::cout << "  Counters: IPC " << counters[PerfEvent::Instructions] / std::max(1.0, counters[PerfEvent::Cycles])
+                      << ", " << counters[PerfEvent::Cycles] / static_cast<double>(result.trials) << " cycles/"
+                      << entry.unit << "\n";
+        }
+        if (repeated.stats.repetitions > 1) printRunStatistics(repeated.stats);
+
+        if (entry.expected >= 0 && result.hits != entry.expected) {
+            std::cerr << "[ERROR] " << entry.name << " counted " << result.hits << " hits, expected " << entry.expected
+                      << "\n";
+            ok = false;
+        }
+        ResultLog::global().add(entry.name, 1, repeated.runs);
+    }
+    return ok;
+}
+
+/**
+ * @brief Runs the microbenchmark CLI.
+ * @param argc Number of CLI arguments
+ * @param argv Array of CLI argument strings
+ * @return 0 on success, non-zero on invalid arguments or a checksum mismatch
+ */
+int run_cli(int argc, char* argv[]) {
+    std::int64_t operations = 10'000'000;
+    std::string filter;
+    std::string buffer;
+    std::string arrowOut;
+    std::string batchId;
+    bool counters = false;
+    bool list = false;
+
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        // Accepts both `--name value` and `--name=value`
+        auto option = [&](const std::string& name, std::string& value) { return takeOption(argc, argv, i, name, value); };
+
+        std::string value;
+        if (arg == "--list") {
+            list = true;
+        } else if (arg == "--counters") {
+            counters = true;
+        } else if (option("--filter", filter) || option("--buffer", buffer) || option("--arrow-out", arrowOut) ||
+                   option("--batch-id", batchId)) {
+            continue;
+        } else if (option("--warmup", value) || option("--reps", value)) {
+            if (!applyRepeatCount(arg.rfind("--warmup", 0) == 0, value)) return EXIT_FAILURE;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "[ERROR] Unknown option or missing value: " << arg << "\n";
+            return EXIT_FAILURE;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() > 1) {
+        std::cerr << "[ERROR] Unexpected argument: " << positional[1] << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!positional.empty() && !parseTrialCount(positional[0], operations, std::int64_t{1} << 62)) {
+        std::cerr << "[ERROR] Invalid operation count: " << positional[0] << "\n";
+        std::cerr << "Expected a positive integer, e.g. 10000000 or 1e8\n";
+        return EXIT_FAILURE;
+    }
+    operations = (operations + kMicroStep - 1) / kMicroStep * kMicroStep;
+
+    if (!buffer.empty() && !applyBufferTrials(buffer)) return EXIT_FAILURE;
+
+    auto darts = std::make_shared<MicroDarts>(BufferConfig::global().trials);
+    std::vector<MicroBenchmark> cases;
+    for (auto group : {rngMicroBenchmarks(operations), allocMicroBenchmarks(operations),
+                       countMicroBenchmarks(operations, darts)}) {
+        for (MicroBenchmark& entry : group) {
+            if (entry.name.find(filter) != std::string::npos) cases.push_back(std::move(entry));
+        }
+    }
+
+    if (list) {
+        for (const MicroBenchmark& entry : cases) std::cout << entry.name << "\n";
+        return 0;
+    }
+    if (cases.empty()) {
+        std::cerr << "[ERROR] No microbenchmark matches --filter " << filter << " (see --list)\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "[INFO] Microbenchmarks: " << cases.size() << " cases, " << operations << " operations each, "
+              << "count buffer " << darts->size << " darts (" << (darts->size * 2 * sizeof(double)) / 1024
+              << " KiB x/y SoA)\n";
+    if (RepeatConfig::global().repetitions > 1 || RepeatConfig::global().warmup > 0) {
+        std::cout << "[INFO] Repetitions: " << RepeatConfig::global().repetitions << " timed, "
+                  << RepeatConfig::global().warmup << " warmup per case\n";
+    }
+    if (counters) PerfCounters::global().enable();
+    if (!arrowOut.empty()) {
+        if (batchId.empty()) batchId = randomBatchId();
+        // Cases name their own ISA, and nothing here is pinned
+        RunInfo info = RunInfo::capture();
+        info.pinning = "none";
+        ResultLog::global().open(arrowOut, batchId, info);
+        std::cout << "[INFO] Arrow results: " << arrowOut << " (batch " << batchId << ")\n";
+    }
+
+    bool ok = run_micro_benchmarks(cases);
+    return ok && ResultLog::global().flush() ? 0 : EXIT_FAILURE;
+}
+
+/**
+ * @brief Entry point of the `microbench` target.
+ * @param argc Number of CLI arguments
+ * @param argv Array of CLI argument strings
+ * @return 0 on success, non-zero on failure
+ */
+int main(int argc, char* argv[]) {
+    try {
+        return run_cli(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
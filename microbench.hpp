@@ -0,0 +1,507 @@
+// ========================================
+// microbench.hpp - RNG, allocator and count-kernel microbenchmarks
+// ========================================
+/**
+ * @file microbench.hpp
+ * @brief Isolated costs behind the methods: generator throughput, allocation latency, hit counting.
+ *
+ * Each method changes several things at once (generator, allocation strategy, scalar vs SIMD
+ * compare), so a difference between two methods in the dashboards does not say which part caused
+ * it. The `microbench` target times each ingredient on its own, on the calling thread:
+ *
+ * - `RNG`, per [0, 1) double: `default_random_engine`, `mt19937` and `mt19937_64` through
+ *   `uniform_real_distribution`; `SplitMix64`; `Philox4x32`; xoshiro256+ scalar, AVX2, AVX-512, NEON
+ * - `Alloc`, per 64-byte object: `new`/`delete`, `malloc`/`free`, `new` in batches, `PoolAllocator`
+ * - `Count`, per dart: `isInsideCircle` and every `countInsideCircle_*` kernel on pre-filled SoA buffers
+ *
+ * ---
+ *
+ * ## Measurement
+ * Every case is one `measure()` call over N operations (argv[1]), so `--reps` / `--warmup`,
+ * `--counters` and `--arrow-out` behave as in `montecarlo`. Results sink into a checksum returned
+ * as `hits` (RNG: ⌊Σ draws⌋ ≈ N / 2; Alloc: low pointer bits; Count: hits), so nothing is elided.
+ *
+ * - **RNG:** generators keep their state across calls; scalar draws are summed into four
+ *   independent accumulators so the FP add chain never bounds the generator
+ * - **Alloc:** `new` / `malloc` free each object straight away (the heap's best case); the batched
+ *   `new` case and `PoolAllocator` both hold `kMicroAllocBatch` objects before releasing them all
+ *   (`delete` each vs one `reset()`), which is how the pool is used by the kernels
+ * - **Count:** the darts are drawn once into one `--buffer`-sized pair of buffers (float copies
+ *   for the `_F32` kernels) and counted pass after pass, so the RNG is excluded; the double
+ *   kernels must agree with `isInsideCircle` exactly
+ *
+ * ## Pipeline
+ * Rows go to the same Arrow stream as the benchmark runs, under `Method = Micro/<Group>/<Case>`;
+ * `Trials` is the operation count, so `Cycles/Trial` reads as cycles per draw / allocation / dart.
+ * `scripts/run_perf.sh micro=true` adds them to a batch.
+ */
+
+#pragma once
+
+#include "benchmark.hpp"
+#include "countstage.hpp"
+#include "montecarlo.hpp"
+#include "philox.hpp"
+#include "pool.hpp"
+#include "rng.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/// Bytes per allocation in the `Alloc` group (one cache line).
+constexpr std::size_t kMicroAllocBytes = 64;
+
+/// Objects held at once by the batched `Alloc` cases before they are released.
+constexpr std::int64_t kMicroAllocBatch = 1024;
+
+/// Operation counts are rounded up to a multiple of this, so vector generators draw whole steps.
+constexpr std::int64_t kMicroStep = 16;
+
+/// Seed of the generators and of the `Count` buffers, so checksums repeat between runs.
+constexpr std::uint64_t kMicroSeed = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * @brief One microbenchmark case.
+ */
+struct MicroBenchmark {
+    std::string name;                     ///< `Micro/<Group>/<Case>`, the logged `Method`
+    std::string unit;                     ///< What one operation is ("double", "alloc", "dart")
+    std::int64_t operations;              ///< Operations per call (`Trials` column)
+    std::function<std::int64_t()> run;    ///< Runs the configured operation count, returns the checksum
+    std::int64_t expected = -1;           ///< Checksum the case must return (-1 = not checked)
+};
+
+/**
+ * @brief Sums `count` draws into four independent accumulators.
+ * @param count Draws
+ * @param draw  Returns one double per call
+ * @return ⌊Σ draws⌋
+ */
+template <typename Draw>
+inline std::int64_t sumDraws(std::int64_t count, Draw&& draw) {
+    double sum[4] = {};
+    std::int64_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int k = 0; k < 4; ++k) sum[k] += draw();
+    }
+    for (; i < count; ++i) sum[0] += draw();
+    return static_cast<std::int64_t>((sum[0] + sum[1]) + (sum[2] + sum[3]));
+}
+
+/**
+ * @brief `<random>` engine behind `uniform_real_distribution`, as in the `Sequential` … `SIMD` kernels.
+ * @tparam Engine Standard engine
+ * @param count Doubles to draw
+ * @return Benchmark body keeping the engine across calls
+ */
+template <typename Engine>
+inline std::function<std::int64_t()> stdEngineDraws(std::int64_t count) {
+    auto engine = std::make_shared<Engine>(static_cast<typename Engine::result_type>(kMicroSeed));
+    return [engine, count]() {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        return sumDraws(count, [&]() { return dist(*engine); });
+    };
+}
+
+#ifdef USE_AVX
+/**
+ * @brief xoshiro256+ AVX2 draws, 4 per step. Only call when `cpuSupportsAVX2()` is true.
+ * @param rng   Generator
+ * @param count Doubles to draw (a multiple of `kMicroStep`)
+ * @return ⌊Σ draws⌋
+ */
+MC_TARGET_AVX2 inline std::int64_t xoshiroDraws_AVX2(Xoshiro256PlusAVX& rng, std::int64_t count) {
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    for (std::int64_t i = 0; i + 8 <= count; i += 8) {
+        sum0 = _mm256_add_pd(sum0, rng.nextDouble());
+        sum1 = _mm256_add_pd(sum1, rng.nextDouble());
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(sum0, sum1));
+    return static_cast<std::int64_t>((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]));
+}
+#endif
+
+#ifdef USE_AVX512
+/**
+ * @brief xoshiro256+ AVX-512 draws, 8 per step. Only call when `cpuSupportsAVX512()` is true.
+ * @param rng   Generator
+ * @param count Doubles to draw (a multiple of `kMicroStep`)
+ * @return ⌊Σ draws⌋
+ */
+MC_TARGET_AVX512 inline std::int64_t xoshiroDraws_AVX512(Xoshiro256PlusAVX512& rng, std::int64_t count) {
+    __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+    for (std::int64_t i = 0; i + 16 <= count; i += 16) {
+        sum0 = _mm512_add_pd(sum0, rng.nextDouble());
+        sum1 = _mm512_add_pd(sum1, rng.nextDouble());
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, _mm512_add_pd(sum0, sum1));
+    double total = 0.0;
+    for (double lane : lanes) total += lane;
+    return static_cast<std::int64_t>(total);
+}
+#endif
+
+#ifdef USE_NEON
+/**
+ * @brief xoshiro256+ NEON draws, 2 per step.
+ * @param rng   Generator
+ * @param count Doubles to draw (a multiple of `kMicroStep`)
+ * @return ⌊Σ draws⌋
+ */
+inline std::int64_t xoshiroDraws_NEON(Xoshiro256PlusNEON& rng, std::int64_t count) {
+    float64x2_t sum0 = vdupq_n_f64(0.0), sum1 = vdupq_n_f64(0.0);
+    for (std::int64_t i = 0; i + 4 <= count; i += 4) {
+        sum0 = vaddq_f64(sum0, rng.nextDouble());
+        sum1 = vaddq_f64(sum1, rng.nextDouble());
+    }
+    return static_cast<std::int64_t>(vaddvq_f64(vaddq_f64(sum0, sum1)));
+}
+#endif
+
+/**
+ * @brief `RNG` group: every generator the methods use, one double per operation.
+ * @param count Doubles per call (multiple of `kMicroStep`)
+ * @return Cases for the generators this CPU can run
+ */
+inline std::vector<MicroBenchmark> rngMicroBenchmarks(std::int64_t count) {
+    std::vector<MicroBenchmark> cases;
+    cases.push_back({"Micro/RNG/default_random_engine", "double", count, stdEngineDraws<std::default_random_engine>(count)});
+    cases.push_back({"Micro/RNG/mt19937", "double", count, stdEngineDraws<std::mt19937>(count)});
+    cases.push_back({"Micro/RNG/mt19937_64", "double", count, stdEngineDraws<std::mt19937_64>(count)});
+
+    auto splitMix = std::make_shared<SplitMix64>(SplitMix64{kMicroSeed});
+    cases.push_back({"Micro/RNG/SplitMix64", "double", count, [splitMix, count]() {
+        return sumDraws(count, [&]() { return static_cast<double>(splitMix->next() >> 11) * 0x1.0p-53; });
+    }});
+
+    // Two 53-bit doubles per block, as the GPU kernel draws them
+    auto philoxCounter = std::make_shared<std::uint64_t>(0);
+    cases.push_back({"Micro/RNG/Philox4x32", "double", count, [philoxCounter, count]() {
+        const PhiloxKey key{static_cast<std::uint32_t>(kMicroSeed), static_cast<std::uint32_t>(kMicroSeed >> 32)};
+        PhiloxCounter block{};
+        int word = 4;
+        return sumDraws(count, [&]() {
+            if (word == 4) {
+                std::uint64_t index = (*philoxCounter)++;
+                block = philox4x32({static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32), 0u, 0u}, key);
+                word = 0;
+            }
+            std::uint64_t bits = (static_cast<std::uint64_t>(block[word]) << 21) | (block[word + 1] >> 11);
+            word += 2;
+            return static_cast<double>(bits) * 0x1.0p-53;
+        });
+    }});
+
+    SplitMix64 seeder{kMicroSeed};
+    auto xoshiro = std::make_shared<Xoshiro256Plus>(seeder);
+    cases.push_back({"Micro/RNG/Xoshiro256Plus", "double", count, [xoshiro, count]() {
+        return sumDraws(count, [&]() { return xoshiro->nextDouble(); });
+    }});
+#ifdef USE_AVX
+    if (cpuSupportsAVX2()) {
+        auto rng = std::make_shared<Xoshiro256PlusAVX>(seeder);
+        cases.push_back({"Micro/RNG/Xoshiro256PlusAVX2", "double", count,
+                         [rng, count]() { return xoshiroDraws_AVX2(*rng, count); }});
+    }
+#endif
+#ifdef USE_AVX512
+    if (cpuSupportsAVX512()) {
+        auto rng = std::make_shared<Xoshiro256PlusAVX512>(seeder);
+        cases.push_back({"Micro/RNG/Xoshiro256PlusAVX512", "double", count,
+                         [rng, count]() { return xoshiroDraws_AVX512(*rng, count); }});
+    }
+#endif
+#ifdef USE_NEON
+    if (cpuSupportsNEON()) {
+        auto rng = std::make_shared<Xoshiro256PlusNEON>(seeder);
+        cases.push_back({"Micro/RNG/Xoshiro256PlusNEON", "double", count,
+                         [rng, count]() { return xoshiroDraws_NEON(*rng, count); }});
+    }
+#endif
+    return cases;
+}
+
+/**
+ * @brief `Alloc` group: heap vs `PoolAllocator` for one 64-byte object per operation.
+ * @param count Allocations per call
+ * @return Cases
+ */
+inline std::vector<MicroBenchmark> allocMicroBenchmarks(std::int64_t count) {
+    std::vector<MicroBenchmark> cases;
+
+    // Each object is touched and its address kept live, so the compiler cannot drop the pair
+    cases.push_back({"Micro/Alloc/new_delete", "alloc", count, [count]() {
+        std::int64_t checksum = 0;
+        for (std::int64_t i = 0; i < count; ++i) {
+            unsigned char* object = new unsigned char[kMicroAllocBytes];
+            object[0] = static_cast<unsigned char>(i);
+            doNotOptimize(object);
+            checksum += static_cast<std::int64_t>(reinterpret_cast<std::uintptr_t>(object) & 0xFF);
+            delete[] object;
+        }
+        return checksum;
+    }});
+
+    cases.push_back({"Micro/Alloc/malloc_free", "alloc", count, [count]() {
+        std::int64_t checksum = 0;
+        for (std::int64_t i = 0; i < count; ++i) {
+            unsigned char* object = static_cast<unsigned char*>(std::malloc(kMicroAllocBytes));
+            object[0] = static_cast<unsigned char>(i);
+            doNotOptimize(object);
+            checksum += static_cast<std::int64_t>(reinterpret_cast<std::uintptr_t>(object) & 0xFF);
+            std::free(object);
+        }
+        return checksum;
+    }});
+
+    cases.push_back({"Micro/Alloc/new_batch", "alloc", count, [count]() {
+        std::vector<unsigned char*> held(static_cast<std::size_t>(kMicroAllocBatch));
+        std::int64_t checksum = 0;
+        for (std::int64_t done = 0; done < count;) {
+            std::int64_t batch = std::min(kMicroAllocBatch, count - done);
+            for (std::int64_t i = 0; i < batch; ++i) {
+                unsigned char* object = new unsigned char[kMicroAllocBytes];
+                object[0] = static_cast<unsigned char>(i);
+                doNotOptimize(object);
+                checksum += static_cast<std::int64_t>(reinterpret_cast<std::uintptr_t>(object) & 0xFF);
+                held[static_cast<std::size_t>(i)] = object;
+            }
+            for (std::int64_t i = 0; i < batch; ++i) delete[] held[static_cast<std::size_t>(i)];
+            done += batch;
+        }
+        return checksum;
+    }});
+
+    auto pool = std::make_shared<PoolAllocator>(static_cast<std::size_t>(kMicroAllocBatch) * kMicroAllocBytes + 4096);
+    cases.push_back({"Micro/Alloc/PoolAllocator", "alloc", count, [pool, count]() {
+        std::int64_t checksum = 0;
+        for (std::int64_t done = 0; done < count;) {
+            std::int64_t batch = std::min(kMicroAllocBatch, count - done);
+            pool->reset();
+            for (std::int64_t i = 0; i < batch; ++i) {
+                unsigned char* object = static_cast<unsigned char*>(pool->allocateBytes(kMicroAllocBytes, 64));
+                if (!object) throw PoolExhausted();
+                object[0] = static_cast<unsigned char>(i);
+                doNotOptimize(object);
+                checksum += static_cast<std::int64_t>(reinterpret_cast<std::uintptr_t>(object) & 0xFF);
+            }
+            done += batch;
+        }
+        return checksum;
+    }});
+    return cases;
+}
+
+#ifdef USE_AVX
+/**
+ * @brief `countInsideCircle_AVX_F32` over float buffers. Only call when `cpuSupportsAVX2()` is true.
+ * @param x Buffer of x coordinates (32-byte aligned)
+ * @param y Buffer of y coordinates (32-byte aligned)
+ * @param n Darts to count (multiple of 8)
+ * @return Hits inside the circle
+ */
+MC_TARGET_AVX2 inline std::int64_t countHits_AVX2_F32(const float* x, const float* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 8 <= n; i += 8) hits += countInsideCircle_AVX_F32(_mm256_load_ps(x + i), _mm256_load_ps(y + i));
+    return hits;
+}
+
+/**
+ * @brief `countInsideCircleGuarded_AVX_F32` over float buffers. Only call when `cpuSupportsAVX2()` is true.
+ * @param x Buffer of x coordinates (32-byte aligned)
+ * @param y Buffer of y coordinates (32-byte aligned)
+ * @param n Darts to count (multiple of 8)
+ * @return Hits inside the circle
+ */
+MC_TARGET_AVX2 inline std::int64_t countHitsGuarded_AVX2_F32(const float* x, const float* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 8 <= n; i += 8) {
+        hits += countInsideCircleGuarded_AVX_F32(_mm256_load_ps(x + i), _mm256_load_ps(y + i));
+    }
+    return hits;
+}
+#endif
+
+#ifdef USE_AVX512
+/**
+ * @brief `countInsideCircle_AVX512` over double buffers. Only call when `cpuSupportsAVX512()` is true.
+ * @param x Buffer of x coordinates (64-byte aligned)
+ * @param y Buffer of y coordinates (64-byte aligned)
+ * @param n Darts to count (multiple of 16)
+ * @return Hits inside the circle
+ */
+MC_TARGET_AVX512 inline std::int64_t countHits_AVX512(const double* x, const double* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 8 <= n; i += 8) hits += countInsideCircle_AVX512(_mm512_load_pd(x + i), _mm512_load_pd(y + i));
+    return hits;
+}
+
+/**
+ * @brief `countInsideCircle_AVX512_F32` over float buffers. Only call when `cpuSupportsAVX512()` is true.
+ * @param x Buffer of x coordinates (64-byte aligned)
+ * @param y Buffer of y coordinates (64-byte aligned)
+ * @param n Darts to count (multiple of 16)
+ * @return Hits inside the circle
+ */
+MC_TARGET_AVX512 inline std::int64_t countHits_AVX512_F32(const float* x, const float* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 16 <= n; i += 16) {
+        hits += countInsideCircle_AVX512_F32(_mm512_load_ps(x + i), _mm512_load_ps(y + i));
+    }
+    return hits;
+}
+
+/**
+ * @brief `countInsideCircleGuarded_AVX512_F32` over float buffers. Only call when `cpuSupportsAVX512()` is true.
+ * @param x Buffer of x coordinates (64-byte aligned)
+ * @param y Buffer of y coordinates (64-byte aligned)
+ * @param n Darts to count (multiple of 16)
+ * @return Hits inside the circle
+ */
+MC_TARGET_AVX512 inline std::int64_t countHitsGuarded_AVX512_F32(const float* x, const float* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 16 <= n; i += 16) {
+        hits += countInsideCircleGuarded_AVX512_F32(_mm512_load_ps(x + i), _mm512_load_ps(y + i));
+    }
+    return hits;
+}
+#endif
+
+#ifdef USE_NEON
+/**
+ * @brief `countInsideCircle_NEON` over double buffers.
+ * @param x Buffer of x coordinates
+ * @param y Buffer of y coordinates
+ * @param n Darts to count (multiple of 16)
+ * @return Hits inside the circle
+ */
+inline std::int64_t countHits_NEON(const double* x, const double* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 2 <= n; i += 2) hits += countInsideCircle_NEON(vld1q_f64(x + i), vld1q_f64(y + i));
+    return hits;
+}
+
+/**
+ * @brief `countInsideCircle_NEON_F32` over float buffers.
+ * @param x Buffer of x coordinates
+ * @param y Buffer of y coordinates
+ * @param n Darts to count (multiple of 16)
+ * @return Hits inside the circle
+ */
+inline std::int64_t countHits_NEON_F32(const float* x, const float* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 4 <= n; i += 4) hits += countInsideCircle_NEON_F32(vld1q_f32(x + i), vld1q_f32(y + i));
+    return hits;
+}
+
+/**
+ * @brief `countInsideCircleGuarded_NEON_F32` over float buffers.
+ * @param x Buffer of x coordinates
+ * @param y Buffer of y coordinates
+ * @param n Darts to count (multiple of 16)
+ * @return Hits inside the circle
+ */
+inline std::int64_t countHitsGuarded_NEON_F32(const float* x, const float* y, std::size_t n) {
+    std::int64_t hits = 0;
+    for (std::size_t i = 0; i + 4 <= n; i += 4) {
+        hits += countInsideCircleGuarded_NEON_F32(vld1q_f32(x + i), vld1q_f32(y + i));
+    }
+    return hits;
+}
+#endif
+
+/**
+ * @brief Pre-filled SoA darts shared by the `Count` cases.
+ */
+struct MicroDarts {
+    PoolAllocator pool;              ///< Owns the four buffers
+    std::size_t size = 0;            ///< Darts per buffer (multiple of 16)
+    double* x = nullptr;             ///< x coordinates
+    double* y = nullptr;             ///< y coordinates
+    float* xf = nullptr;             ///< x rounded to float, for the `_F32` kernels
+    float* yf = nullptr;             ///< y rounded to float
+
+    /**
+     * @brief Draws `darts` xoshiro256+ darts with `kMicroSeed`.
+     * @param darts Darts per buffer (rounded up to a multiple of 16)
+     */
+    explicit MicroDarts(std::size_t darts)
+        : pool(((darts + 15) / 16 * 16) * 2 * (sizeof(double) + sizeof(float)) + 512), size((darts + 15) / 16 * 16) {
+        x = pool.allocate_array<double>(size, 64);
+        y = pool.allocate_array<double>(size, 64);
+        xf = pool.allocate_array<float>(size, 64);
+        yf = pool.allocate_array<float>(size, 64);
+        if (!x || !y || !xf || !yf) throw PoolExhausted();
+
+        SplitMix64 seeder{kMicroSeed};
+        BufferedStagesScalar(seeder).fill(x, y, size);
+        for (std::size_t i = 0; i < size; ++i) {
+            xf[i] = static_cast<float>(x[i]);
+            yf[i] = static_cast<float>(y[i]);
+        }
+    }
+};
+
+/**
+ * @brief `Count` group: every hit-count kernel over the same pre-filled buffers, one dart per operation.
+ * @param count Darts per call (rounded up to whole buffer passes, reported in `operations`)
+ * @param darts Shared buffers
+ * @return Cases for the kernels this CPU can run, scalar reference first
+ */
+inline std::vector<MicroBenchmark> countMicroBenchmarks(std::int64_t count, const std::shared_ptr<MicroDarts>& darts) {
+    const std::int64_t size = static_cast<std::int64_t>(darts->size);
+    const std::int64_t passes = (count + size - 1) / size;
+    const std::int64_t operations = passes * size;
+    auto f64 = [darts, passes](CountStageFn kernel) {
+        return [darts, passes, kernel]() {
+            std::int64_t hits = 0;
+            for (std::int64_t pass = 0; pass < passes; ++pass) {
+                hits += kernel(darts->x, darts->y, darts->size);
+                doNotOptimize(hits);
+            }
+            return hits;
+        };
+    };
+    auto f32 = [darts, passes](std::int64_t (*kernel)(const float*, const float*, std::size_t)) {
+        return [darts, passes, kernel]() {
+            std::int64_t hits = 0;
+            for (std::int64_t pass = 0; pass < passes; ++pass) {
+                hits += kernel(darts->xf, darts->yf, darts->size);
+                doNotOptimize(hits);
+            }
+            return hits;
+        };
+    };
+    const std::int64_t expected = countHitsScalar(darts->x, darts->y, darts->size) * passes;
+
+    std::vector<MicroBenchmark> cases;
+    cases.push_back({"Micro/Count/Scalar", "dart", operations, f64(countHitsScalar), expected});
+#ifdef USE_AVX
+    if (cpuSupportsAVX2()) {
+        cases.push_back({"Micro/Count/AVX2", "dart", operations, f64(countHitsMovemask_AVX2), expected});
+        cases.push_back({"Micro/Count/AVX2_F32", "dart", operations, f32(countHits_AVX2_F32)});
+        cases.push_back({"Micro/Count/AVX2_F32Guard", "dart", operations, f32(countHitsGuarded_AVX2_F32)});
+    }
+#endif
+#ifdef USE_AVX512
+    if (cpuSupportsAVX512()) {
+        cases.push_back({"Micro/Count/AVX512", "dart", operations, f64(countHits_AVX512), expected});
+        cases.push_back({"Micro/Count/AVX512_F32", "dart", operations, f32(countHits_AVX512_F32)});
+        cases.push_back({"Micro/Count/AVX512_F32Guard", "dart", operations, f32(countHitsGuarded_AVX512_F32)});
+    }
+#endif
+#ifdef USE_NEON
+    if (cpuSupportsNEON()) {
+        cases.push_back({"Micro/Count/NEON", "dart", operations, f64(countHits_NEON), expected});
+        cases.push_back({"Micro/Count/NEON_F32", "dart", operations, f32(countHits_NEON_F32)});
+        cases.push_back({"Micro/Count/NEON_F32Guard", "dart", operations, f32(countHitsGuarded_NEON_F32)});
+    }
+#endif
+    return cases;
+}
@@ -15,10 +15,21 @@
  * ---
  *
  * ## Implemented Methods
- * - `monteCarloPI_SEQUENTIAl(int)` — Scalar loop, stack-allocated
- * - `monteCarloPI_HEAP(int)`       — Threaded with `new` per-thread
- * - `monteCarloPI_POOL(int)`       — Threaded with thread-local bump allocator
- * - `monteCarloPI_SIMD(int)`       — Fully vectorized (AVX2 or NEON) using pooled memory
+ * - `monteCarloPI_SEQUENTIAl(int64_t)` — Scalar loop, stack-allocated
+ * - `monteCarloPI_HEAP(int64_t)`       — Threaded with `new` per-thread
+ * - `monteCarloPI_POOL(int64_t)`       — Threaded with thread-local bump allocator
+ * - `SimdMtKernels<Ops>::run<Unroll, Buffer>(int64_t)` — Fully vectorized using pooled memory, fed by
+ *   `std::mt19937_64`; one instantiation per (ISA, unroll, buffer), picked by `autotune.hpp`
+ * - `monteCarloPI_SIMD_XOSHIRO_<ISA>(int64_t)` — Vectorized kernel fed by an in-register xoshiro256+ PRNG
+ *   (the quarter disc `UnitBall<2>` on the generic engine in `integrand.hpp`)
+ *
+ * - `monteCarloPI_SIMD_F32_<ISA><Guard>(int64_t)` — float32 variant with twice the lanes, optional double re-check
+ *
+ * `<ISA>` is one of `SCALAR`, `AVX2`, `AVX512`, or `NEON`. All variants compiled for the target
+ * architecture end up in the same binary; `dispatch.hpp` picks one at startup and exposes
+ * `monteCarloPI_SIMD(int64_t)` / `monteCarloPI_SIMD_XOSHIRO(int64_t)` as the public entry points.
+ *
+ * Trial and hit counts are 64-bit (`std::int64_t`), so runs of 1e11+ trials don't overflow.
  *
  * ---
  *
@@ -46,6 +57,12 @@
  * - Compare lanes to `1.0`, extract 4-bit result mask with `_mm256_movemask_pd`
  * - Use `__builtin_popcount()` to count how many darts landed inside the circle
  *
+ * #### AVX-512 (x86, Sapphire Rapids / Zen 4)
+ * - **512-bit registers** → 8 lanes of 64-bit doubles
+ * - `_mm512_cmp_pd_mask` writes the compare straight into a `__mmask8` register
+ * - The mask is popcounted directly — no `movemask` transfer step
+ * - Selected at runtime by `dispatch.hpp` when CPUID reports AVX-512F
+ *
  * #### NEON (ARM64)
  * - **128-bit registers** → 2 doubles per iteration
  * - Uses `vcleq_f64`, `vmulq_f64`, and `vgetq_lane_u64` for hit counting
@@ -68,12 +85,26 @@
  * - No need for conditional vector masking
  * - Simpler logic
  *
+ * ### 4. Float32 / Mixed Precision
+ * For a unit-circle test, float32 resolution (2⁻²⁴ near 1.0) is enough for most estimation
+ * workloads, and it doubles the lane count: 8 lanes on AVX2, 16 on AVX-512, 4 on NEON.
+ *
+ * The guarded variant (`Guard = true`) also flags lanes whose float `x² + y²` lies within
+ * `kF32GuardBand` of 1.0 and re-evaluates just those in double precision. Because float inputs
+ * are exactly representable in double, the guarded result matches a double-precision test on
+ * the same samples; the re-check branch is almost never taken, so it stays predictable.
+ *
+ * ### 5. 64-bit Counts, 32-bit Hot Loops
+ * Trial and hit counts are `int64_t`, but the vector loops accumulate into a `uint32_t` within
+ * blocks of `kHitBlockTrials` (2³⁰) trials and widen into the 64-bit total once per block.
+ * The per-iteration add stays 32-bit and the block loop's trip count fits a 32-bit counter.
+ *
  * ---
  *
  * ## Memory Allocation Models
  *
  * ### Heap Allocation (`monteCarloPI_HEAP`)
- * - Allocates result with `new int` per thread
+ * - Allocates result with `new std::int64_t` per call
  * - Easy but slow: system allocator adds metadata + bookkeeping
  * - Poor memory reuse in tight, repeated simulations
  *
@@ -109,12 +140,13 @@
  * ---
  *
  * ## Threading Strategy
- * - 4 threads are launched per simulation
- * - Each uses:
+ * - Threaded methods run on a persistent `ThreadPool` (see `threadpool.hpp`), created once
+ * - Trials are split into chunks; idle workers steal chunks from busy ones
+ * - Each worker uses:
  *   - A thread-local RNG (`std::mt19937_64`)
  *   - Its own memory allocator (heap or pool)
- * - Final hit counts are summed after join
- * - This avoids synchronization and false sharing
+ * - Each function call here processes one chunk; hit counts are summed per worker, then per run
+ * - This avoids synchronization on the hot path and false sharing
  *
  * ---
  *
@@ -127,6 +159,9 @@
  * - Each thread uses its own instance of `std::mt19937_64`
  * - Declared as `thread_local`, so there's **no sharing or locking**
  * - Ensures deterministic randomness per-thread (no race conditions)
+ * - Every kernel seeds through `chunkSeed()`: fresh entropy by default, or the chunk's Philox
+ *   stream under `--seed` (see `philox.hpp`), where `mt19937_64` engines are reseeded per chunk
+ *   so the run's result no longer depends on which thread ran which chunk
  *
  * ### 2. Thread-Local Memory Allocator
  * - `monteCarloPI_POOL` and `monteCarloPI_SIMD` use a `thread_local PoolAllocator`
@@ -134,13 +169,14 @@
  * - Memory is preallocated and reused via `reset()`, which is also thread-local
  *
  * ### 3. No Shared Writes
- * - Each thread returns its own hit count (via `int*`)
- * - Main thread aggregates totals **after** all threads join
+ * - Hot loops count hits in registers; each kernel writes its pool-allocated counter once
+ * - Each chunk returns its own hit count (via `int64_t*`), read by the worker that ran it
+ * - Workers publish one total each into an `alignas(64)` result slot when the run completes
  * - There are **no atomic variables, no critical sections, and no false sharing**
  *
  * ### 4. Minimal Cache Line Interference
- * - Because hit counts are per-thread, there's no contention on shared cache lines
- * - Memory is aligned (64 bytes in PoolAllocator) to avoid CPU cache thrashing
+ * - Hit counters are allocated with 64-byte alignment, one cache line per counter
+ * - `falsesharing.hpp` measures what this avoids: `PackedSlots` vs `PaddedSlots`
  *
  * ---
  *
@@ -156,15 +192,17 @@
  * | Heap      | new/delete        | ✅       | ❌    | Easy but slower, allocates per thread                  |
  * | Pool      | PoolAllocator     | ✅       | ❌    | Fast pointer bumping, reused memory, no malloc         |
  * | SIMD      | PoolAllocator     | ✅       | ✅    | Fully vectorized with aligned memory + memory pooling  |
+ * | SIMDXoshiro | PoolAllocator   | ✅       | ✅    | SIMD kernel + SIMD PRNG, no scalar RNG or buffer copy  |
  *
  * ---
  *
  * ## Requirements
  * - **C++17**: For `aligned_alloc`, `thread_local`, and uniform initialization
  * - **SIMD Backend:**
- *   - AVX2: Define `-DUSE_AVX` when compiling
+ *   - AVX2 / AVX-512: Define `-DUSE_AVX` when compiling (CMake does this on x86); kernels are built
+ *     with per-function target attributes, so no `-mavx2` / `-mavx512f` is needed
  *   - NEON: Auto-enabled via `__ARM_NEON` macro on ARM CPUs
- * - Compilation will fail if no SIMD backend is present
+ * - Without any SIMD backend, only the scalar kernels are built
  *
  * ---
  *
@@ -181,21 +219,20 @@
 #pragma once
 
 #include "pool.hpp"
+#include "simd.hpp"
+#include "rng.hpp"
+#include "philox.hpp"
+#include "integrand.hpp"
+#include "trace.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <random>
 #include <thread>
 #include <memory>
 
-#if defined(USE_AVX)
-    #include <immintrin.h>
-#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
-    #define USE_NEON
-    #include <arm_neon.h>
-#else
-    #error "No SIMD instruction set supported. Compile with USE_AVX or USE_NEON"
-#endif
-
 /**
  * @brief Checks if a 2D point lies inside the unit circle.
  * 
@@ -207,6 +244,33 @@ inline bool isInsideCircle(double x, double y) {
   return (x*x + y*y) <= 1.0;
 }
 
+/**
+ * @brief Half-width of the |x² + y² − 1| band that guarded float32 kernels re-check in double.
+ *
+ * Float32 `x*x + y*y` near 1.0 is off by at most a few 1e-7; 1e-6 covers that with margin.
+ */
+constexpr float kF32GuardBand = 1e-6f;
+
+/**
+ * @brief Re-evaluates borderline float32 lanes in double precision.
+ *
+ * @param x Lane X-coordinates
+ * @param y Lane Y-coordinates
+ * @param border Bitmask of lanes inside the guard band
+ * @param inside Bitmask of lanes the float32 compare counted as hits
+ * @return Correction to add to the float32 hit count
+ */
+inline int refineBorderline_F32(const float* x, const float* y, unsigned border, unsigned inside) {
+    int correction = 0;
+    while (border) {
+        int lane = __builtin_ctz(border);
+        border &= border - 1;
+        bool exact = isInsideCircle(static_cast<double>(x[lane]), static_cast<double>(y[lane]));
+        correction += static_cast<int>(exact) - static_cast<int>((inside >> lane) & 1u);
+    }
+    return correction;
+}
+
 #ifdef USE_AVX
 /**
  * @brief AVX2-specific function that counts how many points in a 4-element SIMD batch lie inside the unit circle.
@@ -214,7 +278,7 @@ inline bool isInsideCircle(double x, double y) {
  * @param y Packed SIMD Y-coordinates
  * @return Number of hits inside the circle [0–4]
  */
-inline int countInsideCircle_AVX(__m256d x, __m256d y) {
+MC_TARGET_AVX2 inline int countInsideCircle_AVX(__m256d x, __m256d y) {
     __m256d x2 = _mm256_mul_pd(x, x);
     __m256d y2 = _mm256_mul_pd(y, y);
     __m256d dist2 = _mm256_add_pd(x2, y2);
@@ -222,6 +286,99 @@ inline int countInsideCircle_AVX(__m256d x, __m256d y) {
     __m256d cmp = _mm256_cmp_pd(dist2, ones, _CMP_LE_OQ);
     return __builtin_popcount(_mm256_movemask_pd(cmp));
 }
+
+/**
+ * @brief AVX2 float32 hit count over an 8-element batch.
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @return Number of hits inside the circle [0–8]
+ */
+MC_TARGET_AVX2 inline int countInsideCircle_AVX_F32(__m256 x, __m256 y) {
+    __m256 dist2 = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+    __m256 cmp = _mm256_cmp_ps(dist2, _mm256_set1_ps(1.0f), _CMP_LE_OQ);
+    return __builtin_popcount(_mm256_movemask_ps(cmp));
+}
+
+/**
+ * @brief AVX2 float32 hit count that re-checks lanes near the circle boundary in double.
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @return Number of hits inside the circle [0–8]
+ */
+MC_TARGET_AVX2 inline int countInsideCircleGuarded_AVX_F32(__m256 x, __m256 y) {
+    const __m256 ones = _mm256_set1_ps(1.0f);
+    __m256 dist2 = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+    __m256 gap = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(dist2, ones));
+
+    unsigned inside = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(dist2, ones, _CMP_LE_OQ)));
+    unsigned border = static_cast<unsigned>(_mm256_movemask_ps(
+        _mm256_cmp_ps(gap, _mm256_set1_ps(kF32GuardBand), _CMP_LE_OQ)));
+
+    int count = __builtin_popcount(inside);
+    if (border) {
+        alignas(32) float laneX[8], laneY[8];
+        _mm256_store_ps(laneX, x);
+        _mm256_store_ps(laneY, y);
+        count += refineBorderline_F32(laneX, laneY, border, inside);
+    }
+    return count;
+}
+#endif
+
+#ifdef USE_AVX512
+/**
+ * @brief AVX-512-specific function that counts how many points in an 8-element SIMD batch lie inside the unit circle.
+ *
+ * The compare writes directly into a `__mmask8`, which is popcounted without a movemask step.
+ *
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @param active Lanes to include in the count (default: all 8)
+ * @return Number of hits inside the circle [0–8]
+ */
+MC_TARGET_AVX512 inline int countInsideCircle_AVX512(__m512d x, __m512d y, __mmask8 active = 0xFF) {
+    __m512d dist2 = _mm512_fmadd_pd(x, x, _mm512_mul_pd(y, y));
+    __mmask8 inside = _mm512_mask_cmp_pd_mask(active, dist2, _mm512_set1_pd(1.0), _CMP_LE_OQ);
+    return __builtin_popcount(static_cast<unsigned>(inside));
+}
+
+/**
+ * @brief AVX-512 float32 hit count over a 16-element batch.
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @param active Lanes to include in the count (default: all 16)
+ * @return Number of hits inside the circle [0–16]
+ */
+MC_TARGET_AVX512 inline int countInsideCircle_AVX512_F32(__m512 x, __m512 y, __mmask16 active = 0xFFFF) {
+    __m512 dist2 = _mm512_fmadd_ps(x, x, _mm512_mul_ps(y, y));
+    __mmask16 inside = _mm512_mask_cmp_ps_mask(active, dist2, _mm512_set1_ps(1.0f), _CMP_LE_OQ);
+    return __builtin_popcount(static_cast<unsigned>(inside));
+}
+
+/**
+ * @brief AVX-512 float32 hit count that re-checks lanes near the circle boundary in double.
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @param active Lanes to include in the count (default: all 16)
+ * @return Number of hits inside the circle [0–16]
+ */
+MC_TARGET_AVX512 inline int countInsideCircleGuarded_AVX512_F32(__m512 x, __m512 y, __mmask16 active = 0xFFFF) {
+    const __m512 ones = _mm512_set1_ps(1.0f);
+    __m512 dist2 = _mm512_fmadd_ps(x, x, _mm512_mul_ps(y, y));
+    __m512 gap = _mm512_abs_ps(_mm512_sub_ps(dist2, ones));
+
+    __mmask16 inside = _mm512_mask_cmp_ps_mask(active, dist2, ones, _CMP_LE_OQ);
+    __mmask16 border = _mm512_mask_cmp_ps_mask(active, gap, _mm512_set1_ps(kF32GuardBand), _CMP_LE_OQ);
+
+    int count = __builtin_popcount(static_cast<unsigned>(inside));
+    if (border) {
+        alignas(64) float laneX[16], laneY[16];
+        _mm512_store_ps(laneX, x);
+        _mm512_store_ps(laneY, y);
+        count += refineBorderline_F32(laneX, laneY, border, inside);
+    }
+    return count;
+}
 #endif
 
 #ifdef USE_NEON
@@ -239,20 +396,86 @@ inline int countInsideCircle_NEON(float64x2_t x, float64x2_t y) {
     uint64x2_t cmp = vcleq_f64(dist2, ones);
     return static_cast<int>(vgetq_lane_u64(cmp, 0) != 0) + static_cast<int>(vgetq_lane_u64(cmp, 1) != 0);
 }
+
+/**
+ * @brief Packs a NEON 32-bit lane mask into a 4-bit integer mask.
+ * @param cmp All-ones / all-zeros lanes from a compare
+ * @return Bit i set when lane i is set
+ */
+inline unsigned laneMask_NEON(uint32x4_t cmp) {
+    const uint32_t weights[4] = {1, 2, 4, 8};
+    return vaddvq_u32(vandq_u32(cmp, vld1q_u32(weights)));
+}
+
+/**
+ * @brief NEON float32 hit count over a 4-element batch.
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @return Number of hits inside the circle [0–4]
+ */
+inline int countInsideCircle_NEON_F32(float32x4_t x, float32x4_t y) {
+    float32x4_t dist2 = vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y));
+    uint32x4_t cmp = vcleq_f32(dist2, vdupq_n_f32(1.0f));
+    return static_cast<int>(vaddvq_u32(vshrq_n_u32(cmp, 31)));
+}
+
+/**
+ * @brief NEON float32 hit count that re-checks lanes near the circle boundary in double.
+ * @param x Packed SIMD X-coordinates
+ * @param y Packed SIMD Y-coordinates
+ * @return Number of hits inside the circle [0–4]
+ */
+inline int countInsideCircleGuarded_NEON_F32(float32x4_t x, float32x4_t y) {
+    const float32x4_t ones = vdupq_n_f32(1.0f);
+    float32x4_t dist2 = vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y));
+
+    unsigned inside = laneMask_NEON(vcleq_f32(dist2, ones));
+    unsigned border = laneMask_NEON(vcleq_f32(vabsq_f32(vsubq_f32(dist2, ones)), vdupq_n_f32(kF32GuardBand)));
+
+    int count = __builtin_popcount(inside);
+    if (border) {
+        float laneX[4], laneY[4];
+        vst1q_f32(laneX, x);
+        vst1q_f32(laneY, y);
+        count += refineBorderline_F32(laneX, laneY, border, inside);
+    }
+    return count;
+}
 #endif
 
+/**
+ * @brief Draws a fresh 64-bit seed from `std::random_device`.
+ * @return Seed for a SplitMix64 stream
+ */
+inline std::uint64_t entropySeed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) | rd();
+}
+
+/**
+ * @brief Seed for the chunk being executed by the calling thread.
+ *
+ * Under a run seed (`--seed`) this is the Philox stream of the current chunk, so a chunk draws the
+ * same darts on any thread; otherwise it is fresh entropy.
+ *
+ * @return Seed for this call's generators
+ */
+inline std::uint64_t chunkSeed() {
+    const RunSeed& run = RunSeed::global();
+    return run.enabled ? philoxStreamSeed(run.value, RunSeed::currentChunk()) : entropySeed();
+}
+
 /**
  * @brief Estimates π using sequential dart throwing.
  * @param numberOfTrials Total number of darts to throw
  * @return Number of hits inside the circle
  */
-int monteCarloPI_SEQUENTIAl(int numberOfTrials) {
-    std::random_device rd {};
-    std::default_random_engine engine {rd()};
+std::int64_t monteCarloPI_SEQUENTIAl(std::int64_t numberOfTrials) {
+    std::default_random_engine engine {static_cast<std::default_random_engine::result_type>(chunkSeed())};
     std::uniform_real_distribution<double> darts{0.0, 1.0};
 
-    int hits = 0;
-    for (int i = 0; i < numberOfTrials; ++i) {
+    std::int64_t hits = 0;
+    for (std::int64_t i = 0; i < numberOfTrials; ++i) {
         double dartX = darts(engine);
         double dartY = darts(engine);
         if (isInsideCircle(dartX, dartY)) ++hits;
@@ -263,106 +486,441 @@ int monteCarloPI_SEQUENTIAl(int numberOfTrials) {
 /**
  * @brief Estimates π using heap-allocated result storage.
  * @param numberOfTrials Total number of darts to throw
- * @return Pointer to heap-allocated int storing hits inside the circle
+ * @return Pointer to heap-allocated counter storing hits inside the circle
  */
-inline int* monteCarloPI_HEAP(int numberOfTrials) {
-    std::random_device rd {};
-    std::default_random_engine engine {rd()};
+inline std::int64_t* monteCarloPI_HEAP(std::int64_t numberOfTrials) {
+    std::default_random_engine engine {static_cast<std::default_random_engine::result_type>(chunkSeed())};
     std::uniform_real_distribution<double> darts{0.0, 1.0};
 
-    int hits = 0;
-    for (int i = 0; i < numberOfTrials; ++i) {
+    std::int64_t hits = 0;
+    for (std::int64_t i = 0; i < numberOfTrials; ++i) {
         double dartX = darts(engine);
         double dartY = darts(engine);
         if (isInsideCircle(dartX, dartY)) ++hits;
     }
-    return new int{hits};
+    return new std::int64_t{hits};
 }
 
 /**
  * @brief Estimates π using a thread-local memory pool (bump allocator).
  * @param numberOfTrials Total number of darts to throw
- * @return Pointer to pool-allocated int storing hits inside the circle
+ * @return Pointer to pool-allocated counter storing hits inside the circle
  */
-inline int* monteCarloPI_POOL(int numberOfTrials) {
+inline std::int64_t* monteCarloPI_POOL(std::int64_t numberOfTrials) {
     thread_local PoolAllocator pool(64 * 1024);
-    pool.reset();
-
-    int* hits = pool.allocate<int>();
-    if (!hits) {
-        std::cerr << "[ERROR] PoolAllocator ran out of memory!\n";
-        std::exit(EXIT_FAILURE);
+    {
+        MC_TRACE_SCOPE("pool.reset");
+        pool.reset();
     }
+
+    std::int64_t* hits = pool.allocate<std::int64_t>(64);
+    if (!hits) throw PoolExhausted();
     *hits = 0;
 
-    std::random_device rd;
-    std::default_random_engine engine{rd()};
+    std::default_random_engine engine{static_cast<std::default_random_engine::result_type>(chunkSeed())};
     std::uniform_real_distribution<double> darts{0.0, 1.0};
 
-    for (int i = 0; i < numberOfTrials; ++i) {
+    // Count in a register; the pool slot is written once
+    std::int64_t count = 0;
+    for (std::int64_t i = 0; i < numberOfTrials; ++i) {
         double dartX = darts(engine);
         double dartY = darts(engine);
-        if (isInsideCircle(dartX, dartY)) ++(*hits);
+        if (isInsideCircle(dartX, dartY)) ++count;
     }
+
+    *hits = count;
     return hits;
 }
 
 /**
- * @brief Estimates π using SIMD acceleration (AVX2 or NEON) and pool-allocated result storage.
- * @param numberOfTrials Total number of darts to throw
- * @return Pointer to pool-allocated int storing hits inside the circle
+ * @brief Pool-allocates the per-call hit counter used by the SIMD method family.
+ *
+ * Each ISA variant keeps its own `thread_local` pool, so the pool is passed in.
+ *
+ * @param pool Thread-local pool owned by the calling kernel
+ * @return Pointer to a zero-initialized hit counter
+ * @throws PoolExhausted if the pool cannot grow
  */
-inline int* monteCarloPI_SIMD(int numberOfTrials) {
-    thread_local PoolAllocator pool(64 * 1024);
-    pool.reset();
-
-    int* hits = pool.allocate<int>();
-    if (!hits) {
-        std::cerr << "[ERROR] PoolAllocator ran out of memory!\n";
-        std::exit(EXIT_FAILURE);
+inline std::int64_t* allocateHitCounter(PoolAllocator& pool) {
+    {
+        MC_TRACE_SCOPE("pool.reset");
+        pool.reset();
     }
+
+    std::int64_t* hits = pool.allocate<std::int64_t>(64);
+    if (!hits) throw PoolExhausted();
     *hits = 0;
+    return hits;
+}
 
-    thread_local std::mt19937_64 engine(std::random_device{}());
+/**
+ * @brief `monteCarloPI_SIMD` hot loop for one ISA, staging-buffer length and unroll depth.
+ *
+ * Darts are drawn x, y, x, y, ... from `engine` into two `Buffer`-dart arrays, then counted
+ * `Unroll` vectors per step into independent counters, so consecutive compares do not serialize
+ * on one add. The draw order does not depend on `Unroll` or `Buffer`, so every instantiation —
+ * and every ISA — counts the same darts: hits under `--seed` are identical across the autotuned
+ * variants (`autotune.hpp`). The remainder below one vector runs through `isInsideCircle`.
+ *
+ * Call only through a target-attributed `SimdMtKernels<Ops>::run`, which flattens this loop.
+ *
+ * @tparam Ops    SIMD ops (`integrand.hpp`); `Ops::lanes` is the batch width
+ * @tparam Unroll Independent counters per step
+ * @tparam Buffer Darts staged per refill (multiple of `Ops::lanes * Unroll`)
+ * @param engine         Calling thread's generator
+ * @param numberOfTrials Darts to throw
+ * @return Darts inside the quarter circle
+ */
+template <typename Ops, int Unroll, int Buffer>
+inline std::int64_t simdMtHitsLoop(std::mt19937_64& engine, std::int64_t numberOfTrials) {
+    static_assert(Unroll >= 1 && Buffer % (Ops::lanes * Unroll) == 0, "Buffer must hold whole unrolled steps");
+    constexpr int lanes = Ops::lanes;
     std::uniform_real_distribution<double> dist(0.0, 1.0);
+    alignas(64) double randX[Buffer], randY[Buffer];
+    const typename Ops::Vec one = Ops::set1(1.0);
 
-    int batch;
-    int loopEnd;
-
-    #ifdef USE_AVX
-    batch = 4;
-    alignas(32) double randX[batch], randY[batch];
-    loopEnd = numberOfTrials - (numberOfTrials % batch);
-
-    for (int i = 0; i < loopEnd; i+= batch) {
-        for (int j = 0; j < batch; ++j) {
+    std::int64_t loopEnd = numberOfTrials - (numberOfTrials % lanes);
+    std::int64_t count = 0;
+    for (std::int64_t done = 0; done < loopEnd;) {
+        int darts = static_cast<int>(std::min<std::int64_t>(Buffer, loopEnd - done));
+        for (int j = 0; j < darts; ++j) {
             randX[j] = dist(engine);
             randY[j] = dist(engine);
         }
-        __m256d dartX = _mm256_load_pd(randX);
-        __m256d dartY = _mm256_load_pd(randY);
-        *hits += countInsideCircle_AVX(dartX, dartY);
-    }
-    #elif defined(USE_NEON)
-    batch = 2;
-    alignas(16) double randX[batch], randY[batch];
-    loopEnd = numberOfTrials - (numberOfTrials % batch);
 
-    for (int i = 0; i < loopEnd; i += batch) {
-        for (int j = 0; j < batch; ++j) {
-            randX[j] = dist(engine);
-            randY[j] = dist(engine);
+        int counts[Unroll] = {};
+        int j = 0;
+        for (; j + Unroll * lanes <= darts; j += Unroll * lanes) {
+            for (int u = 0; u < Unroll; ++u) {
+                typename Ops::Vec x = Ops::load(randX + j + u * lanes);
+                typename Ops::Vec y = Ops::load(randY + j + u * lanes);
+                counts[u] += Ops::countMask(Ops::lessEqual(Ops::fmadd(x, x, Ops::mul(y, y)), one));
+            }
+        }
+        for (; j < darts; j += lanes) {
+            typename Ops::Vec x = Ops::load(randX + j);
+            typename Ops::Vec y = Ops::load(randY + j);
+            counts[0] += Ops::countMask(Ops::lessEqual(Ops::fmadd(x, x, Ops::mul(y, y)), one));
         }
-        float64x2_t dartX = vld1q_f64(randX);
-        float64x2_t dartY = vld1q_f64(randY);
-        *hits += countInsideCircle_NEON(dartX, dartY);
+        for (int u = 0; u < Unroll; ++u) count += counts[u];
+        done += darts;
     }
-    #endif 
 
-    for (int i = loopEnd; i < numberOfTrials; ++i) {
+    for (std::int64_t i = loopEnd; i < numberOfTrials; ++i) {
         double dartX = dist(engine);
         double dartY = dist(engine);
-        if (isInsideCircle(dartX, dartY)) ++(*hits);
+        if (isInsideCircle(dartX, dartY)) ++count;
     }
+    return count;
+}
+
+/**
+ * @brief `monteCarloPI_SIMD` for one (ISA, unroll, buffer) configuration, without the ISA attribute.
+ * @tparam Ops    SIMD ops
+ * @tparam Unroll Independent counters per step
+ * @tparam Buffer Darts staged per refill
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <typename Ops, int Unroll, int Buffer>
+inline std::int64_t* simdMtKernel(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    thread_local std::mt19937_64 engine(std::random_device{}());
+    if (RunSeed::global().enabled) engine.seed(chunkSeed());
+
+    *hits = simdMtHitsLoop<Ops, Unroll, Buffer>(engine, numberOfTrials);
     return hits;
 }
+
+/**
+ * @brief `monteCarloPI_SIMD` instantiations of one ISA, each compiled for that ISA's target.
+ *
+ * Specialized per `Ops` (like `IntegrandEngine`) so `run` carries the matching `MC_TARGET_*`
+ * attribute and flattens the generic loop. Only call an ISA's `run` when its CPU check passes.
+ *
+ * @tparam Ops SIMD ops of the ISA
+ */
+template <typename Ops>
+struct SimdMtKernels;
+
+template <>
+struct SimdMtKernels<SimdOpsScalar> {
+    /// @brief Scalar fallback: one dart per "vector", no ISA extensions.
+    template <int Unroll, int Buffer>
+    MC_FLATTEN static std::int64_t* run(std::int64_t numberOfTrials) {
+        return simdMtKernel<SimdOpsScalar, Unroll, Buffer>(numberOfTrials);
+    }
+};
+
+#ifdef USE_AVX
+template <>
+struct SimdMtKernels<SimdOpsAVX2> {
+    /// @brief AVX2: 4 darts per compare, `movemask` + `popcount` per vector.
+    template <int Unroll, int Buffer>
+    MC_TARGET_AVX2 MC_FLATTEN static std::int64_t* run(std::int64_t numberOfTrials) {
+        return simdMtKernel<SimdOpsAVX2, Unroll, Buffer>(numberOfTrials);
+    }
+};
+#endif
+
+#ifdef USE_AVX512
+template <>
+struct SimdMtKernels<SimdOpsAVX512> {
+    /// @brief AVX-512: 8 darts per compare straight into a `__mmask8`.
+    template <int Unroll, int Buffer>
+    MC_TARGET_AVX512 MC_FLATTEN static std::int64_t* run(std::int64_t numberOfTrials) {
+        return simdMtKernel<SimdOpsAVX512, Unroll, Buffer>(numberOfTrials);
+    }
+};
+#endif
+
+#ifdef USE_NEON
+template <>
+struct SimdMtKernels<SimdOpsNEON> {
+    /// @brief NEON: 2 darts per compare.
+    template <int Unroll, int Buffer>
+    MC_FLATTEN static std::int64_t* run(std::int64_t numberOfTrials) {
+        return simdMtKernel<SimdOpsNEON, Unroll, Buffer>(numberOfTrials);
+    }
+};
+#endif
+
+/**
+ * @brief Scalar fallback for `monteCarloPI_SIMD_XOSHIRO` — one xoshiro256+ stream per axis.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD_XOSHIRO_SCALAR(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    *hits = IntegrandEngine<SimdOpsScalar>::countRegionHits<UnitBall<2>>(seeder, numberOfTrials);
+    return hits;
+}
+
+/**
+ * @brief Scalar fallback for the float32 method family.
+ * @tparam Guard Re-check samples near the boundary in double precision
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <bool Guard>
+inline std::int64_t* monteCarloPI_SIMD_F32_SCALAR(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    Xoshiro256Plus genX(seeder), genY(seeder);
+
+    std::int64_t count = 0;
+    for (std::int64_t block = 0; block < numberOfTrials; block += kHitBlockTrials) {
+        std::uint32_t iterations = blockIterations(numberOfTrials - block, 1);
+        std::uint32_t blockCount = 0;
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            float x = genX.nextFloat();
+            float y = genY.nextFloat();
+            float dist2 = x * x + y * y;
+            bool inside = dist2 <= 1.0f;
+            if constexpr (Guard) {
+                if (std::fabs(dist2 - 1.0f) <= kF32GuardBand) {
+                    inside = isInsideCircle(static_cast<double>(x), static_cast<double>(y));
+                }
+            }
+            blockCount += static_cast<std::uint32_t>(inside);
+        }
+        count += blockCount;
+    }
+
+    *hits = count;
+    return hits;
+}
+
+#ifdef USE_AVX
+/**
+ * @brief AVX2 variant of `monteCarloPI_SIMD_XOSHIRO` — 4-lane in-register PRNG and kernel.
+ *
+ * Darts never pass through a scalar distribution or a stack buffer: random bits are
+ * converted to doubles inside vector registers and tested in place. This is `UnitBall<2>` on
+ * the integrand engine (`integrand.hpp`), whose two streams are the X and Y generators.
+ * Only call when `cpuSupportsAVX2()` is true.
+ *
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+MC_TARGET_AVX2 inline std::int64_t* monteCarloPI_SIMD_XOSHIRO_AVX2(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    *hits = IntegrandEngine<SimdOpsAVX2>::countRegionHits<UnitBall<2>>(seeder, numberOfTrials);
+    return hits;
+}
+
+/**
+ * @brief AVX2 float32 variant of `monteCarloPI_SIMD_XOSHIRO` — 8 darts per iteration.
+ *
+ * Only call when `cpuSupportsAVX2()` is true.
+ *
+ * @tparam Guard Re-check samples near the boundary in double precision
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <bool Guard>
+MC_TARGET_AVX2 inline std::int64_t* monteCarloPI_SIMD_F32_AVX2(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    Xoshiro256PlusAVX genX(seeder), genY(seeder);
+
+    constexpr int batch = 8;
+    std::int64_t loopEnd = numberOfTrials - (numberOfTrials % batch);
+    std::int64_t count = 0;
+
+    for (std::int64_t block = 0; block < loopEnd; block += kHitBlockTrials) {
+        std::uint32_t iterations = blockIterations(loopEnd - block, batch);
+        std::uint32_t blockCount = 0;
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            __m256 dartX = genX.nextFloat();
+            __m256 dartY = genY.nextFloat();
+            if constexpr (Guard) blockCount += countInsideCircleGuarded_AVX_F32(dartX, dartY);
+            else blockCount += countInsideCircle_AVX_F32(dartX, dartY);
+        }
+        count += blockCount;
+    }
+
+    // Tail lanes are checked in double, which is exact for float inputs
+    alignas(32) float tailX[batch], tailY[batch];
+    _mm256_store_ps(tailX, genX.nextFloat());
+    _mm256_store_ps(tailY, genY.nextFloat());
+    for (int i = 0; i < static_cast<int>(numberOfTrials - loopEnd); ++i) {
+        if (isInsideCircle(static_cast<double>(tailX[i]), static_cast<double>(tailY[i]))) ++count;
+    }
+
+    *hits = count;
+    return hits;
+}
+#endif
+
+#ifdef USE_AVX512
+/**
+ * @brief AVX-512 variant of `monteCarloPI_SIMD_XOSHIRO` — 8-lane in-register PRNG and kernel.
+ *
+ * `UnitBall<2>` on the integrand engine; the remainder is handled with a lane mask on one extra
+ * vector draw, so there is no scalar tail. Only call when `cpuSupportsAVX512()` is true.
+ *
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+MC_TARGET_AVX512 inline std::int64_t* monteCarloPI_SIMD_XOSHIRO_AVX512(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    *hits = IntegrandEngine<SimdOpsAVX512>::countRegionHits<UnitBall<2>>(seeder, numberOfTrials);
+    return hits;
+}
+
+/**
+ * @brief AVX-512 float32 variant of `monteCarloPI_SIMD_XOSHIRO` — 16 darts per iteration.
+ *
+ * Only call when `cpuSupportsAVX512()` is true.
+ *
+ * @tparam Guard Re-check samples near the boundary in double precision
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <bool Guard>
+MC_TARGET_AVX512 inline std::int64_t* monteCarloPI_SIMD_F32_AVX512(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    Xoshiro256PlusAVX512 genX(seeder), genY(seeder);
+
+    constexpr int batch = 16;
+    std::int64_t loopEnd = numberOfTrials - (numberOfTrials % batch);
+    std::int64_t count = 0;
+
+    for (std::int64_t block = 0; block < loopEnd; block += kHitBlockTrials) {
+        std::uint32_t iterations = blockIterations(loopEnd - block, batch);
+        std::uint32_t blockCount = 0;
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            __m512 dartX = genX.nextFloat();
+            __m512 dartY = genY.nextFloat();
+            if constexpr (Guard) blockCount += countInsideCircleGuarded_AVX512_F32(dartX, dartY);
+            else blockCount += countInsideCircle_AVX512_F32(dartX, dartY);
+        }
+        count += blockCount;
+    }
+
+    __mmask16 tail = static_cast<__mmask16>((1u << (numberOfTrials - loopEnd)) - 1);
+    __m512 dartX = genX.nextFloat();
+    __m512 dartY = genY.nextFloat();
+    if constexpr (Guard) count += countInsideCircleGuarded_AVX512_F32(dartX, dartY, tail);
+    else count += countInsideCircle_AVX512_F32(dartX, dartY, tail);
+
+    *hits = count;
+    return hits;
+}
+#endif
+
+#ifdef USE_NEON
+/**
+ * @brief NEON variant of `monteCarloPI_SIMD_XOSHIRO` — 2-lane in-register PRNG and kernel.
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+inline std::int64_t* monteCarloPI_SIMD_XOSHIRO_NEON(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    *hits = IntegrandEngine<SimdOpsNEON>::countRegionHits<UnitBall<2>>(seeder, numberOfTrials);
+    return hits;
+}
+
+/**
+ * @brief NEON float32 variant of `monteCarloPI_SIMD_XOSHIRO` — 4 darts per iteration.
+ * @tparam Guard Re-check samples near the boundary in double precision
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <bool Guard>
+inline std::int64_t* monteCarloPI_SIMD_F32_NEON(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(64 * 1024);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    SplitMix64 seeder{chunkSeed()};
+    Xoshiro256PlusNEON genX(seeder), genY(seeder);
+
+    constexpr int batch = 4;
+    std::int64_t loopEnd = numberOfTrials - (numberOfTrials % batch);
+    std::int64_t count = 0;
+
+    for (std::int64_t block = 0; block < loopEnd; block += kHitBlockTrials) {
+        std::uint32_t iterations = blockIterations(loopEnd - block, batch);
+        std::uint32_t blockCount = 0;
+        for (std::uint32_t i = 0; i < iterations; ++i) {
+            float32x4_t dartX = genX.nextFloat();
+            float32x4_t dartY = genY.nextFloat();
+            if constexpr (Guard) blockCount += countInsideCircleGuarded_NEON_F32(dartX, dartY);
+            else blockCount += countInsideCircle_NEON_F32(dartX, dartY);
+        }
+        count += blockCount;
+    }
+
+    float tailX[batch], tailY[batch];
+    vst1q_f32(tailX, genX.nextFloat());
+    vst1q_f32(tailY, genY.nextFloat());
+    for (int i = 0; i < static_cast<int>(numberOfTrials - loopEnd); ++i) {
+        if (isInsideCircle(static_cast<double>(tailX[i]), static_cast<double>(tailY[i]))) ++count;
+    }
+
+    *hits = count;
+    return hits;
+}
+#endif
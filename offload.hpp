@@ -0,0 +1,145 @@
+// ========================================
+// offload.hpp - GPU and CPU+GPU hybrid kernels
+// ========================================
+/**
+ * @file offload.hpp
+ * @brief Whole-run kernels for the `GPU` and `Hybrid` methods on top of `gpu.hpp`.
+ *
+ * `GPU` hands every trial to the device. `Hybrid` splits each run between the GPU and
+ * `SIMDXoshiro` chunks on a CPU `ThreadPool`, sized so both sides finish together:
+ * ```
+ * gpuShare = gpuRate / (gpuRate + cpuRate)      // rates in trials/ns
+ * ```
+ * The GPU part is launched asynchronously first, the CPU part runs on the pool meanwhile, and the
+ * two counts are added once the device copy lands. Both rates come from the previous runs of the
+ * method (CPU wall time of the pool run, kernel time from CUDA events), blended 50/50 per run,
+ * so the split settles during `--warmup`; the first run splits evenly.
+ *
+ * ---
+ *
+ * ## Seeding
+ * Under `--seed` the GPU key is the run seed and the CPU chunks use their usual Philox streams;
+ * `kGpuStreamTag` keeps the two sets of darts disjoint. Each side is reproducible, but the total
+ * also depends on where the measured split fell, so compare hybrid hit counts only between runs
+ * with the same split (see the report line).
+ *
+ * ## Threads
+ * `Hybrid` is a `Single` method that owns its CPU pool (one worker per `--threads`, pinned like
+ * every other pool through `PinConfig`); the benchmark's own pool sits idle while it runs, so
+ * cores are not oversubscribed.
+ */
+
+#pragma once
+
+#include "gpu.hpp"
+#include "montecarlo.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+/// Smallest share either side of a hybrid run gets, so both rates keep being measured.
+constexpr double kHybridMinShare = 1.0 / 64.0;
+
+/**
+ * @brief Key of the calling run's GPU darts.
+ * @return The run seed under `--seed`, otherwise fresh entropy
+ */
+inline std::uint64_t gpuRunSeed() {
+    const RunSeed& run = RunSeed::global();
+    return run.enabled ? run.value : entropySeed();
+}
+
+/**
+ * @brief Measured CPU and GPU throughput and the split they imply.
+ */
+struct HybridSplit {
+    double gpuShare = 0.5;        ///< Fraction of the next run's trials given to the GPU
+    double cpuRate = 0.0;         ///< CPU trials per ns (0 = not measured yet)
+    double gpuRate = 0.0;         ///< GPU trials per ns (0 = not measured yet)
+    std::int64_t cpuTrials = 0;   ///< CPU trials of the last run
+    std::int64_t gpuTrials = 0;   ///< GPU trials of the last run
+
+    /**
+     * @brief Process-wide split, shared by every `Hybrid` kernel.
+     * @return Reference to the global split
+     */
+    static HybridSplit& global() {
+        static HybridSplit instance;
+        return instance;
+    }
+
+    /**
+     * @brief Forget earlier measurements before a method run.
+     */
+    void reset() {
+        *this = HybridSplit{};
+    }
+
+    /**
+     * @brief Folds one run's timings into the rates and recomputes the share.
+     * @param cpuRun    CPU trials of the run
+     * @param cpuNs     Wall time of the CPU pool run
+     * @param gpuRun    GPU trials of the run
+     * @param gpuNs     Kernel time of the GPU run
+     */
+    void record(std::int64_t cpuRun, long long cpuNs, std::int64_t gpuRun, long long gpuNs) {
+        auto blend = [](double previous, std::int64_t trials, long long ns) {
+            if (trials <= 0 || ns <= 0) return previous;
+            double rate = static_cast<double>(trials) / static_cast<double>(ns);
+            return previous > 0.0 ? 0.5 * (previous + rate) : rate;
+        };
+        cpuTrials = cpuRun;
+        gpuTrials = gpuRun;
+        cpuRate = blend(cpuRate, cpuRun, cpuNs);
+        gpuRate = blend(gpuRate, gpuRun, gpuNs);
+        if (cpuRate > 0.0 && gpuRate > 0.0) {
+            gpuShare = std::clamp(gpuRate / (gpuRate + cpuRate), kHybridMinShare, 1.0 - kHybridMinShare);
+        }
+    }
+};
+
+/**
+ * @brief Runs every trial on the GPU.
+ * @param numberOfTrials Darts to throw
+ * @return Darts inside the quarter circle
+ */
+inline std::int64_t monteCarloPI_GPU(std::int64_t numberOfTrials) {
+    return gpuCountHits(gpuRunSeed(), numberOfTrials);
+}
+
+/**
+ * @brief Splits one run between the GPU and `SIMDXoshiro` chunks on `pool` by measured throughput.
+ * @param pool           CPU workers
+ * @param numberOfTrials Darts to throw in total
+ * @return Darts inside the quarter circle over both devices
+ */
+inline std::int64_t monteCarloPI_HYBRID(ThreadPool& pool, std::int64_t numberOfTrials) {
+    HybridSplit& split = HybridSplit::global();
+    std::int64_t gpuTrials = static_cast<std::int64_t>(split.gpuShare * static_cast<double>(numberOfTrials));
+    std::int64_t cpuTrials = numberOfTrials - gpuTrials;
+
+    gpuLaunchHits(gpuRunSeed(), gpuTrials);
+    auto start = std::chrono::steady_clock::now();
+    std::int64_t hits = pool.run(cpuTrials, kDefaultChunkTrials,
+                                 [](std::int64_t trials) { return *monteCarloPI_SIMD_XOSHIRO(trials); });
+    long long cpuNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    GpuHits gpu = gpuWaitHits();
+
+    split.record(cpuTrials, cpuNs, gpuTrials, gpu.deviceNs);
+    return hits + gpu.hits;
+}
+
+/**
+ * @brief Prints the last hybrid split and the rates behind the next one.
+ * @param split Global hybrid split after a run
+ */
+inline void printHybridSplit(const HybridSplit& split) {
+    double total = static_cast<double>(std::max<std::int64_t>(1, split.cpuTrials + split.gpuTrials));
+    std::cout << "  Split (last run): GPU " << std::round(1000.0 * split.gpuTrials / total) / 10.0 << "% ("
+              << split.gpuRate * 1e3 << " Mtrials/s), CPU "
+              << std::round(1000.0 * split.cpuTrials / total) / 10.0 << "% (" << split.cpuRate * 1e3
+              << " Mtrials/s)\n";
+}
@@ -0,0 +1,477 @@
+// ========================================
+// perfcounters.hpp - In-process hardware counters
+// ========================================
+/**
+ * @file perfcounters.hpp
+ * @brief Per-thread `perf_event_open` counter groups, read only around a benchmark's timed region.
+ *
+ * Wrapping the whole binary in `perf stat` also counts process startup, argument parsing, pool
+ * creation and every other method of the same run. `PerfCounters` instead opens the same events
+ * inside the process, once per thread, and `PerfRegion` reads them immediately before and after
+ * the timed call, so a sample covers that kernel and nothing else.
+ *
+ * ---
+ *
+ * ## Events
+ * All events count user space only (the `:u` events `run_perf.sh` used with `perf stat`):
+ * | Group | Events                                                  |
+ * |-------|---------------------------------------------------------|
+ * | core  | cycles, instructions, branch-instructions, branch-misses |
+ * | cache | cache-references, cache-misses                          |
+ * | L1d   | L1-dcache-loads, L1-dcache-load-misses                  |
+ * | dTLB  | dTLB-loads, dTLB-load-misses                            |
+ *
+ * Events that must be compared (IPC, miss rates) share a group, so the kernel schedules them
+ * together and ratios are exact. Small groups fit the PMU's general-purpose counters; if the
+ * groups are multiplexed anyway, each group's count is scaled by its enabled / running time.
+ * An event or group the CPU does not support reads as unavailable (`NA` in the record) instead
+ * of failing the run.
+ *
+ * ## Per-Thread Groups
+ * `perf_event_open(pid = 0)` counts the calling thread only. Every thread that may run a kernel
+ * attaches once — `ThreadPool` workers on start-up, before the constructor returns, and the main
+ * thread in `enable()` — and registers its groups here. A region sums the deltas of all
+ * registered threads; a thread that exits inside a region takes its counts with it.
+ *
+ * ## Record Format
+ * `printPerfRecord()` writes one line per result, already in the argument format of
+ * `pipeline/gen_perf_parquet_logs.py`, so `run_perf.sh` forwards it without a parse step:
+ * ```
+ * [PERF] --repetition 0 --trials 100000000 --wall_time_s 0.0806 --wall_time_ns 80587148 --cycles 6010711137 ...
+ * ```
+ *
+ * ## Example
+ * ```cpp
+ * PerfCounters::global().enable();   // before creating the ThreadPool
+ * PerfRegion region;
+ * std::int64_t hits = pool.run(trials, kDefaultChunkTrials, kernel);
+ * PerfSample sample = region.stop();
+ * ```
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+/// Counted hardware events, in record order.
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    CacheReferences,
+    CacheMisses,
+    L1Loads,
+    L1Misses,
+    TlbLoads,
+    TlbMisses,
+    BranchInstructions,
+    BranchMisses,
+    Count,
+};
+
+/// Number of counted events.
+constexpr std::size_t kPerfEventCount = static_cast<std::size_t>(PerfEvent::Count);
+
+/**
+ * @brief Counter totals of one timed region, summed over threads.
+ */
+struct PerfSample {
+    std::array<double, kPerfEventCount> values{};      ///< Scaled counts
+    std::array<bool, kPerfEventCount> available{};     ///< Whether each event could be counted
+
+    /**
+     * @brief Whether an event was counted.
+     * @param event Event
+     * @return true if at least one thread counted it
+     */
+    bool has(PerfEvent event) const {
+        return available[static_cast<std::size_t>(event)];
+    }
+
+    /**
+     * @brief Count of an event.
+     * @param event Event
+     * @return Scaled count (0 if unavailable)
+     */
+    double operator[](PerfEvent event) const {
+        return values[static_cast<std::size_t>(event)];
+    }
+
+    /**
+     * @brief Whether any event was counted.
+     * @return true if the sample holds at least one count
+     */
+    bool any() const {
+        for (bool event : available) {
+            if (event) return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Process-wide counter registry: one set of event groups per attached thread.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Process-wide registry (disabled by default).
+     * @return Reference to the registry
+     */
+    static PerfCounters& global() {
+        static PerfCounters instance;
+        return instance;
+    }
+
+    /**
+     * @brief Turn collection on and attach the calling (main) thread.
+     *
+     * Call before creating any `ThreadPool`, whose workers attach as they start.
+     *
+     * @return false (after a `[WARN]`) if no event could be opened; collection stays on and
+     *         samples read as unavailable
+     */
+    bool enable() {
+        enabled = true;
+        attachCurrentThread();
+        if (!anyOpened) {
+            std::cout << "[WARN] Hardware counters unavailable (perf_event_open: " << std::strerror(openError)
+                      << "); counter fields will be NA\n";
+        }
+        return anyOpened;
+    }
+
+    /**
+     * @brief Whether `enable()` was called.
+     * @return true if regions collect counters
+     */
+    bool active() const {
+        return enabled;
+    }
+
+    /**
+     * @brief Open the calling thread's event groups, once per thread. No-op while disabled.
+     */
+    static void attachCurrentThread() {
+        PerfCounters& registry = global();
+        if (!registry.enabled) return;
+
+        thread_local std::unique_ptr<ThreadGroups> groups;
+        if (groups) return;
+        groups = std::make_unique<ThreadGroups>(registry);
+    }
+
+private:
+    friend class PerfRegion;
+
+    /// Event groups; the first event of each is the leader.
+    static constexpr std::size_t kGroupCount = 4;
+    static constexpr std::size_t kMaxGroupSize = 4;
+
+    /// One event group of `groupSpecs()`.
+    struct GroupSpec {
+        std::size_t size;                                      ///< Events in the group
+        std::array<PerfEvent, kMaxGroupSize> events;           ///< Leader first
+    };
+
+    /**
+     * @brief The four event groups of the table above.
+     * @return Group layouts
+     */
+    static const std::array<GroupSpec, kGroupCount>& groupSpecs() {
+        static const std::array<GroupSpec, kGroupCount> specs = {{
+            {4, {PerfEvent::Cycles, PerfEvent::Instructions, PerfEvent::BranchInstructions, PerfEvent::BranchMisses}},
+            {2, {PerfEvent::CacheReferences, PerfEvent::CacheMisses, PerfEvent::Count, PerfEvent::Count}},
+            {2, {PerfEvent::L1Loads, PerfEvent::L1Misses, PerfEvent::Count, PerfEvent::Count}},
+            {2, {PerfEvent::TlbLoads, PerfEvent::TlbMisses, PerfEvent::Count, PerfEvent::Count}},
+        }};
+        return specs;
+    }
+
+    /// Raw (unscaled) group readings of one thread.
+    struct GroupReading {
+        std::array<std::uint64_t, kPerfEventCount> counts{};   ///< Per-event raw count
+        std::array<std::uint64_t, kGroupCount> enabledNs{};    ///< Per-group time enabled
+        std::array<std::uint64_t, kGroupCount> runningNs{};    ///< Per-group time running
+    };
+
+    /**
+     * @brief The calling thread's open groups; unregisters and closes on thread exit.
+     */
+    class ThreadGroups {
+    public:
+        explicit ThreadGroups(PerfCounters& owner) : registry(owner) {
+            fds.fill(-1);
+            for (std::size_t g = 0; g < kGroupCount; ++g) open(g);
+
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.threads.push_back(this);
+        }
+
+        ~ThreadGroups() {
+            {
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                auto& threads = registry.threads;
+                for (std::size_t i = 0; i < threads.size(); ++i) {
+                    if (threads[i] != this) continue;
+                    threads.erase(threads.begin() + static_cast<std::ptrdiff_t>(i));
+                    break;
+                }
+            }
+#if defined(__linux__)
+            for (int fd : fds) {
+                if (fd >= 0) close(fd);
+            }
+#endif
+        }
+
+        ThreadGroups(const ThreadGroups&) = delete;
+        ThreadGroups& operator=(const ThreadGroups&) = delete;
+
+        /**
+         * @brief Read every group of this thread (callable from any thread).
+         * @return Raw counts and per-group times; unavailable events stay 0
+         */
+        GroupReading read() const {
+            GroupReading reading;
+#if defined(__linux__)
+            for (std::size_t g = 0; g < kGroupCount; ++g) {
+                const GroupSpec& spec = groupSpecs()[g];
+                int leader = fds[static_cast<std::size_t>(spec.events[0])];
+                if (leader < 0) continue;
+
+                // PERF_FORMAT_GROUP | TOTAL_TIME_*: {nr, time_enabled, time_running, id/value per member}
+                std::array<std::uint64_t, 3 + 2 * kMaxGroupSize> buffer{};
+                if (::read(leader, buffer.data(), sizeof(buffer)) <= 0) continue;
+                reading.enabledNs[g] = buffer[1];
+                reading.runningNs[g] = buffer[2];
+
+                std::size_t members = static_cast<std::size_t>(buffer[0]);
+                for (std::size_t m = 0; m < members && m < kMaxGroupSize; ++m) {
+                    std::uint64_t id = buffer[3 + 2 * m + 1];
+                    for (std::size_t e = 0; e < spec.size; ++e) {
+                        std::size_t event = static_cast<std::size_t>(spec.events[e]);
+                        if (fds[event] >= 0 && ids[event] == id) reading.counts[event] = buffer[3 + 2 * m];
+                    }
+                }
+            }
+#endif
+            return reading;
+        }
+
+        /**
+         * @brief Whether an event is open on this thread.
+         * @param event Event index
+         * @return true if counting
+         */
+        bool opened(std::size_t event) const {
+            return fds[event] >= 0;
+        }
+
+    private:
+        /**
+         * @brief Open one group: the leader disabled, then members, then enable the group.
+         * @param g Group index
+         */
+        void open(std::size_t g) {
+#if defined(__linux__)
+            const GroupSpec& spec = groupSpecs()[g];
+            int leader = -1;
+            for (std::size_t e = 0; e < spec.size; ++e) {
+                std::size_t event = static_cast<std::size_t>(spec.events[e]);
+
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                describe(spec.events[e], attr);
+                attr.disabled = leader < 0 ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                                   PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+                if (fd < 0) {
+                    registry.openError = errno;
+                    if (leader < 0) return;   // No leader, no group
+                    continue;                 // Member unsupported; the rest still count
+                }
+                fds[event] = fd;
+                ioctl(fd, PERF_EVENT_IOC_ID, &ids[event]);
+                if (leader < 0) leader = fd;
+                registry.anyOpened = true;
+            }
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+            (void)g;
+            registry.openError = ENOSYS;
+#endif
+        }
+
+#if defined(__linux__)
+        /**
+         * @brief Fill the type/config of a `perf_event_attr` for an event.
+         * @param event Event
+         * @param attr  Attribute to fill
+         */
+        static void describe(PerfEvent event, perf_event_attr& attr) {
+            auto cache = [&](std::uint64_t id, std::uint64_t result) {
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+            };
+            attr.type = PERF_TYPE_HARDWARE;
+            switch (event) {
+                case PerfEvent::Cycles:             attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+                case PerfEvent::Instructions:       attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+                case PerfEvent::CacheReferences:    attr.config = PERF_COUNT_HW_CACHE_REFERENCES; break;
+                case PerfEvent::CacheMisses:        attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+                case PerfEvent::BranchInstructions: attr.config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS; break;
+                case PerfEvent::BranchMisses:       attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+                case PerfEvent::L1Loads:   cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS); break;
+                case PerfEvent::L1Misses:  cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS); break;
+                case PerfEvent::TlbLoads:  cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_ACCESS); break;
+                case PerfEvent::TlbMisses: cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS); break;
+                default: break;
+            }
+        }
+#endif
+
+        PerfCounters& registry;                                ///< Owning registry
+        std::array<int, kPerfEventCount> fds{};                ///< Event fds (-1 = not open)
+        std::array<std::uint64_t, kPerfEventCount> ids{};      ///< Kernel event ids, to match group reads
+    };
+
+    bool enabled = false;                  ///< Set by `enable()`
+    std::atomic<bool> anyOpened{false};    ///< At least one event opened on some thread
+    std::atomic<int> openError{0};         ///< Last `perf_event_open` errno
+    std::mutex mutex;                      ///< Guards `threads`
+    std::vector<ThreadGroups*> threads;    ///< Attached threads
+};
+
+/**
+ * @brief Counter deltas of all attached threads between construction and `stop()`.
+ *
+ * Inert (no reads, no locking) while `PerfCounters` is disabled.
+ */
+class PerfRegion {
+public:
+    /**
+     * @brief Take the starting reading of every attached thread.
+     */
+    PerfRegion() {
+        PerfCounters& registry = PerfCounters::global();
+        if (!registry.active()) return;
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const PerfCounters::ThreadGroups* thread : registry.threads) start[thread] = thread->read();
+    }
+
+    /**
+     * @brief Take the closing reading and sum the scaled deltas.
+     * @return Region totals (all unavailable while disabled)
+     */
+    PerfSample stop() const {
+        PerfSample sample;
+        PerfCounters& registry = PerfCounters::global();
+        if (!registry.active()) return sample;
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const PerfCounters::ThreadGroups* thread : registry.threads) {
+            PerfCounters::GroupReading end = thread->read();
+
+            // Threads attached after the region began started from zero
+            auto found = start.find(thread);
+            PerfCounters::GroupReading begin = found != start.end() ? found->second : PerfCounters::GroupReading{};
+
+            for (std::size_t g = 0; g < PerfCounters::kGroupCount; ++g) {
+                const PerfCounters::GroupSpec& spec = PerfCounters::groupSpecs()[g];
+                std::uint64_t enabledNs = end.enabledNs[g] - begin.enabledNs[g];
+                std::uint64_t runningNs = end.runningNs[g] - begin.runningNs[g];
+                double scale = runningNs > 0 ? static_cast<double>(enabledNs) / static_cast<double>(runningNs) : 0.0;
+
+                for (std::size_t e = 0; e < spec.size; ++e) {
+                    std::size_t event = static_cast<std::size_t>(spec.events[e]);
+                    if (!thread->opened(event)) continue;
+                    sample.available[event] = true;
+                    sample.values[event] += scale * static_cast<double>(end.counts[event] - begin.counts[event]);
+                }
+            }
+        }
+        return sample;
+    }
+
+private:
+    /// Starting reading per attached thread.
+    std::unordered_map<const PerfCounters::ThreadGroups*, PerfCounters::GroupReading> start;
+};
+
+/**
+ * @brief Derived counter ratio as the pipeline stores it (`safe_div` / `safe_div_percent`).
+ * @param numerator   Event count (or other dividend)
+ * @param denominator Divisor, non-zero
+ * @param scale       100 for percentages, else 1
+ * @return `numerator / denominator · scale`, rounded to 4 decimals
+ */
+inline double perfRatio(double numerator, double denominator, double scale = 1.0) {
+    return std::round(numerator / denominator * scale * 1e4) / 1e4;
+}
+
+/**
+ * @brief Prints one result as `gen_perf_parquet_logs.py` arguments, prefixed `[PERF]`.
+ *
+ * Unavailable events (and the L2/L3 fields, which have no generic event) print as `NA`. Ratios
+ * are rounded by `perfRatio()`, like the `--arrow-out` columns, so both records of a run agree.
+ *
+ * @param trials     Trials executed in the region
+ * @param elapsedNs  Wall time of the region in nanoseconds
+ * @param sample     Counter totals of the region
+ * @param repetition Index of the repetition within its benchmark
+ */
+inline void printPerfRecord(std::int64_t trials, long long elapsedNs, const PerfSample& sample, int repetition = 0) {
+    auto count = [&](PerfEvent event) {
+        return sample.has(event) ? std::to_string(static_cast<long long>(sample[event] + 0.5)) : std::string("NA");
+    };
+    auto ratio = [](bool valid, double numerator, double denominator) {
+        return valid && denominator > 0.0 ? std::to_string(perfRatio(numerator, denominator)) : std::string("NA");
+    };
+    double n = static_cast<double>(trials);
+
+    std::cout << "[PERF]"
+              << " --repetition " << repetition
+              << " --trials " << trials
+              << " --wall_time_s " << std::to_string(static_cast<double>(elapsedNs) / 1e9)
+              << " --wall_time_ns " << elapsedNs
+              << " --cycles " << count(PerfEvent::Cycles)
+              << " --instr " << count(PerfEvent::Instructions)
+              << " --ipc " << ratio(sample.has(PerfEvent::Instructions) && sample.has(PerfEvent::Cycles),
+                                    sample[PerfEvent::Instructions], sample[PerfEvent::Cycles])
+              << " --cache_loads " << count(PerfEvent::CacheReferences)
+              << " --cache_miss " << count(PerfEvent::CacheMisses)
+              << " --l1_loads " << count(PerfEvent::L1Loads)
+              << " --l1_misses " << count(PerfEvent::L1Misses)
+              << " --l2_loads NA --l2_misses NA --l3_loads NA --l3_misses NA"
+              << " --tlb_loads " << count(PerfEvent::TlbLoads)
+              << " --tlb_misses " << count(PerfEvent::TlbMisses)
+              << " --branch_instr " << count(PerfEvent::BranchInstructions)
+              << " --branch_misses " << count(PerfEvent::BranchMisses)
+              << " --miss_per_trial " << ratio(sample.has(PerfEvent::CacheMisses), sample[PerfEvent::CacheMisses], n)
+              << " --cycles_per_trial " << ratio(sample.has(PerfEvent::Cycles), sample[PerfEvent::Cycles], n)
+              << "\n";
+}
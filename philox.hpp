@@ -0,0 +1,121 @@
+// ========================================
+// philox.hpp - Counter-based stream seeding
+// ========================================
+/**
+ * @file philox.hpp
+ * @brief Philox4x32-10 counter-based generator and per-chunk stream keys for reproducible runs.
+ *
+ * Runs normally seed from `std::random_device`, and the `std::mt19937_64` kernels keep a
+ * `thread_local` engine across calls, so hit counts depend on how chunks land on threads.
+ * Handing every thread a slice of one sequential stream would fix that, but costs a skip-ahead
+ * per chunk and still ties the result to the scheduling order.
+ *
+ * A counter-based generator has no state to share: its output is a pure function of
+ * (key, counter). Keying Philox with the run seed and counting by chunk index gives every chunk
+ * its own stream, computable on any thread in O(1):
+ * ```cpp
+ * seed(chunk) = Philox4x32-10(key = runSeed, counter = {chunk, 0, 0, 0})
+ * ```
+ * The kernels then expand that 64-bit value into their usual fast generators (xoshiro256+ lanes,
+ * `mt19937_64`), so the hot loops and their SIMD throughput are unchanged; Philox runs once per
+ * chunk, not once per dart.
+ *
+ * ---
+ *
+ * ## Reproducibility Contract
+ * With `setRunSeed()` (CLI `--seed`), a run's total hit count depends only on the seed, the trial
+ * count and the chunk size — not on the thread count, pinning or work-stealing order:
+ * - `ThreadPool` publishes the index of the chunk a worker is executing (`currentChunk()`)
+ * - The last chunk is the remainder, so chunk boundaries are fixed by `totalTrials` and `chunkTrials`
+ * - Calls outside a pool (Sequential) use chunk 0
+ * - The xoshiro-based kernels expand a chunk seed into one state per lane, so their totals also
+ *   depend on the selected SIMD kernel (`--kernel`); compare runs on the same kernel
+ *
+ * Early-stopped runs (`estimator.hpp`) execute a timing-dependent set of chunks, so they are
+ * reproducible per chunk but not in total.
+ *
+ * ## Philox4x32-10
+ * Ten rounds of two 32×32→64 multiplies with Weyl-sequence key bumps; passes BigCrush.
+ * Reference: J. Salmon et al. — "Parallel Random Numbers: As Easy as 1, 2, 3" (SC11).
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/// Philox4x32 counter block.
+using PhiloxCounter = std::array<std::uint32_t, 4>;
+
+/// Philox4x32 key.
+using PhiloxKey = std::array<std::uint32_t, 2>;
+
+/**
+ * @brief Philox4x32-10 block function.
+ * @param counter 128-bit counter
+ * @param key     64-bit key
+ * @return Four pseudo-random 32-bit words for this (key, counter)
+ */
+inline PhiloxCounter philox4x32(PhiloxCounter counter, PhiloxKey key) {
+    constexpr std::uint32_t kMul0 = 0xD2511F53u;
+    constexpr std::uint32_t kMul1 = 0xCD9E8D57u;
+    constexpr std::uint32_t kWeyl0 = 0x9E3779B9u;
+    constexpr std::uint32_t kWeyl1 = 0xBB67AE85u;
+
+    for (int round = 0; round < 10; ++round) {
+        std::uint64_t p0 = static_cast<std::uint64_t>(kMul0) * counter[0];
+        std::uint64_t p1 = static_cast<std::uint64_t>(kMul1) * counter[2];
+        counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+        key[0] += kWeyl0;
+        key[1] += kWeyl1;
+    }
+    return counter;
+}
+
+/**
+ * @brief 64-bit seed of one stream, derived from the run seed by Philox.
+ * @param seed   Run seed (Philox key)
+ * @param stream Stream index, e.g. the chunk index (Philox counter)
+ * @return Seed for the stream's generators
+ */
+inline std::uint64_t philoxStreamSeed(std::uint64_t seed, std::uint64_t stream) {
+    PhiloxCounter block = philox4x32(
+        {static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32), 0u, 0u},
+        {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)});
+    return (static_cast<std::uint64_t>(block[0]) << 32) | block[1];
+}
+
+/**
+ * @brief Run-wide reproducibility settings and the calling thread's current chunk.
+ */
+struct RunSeed {
+    bool enabled = false;      ///< Whether `--seed` was given
+    std::uint64_t value = 0;   ///< Run seed
+
+    /**
+     * @brief Process-wide run seed (disabled by default).
+     * @return Reference to the global settings
+     */
+    static RunSeed& global() {
+        static RunSeed instance;
+        return instance;
+    }
+
+    /**
+     * @brief Chunk index executed by the calling thread (set by `ThreadPool`, 0 elsewhere).
+     * @return Reference to the thread-local chunk index
+     */
+    static std::uint64_t& currentChunk() {
+        thread_local std::uint64_t chunk = 0;
+        return chunk;
+    }
+};
+
+/**
+ * @brief Make every following run reproducible from `seed`. Call before starting any run.
+ * @param seed Run seed
+ */
+inline void setRunSeed(std::uint64_t seed) {
+    RunSeed::global() = RunSeed{true, seed};
+}
@@ -8,7 +8,8 @@
 ## \details 
 ## \par Description:
 ##     Scans a given batch directory for all `perf_results_*.parquet` files,
-##     excluding the output file itself. Merges them using vertical concat,
+##     excluding the output file itself, and for Arrow IPC streams (`*.arrows`)
+##     appended by `montecarlo --arrow-out`. Merges them using vertical concat,
 ##     sorts by "Timestamp", and saves the result as a single compressed parquet.
 ##     
 ##     After merging, the result is also appended to a global historical
@@ -22,7 +23,7 @@
 ##     $ python3 combine_batch_parquets.py <batch_dir> <output_file>
 ## 
 ## \par Arguments:
-##     <batch_dir>     Folder containing individual `.parquet` logs
+##     <batch_dir>     Folder containing individual `.parquet` logs and/or `.arrows` streams
 ##     <output_file>   Path to final combined `.parquet` file
 ## 
 ## \par Output:
@@ -33,9 +34,12 @@
 ##     - Global Parquet path is loaded from `.env` via `scripts/config.py`
 ##     - This script uses `polars` for fast DataFrame operations and I/O
 ##     - Intended to be run after `run_perf.sh` completes all method benchmarks
+##     - Concatenation is diagonal, so rows from before a schema column was added get nulls
 
 
 from scripts.config import DB_PATH
+from pipeline.schema import SCHEMA
+from pipeline.utils import safe_vector_cast
 from pathlib import Path
 import polars as pl
 import sys
@@ -50,11 +54,14 @@ global_db_path = Path(DB_PATH)
 
 # --- 1. Combine batch parquet files ---
 files = [f for f in batch_dir.glob("perf_results_*.parquet") if f.name != output_path.name]
-if not files:
-    print(f"[ERROR] No .parquet files found in {batch_dir}")
+streams = sorted(batch_dir.glob("*.arrows"))
+if not files and not streams:
+    print(f"[ERROR] No .parquet or .arrows files found in {batch_dir}")
     sys.exit(0)
 
-merged = pl.concat([pl.read_parquet(f) for f in files], how="vertical_relaxed").sort("Timestamp")
+frames = [pl.read_parquet(f) for f in files]
+frames += [safe_vector_cast(pl.read_ipc_stream(f), SCHEMA) for f in streams]
+merged = pl.concat(frames, how="diagonal_relaxed").sort("Timestamp")
 merged.write_parquet(output_path, compression="zstd")
 print(f"[INFO] Merged batch saved: {output_path}")
 
@@ -62,7 +69,7 @@ print(f"[INFO] Merged batch saved: {output_path}")
 # --- 2. Append to global db.parquet ---
 if global_db_path.exists():
     db = pl.read_parquet(global_db_path)
-    db = pl.concat([db, merged], how="vertical_relaxed")
+    db = pl.concat([db, merged], how="diagonal_relaxed")
     print("[INFO] Appended to existing db.parquet")
 else:
     db = merged
@@ -0,0 +1,299 @@
+# ===========================================
+# detect_regressions.py
+# ===========================================
+
+## \file detect_regressions.py
+## \brief Flags a batch whose Cycles/Trial, IPC or wall time drifted from its rolling baseline.
+##
+## \details
+## \par Description
+##     Rows are grouped into baseline keys — (Method, Host, Trials, ThreadCount, Node, SIMD Kernel,
+##     Pinning) — and each batch is reduced to its median per key, so repetitions count once per batch. For every key
+##     of the checked batch, the previous `--window` batches of the same key form the baseline:
+##     their rolling median and MAD (median absolute deviation). A metric is flagged when it moves
+##     past the tolerance in its bad direction:
+##     \code
+##     tolerance = max(mad_k · 1.4826 · MAD, min_rel · |median|)
+##     score     = direction · (value − median) / tolerance     # > 1: regression, < −1: improvement
+##     \endcode
+##     where `direction` is +1 for Cycles/Trial and Wall Time (higher is worse) and −1 for IPC.
+##     The relative floor keeps a very quiet baseline (MAD ≈ 0) from flagging noise-level moves.
+##
+## \par Usage
+##     $ python3 -m pipeline.detect_regressions --batchid <BATCH_ID>           # against ClickHouse
+##     $ python3 -m pipeline.detect_regressions                                # latest batch
+##     $ python3 -m pipeline.detect_regressions --batchid <BATCH_ID> --files db/db.parquet
+##     $ python3 -m pipeline.detect_regressions --batchid <BATCH_ID> --json regressions.json
+##
+## \par Exit Codes
+##     - 0: no metric regressed (keys without `--min-history` earlier batches are not judged)
+##     - 1: error (ClickHouse unreachable, unknown batch, unreadable files)
+##     - 3: at least one regression was flagged
+##
+## \par Notes
+##     - History comes from `benchmark.performance`, or from `.arrows` / `.parquet` files with `--files`
+##       (e.g. the global `DB_PATH` history when runs are not inserted into ClickHouse)
+##     - Every judged check is stored in `benchmark.regressions` (REGRESSION_SCHEMA), replacing the
+##       batch's earlier rows, so re-running is idempotent; `--no-store` and `--files` skip this
+##     - `Host` comes from `$MC_HOST` or the host name (`arrowlog.hpp`); rows without it share the
+##       empty host, so set `MC_HOST` (`run_perf.sh host=NAME`) when containers change host names
+##     - `SIMD Kernel` and `Pinning` are part of the key, so a `--spec` batch sweeping several kernels
+##       is judged per kernel, and switching `--kernel` or `--pin` starts a new baseline
+
+
+import argparse
+import json
+import math
+import statistics
+import sys
+from collections import defaultdict
+
+
+EXIT_OK = 0
+EXIT_ERROR = 1
+EXIT_REGRESSION = 3
+
+PERFORMANCE_TABLE = "benchmark.performance"
+REGRESSION_TABLE = "benchmark.regressions"
+
+## Baseline key: a result is only compared with earlier results of the same configuration.
+KEY = ("Method", "Host", "Trials", "ThreadCount", "Node", "SIMD Kernel", "Pinning")
+
+## Checked metrics and their bad direction (+1: higher is worse, −1: lower is worse).
+METRICS = (("Cycles/Trial", 1), ("IPC", -1), ("Wall Time (s)", 1))
+
+DEFAULT_WINDOW = 20
+DEFAULT_MIN_HISTORY = 5
+DEFAULT_MAD_K = 4.0
+DEFAULT_MIN_REL = 0.05
+
+
+def batch_medians_from_frame(df) -> list:
+    """!Reduces result rows to one row per (BatchID, key): the median of each metric.
+
+    @param df Rows cast to SCHEMA (Polars DataFrame).
+
+    @return List of dicts with BatchID, Started (earliest Timestamp), the KEY columns and METRICS.
+    """
+    import polars as pl
+
+    keyed = df.with_columns(
+        pl.col("Host").fill_null(""),
+        pl.col("ThreadCount").fill_null(0),
+        pl.col("Node").fill_null(""),
+        pl.col("SIMD Kernel").fill_null(""),
+        pl.col("Pinning").fill_null(""),
+    )
+    grouped = keyed.group_by(["BatchID", *KEY]).agg(
+        pl.col("Timestamp").min().alias("Started"),
+        *[pl.col(metric).median().alias(metric) for metric, _ in METRICS],
+    )
+    return grouped.to_dicts()
+
+
+def batch_medians_from_clickhouse(client, batch_id: str) -> list:
+    """!Loads the per-batch medians of every key of `batch_id` from `benchmark.performance`.
+
+    Only keys the batch contains are read, so the query cost follows the batch, not the table.
+
+    @param client Connected clickhouse-driver Client.
+    @param batch_id Batch to check.
+
+    @return List of dicts in the shape of batch_medians_from_frame().
+    """
+    medians = ", ".join(f"quantileExact(0.5)(`{metric}`)" for metric, _ in METRICS)
+    rows = client.execute(f"""
+        SELECT BatchID, min(Timestamp), Method, ifNull(Host, '') AS HostKey, Trials,
+               ifNull(ThreadCount, 0) AS Threads, ifNull(Node, '') AS NodeKey,
+               ifNull(`SIMD Kernel`, '') AS KernelKey, ifNull(Pinning, '') AS PinningKey, {medians}
+        FROM {PERFORMANCE_TABLE}
+        WHERE (Method, ifNull(Host, ''), Trials, ifNull(`SIMD Kernel`, ''), ifNull(Pinning, '')) IN (
+            SELECT DISTINCT Method, ifNull(Host, ''), Trials, ifNull(`SIMD Kernel`, ''), ifNull(Pinning, '')
+            FROM {PERFORMANCE_TABLE} WHERE BatchID = %(batch)s)
+        GROUP BY BatchID, Method, HostKey, Trials, Threads, NodeKey, KernelKey, PinningKey""", {"batch": batch_id})
+
+    columns = ("BatchID", "Started", *KEY, *(metric for metric, _ in METRICS))
+    return [dict(zip(columns, row)) for row in rows]
+
+
+def latest_batch(rows) -> str:
+    """!@return BatchID of the most recently started batch among `rows`."""
+    return max(rows, key=lambda row: row["Started"])["BatchID"]
+
+
+def judge(value: float, history: list, worse: int, mad_k: float, min_rel: float) -> dict:
+    """!Compares one value with the rolling baseline of its key.
+
+    @param value The checked batch's median.
+    @param history Earlier batches' medians of the same key and metric.
+    @param worse +1 if higher is worse, −1 if lower is worse.
+    @param mad_k Robust standard deviations (1.4826 · MAD) tolerated.
+    @param min_rel Relative change always tolerated.
+
+    @return Dict with Baseline Median, Baseline MAD, Delta %, Score and Status.
+    """
+    median = statistics.median(history)
+    mad = statistics.median(abs(sample - median) for sample in history)
+    tolerance = max(mad_k * 1.4826 * mad, min_rel * abs(median), 1e-12)
+
+    delta = value - median
+    score = worse * delta / tolerance
+    status = "regression" if score > 1.0 else "improvement" if score < -1.0 else "ok"
+    return {
+        "Baseline Median": median,
+        "Baseline MAD": mad,
+        "Delta %": 100.0 * delta / median if median else 0.0,
+        "Score": score,
+        "Status": status,
+    }
+
+
+def detect(rows: list, batch_id: str, window: int = DEFAULT_WINDOW, min_history: int = DEFAULT_MIN_HISTORY,
+           mad_k: float = DEFAULT_MAD_K, min_rel: float = DEFAULT_MIN_REL):
+    """!Judges every key and metric of one batch against the batches before it.
+
+    @param rows Per-batch medians (batch_medians_from_frame() / batch_medians_from_clickhouse()).
+    @param batch_id Batch to check.
+    @param window Earlier batches per key in the baseline (most recent first).
+    @param min_history Fewest earlier batches a key needs to be judged.
+    @param mad_k Robust standard deviations tolerated.
+    @param min_rel Relative change always tolerated.
+
+    @return (checks, unjudged): one REGRESSION_SCHEMA dict per judged (key, metric), and the number
+            of keys skipped for lack of history.
+
+    @throws LookupError If `rows` has no row of `batch_id`.
+    """
+    by_key = defaultdict(list)
+    for row in rows:
+        by_key[tuple(row[k] for k in KEY)].append(row)
+
+    current = [row for row in rows if row["BatchID"] == batch_id]
+    if not current:
+        raise LookupError(f"Batch '{batch_id}' has no rows")
+
+    checks = []
+    unjudged = 0
+    for row in sorted(current, key=lambda r: tuple(str(r[k]) for k in KEY)):
+        earlier = sorted((r for r in by_key[tuple(row[k] for k in KEY)]
+                          if r["BatchID"] != batch_id and r["Started"] < row["Started"]),
+                         key=lambda r: r["Started"])[-window:]
+        judged = False
+        for metric, worse in METRICS:
+            value = row[metric]
+            history = [r[metric] for r in earlier if r[metric] is not None and math.isfinite(r[metric])]
+            if value is None or not math.isfinite(value) or len(history) < min_history:
+                continue
+            judged = True
+            checks.append({
+                "Timestamp": row["Started"],
+                "BatchID": batch_id,
+                **{k: row[k] for k in KEY},
+                "Metric": metric,
+                "Value": value,
+                "Baseline Batches": len(history),
+                **judge(value, history, worse, mad_k, min_rel),
+            })
+        unjudged += not judged
+    return checks, unjudged
+
+
+def print_report(batch_id: str, checks: list, unjudged: int) -> None:
+    """!Prints one line per flagged metric and a summary line."""
+    for check in checks:
+        if check["Status"] == "ok":
+            continue
+        tag = "[REGRESSION]" if check["Status"] == "regression" else "[INFO] Improvement:"
+        where = f"{check['Method']} @ {check['Host'] or '?'} ({check['ThreadCount']} threads, {check['Trials']} trials"
+        where += f", kernel {check['SIMD Kernel']}" if check["SIMD Kernel"] else ""
+        where += f", pin {check['Pinning']}" if check["Pinning"] else ""
+        where += f", node {check['Node']})" if check["Node"] else ")"
+        print(f"{tag} {where}: {check['Metric']} {check['Value']:.6g} vs baseline {check['Baseline Median']:.6g}"
+              f" (MAD {check['Baseline MAD']:.3g}, {check['Delta %']:+.1f}%, score {check['Score']:+.2f},"
+              f" {check['Baseline Batches']} batches)")
+
+    regressions = sum(check["Status"] == "regression" for check in checks)
+    improvements = sum(check["Status"] == "improvement" for check in checks)
+    print(f"[INFO] Regression check for batch '{batch_id}': {len(checks)} checks, {regressions} regressions, "
+          f"{improvements} improvements, {unjudged} keys without enough history")
+
+
+def store_checks(client, batch_id: str, checks: list) -> None:
+    """!Replaces the batch's rows in `benchmark.regressions` with `checks`."""
+    from pipeline.schema_to_clickhouse import generate_regression_migrations, generate_regression_table
+    from pipeline.schema import REGRESSION_SCHEMA
+
+    client.execute(generate_regression_table(REGRESSION_TABLE))
+    for statement in generate_regression_migrations(REGRESSION_TABLE):
+        client.execute(statement)
+    client.execute(f"ALTER TABLE {REGRESSION_TABLE} DELETE WHERE BatchID = %(batch)s",
+                   {"batch": batch_id}, settings={"mutations_sync": 1})
+    if not checks:
+        return
+    columns = list(REGRESSION_SCHEMA)
+    names = ", ".join(f"`{name}`" for name in columns)
+    client.execute(f"INSERT INTO {REGRESSION_TABLE} ({names}) VALUES",
+                   [[check[name] for check in checks] for name in columns], columnar=True)
+
+
+def main() -> int:
+    """!CLI entrypoint.
+
+    @return Process exit code (EXIT_OK, EXIT_ERROR or EXIT_REGRESSION).
+    """
+    parser = argparse.ArgumentParser(description="Flag Cycles/Trial, IPC and wall-time regressions of a batch")
+    parser.add_argument("--batchid", type=str, help="Batch to check (default: the most recent batch)")
+    parser.add_argument("--files", nargs="+", help="Read history from .arrows / .parquet files instead of ClickHouse")
+    parser.add_argument("--window", type=int, default=DEFAULT_WINDOW, help="Earlier batches per baseline")
+    parser.add_argument("--min-history", type=int, default=DEFAULT_MIN_HISTORY,
+                        help="Earlier batches a key needs before it is judged")
+    parser.add_argument("--mad-k", type=float, default=DEFAULT_MAD_K, help="Robust standard deviations tolerated")
+    parser.add_argument("--min-rel", type=float, default=DEFAULT_MIN_REL,
+                        help="Relative change always tolerated (0.05 = 5%%)")
+    parser.add_argument("--json", type=str, help="Also write every check to this JSON file")
+    parser.add_argument("--no-store", action="store_true", help="Do not write the checks to benchmark.regressions")
+    args = parser.parse_args()
+
+    if args.window < 1 or args.min_history < 1 or args.min_history > args.window:
+        parser.error("need 1 <= --min-history <= --window")
+    if args.mad_k <= 0 or args.min_rel < 0:
+        parser.error("--mad-k must be positive and --min-rel non-negative")
+
+    try:
+        client = None
+        if args.files:
+            from pipeline.insert_to_clickhouse import read_batch
+            rows = batch_medians_from_frame(read_batch(args.files))
+            if not rows:
+                raise LookupError("No rows in the given files")
+            batch_id = args.batchid or latest_batch(rows)
+        else:
+            from clickhouse_driver import Client
+            from scripts.config import CLICKHOUSE_HOST, CLICKHOUSE_TCP_PORT, CLICKHOUSE_USER, CLICKHOUSE_PASSWORD
+            client = Client(host=CLICKHOUSE_HOST, port=CLICKHOUSE_TCP_PORT, user=CLICKHOUSE_USER,
+                            password=CLICKHOUSE_PASSWORD)
+            batch_id = args.batchid
+            if batch_id is None:
+                latest = client.execute(f"SELECT BatchID FROM {PERFORMANCE_TABLE} ORDER BY Timestamp DESC LIMIT 1")
+                if not latest:
+                    raise LookupError(f"{PERFORMANCE_TABLE} is empty")
+                batch_id = latest[0][0]
+            rows = batch_medians_from_clickhouse(client, batch_id)
+
+        checks, unjudged = detect(rows, batch_id, args.window, args.min_history, args.mad_k, args.min_rel)
+        print_report(batch_id, checks, unjudged)
+
+        if client is not None and not args.no_store:
+            store_checks(client, batch_id, checks)
+        if args.json:
+            with open(args.json, "w") as out:
+                json.dump(checks, out, indent=2, default=str)
+    except Exception as e:
+        print(f"[ERROR] Regression check failed: {e}")
+        return EXIT_ERROR
+
+    return EXIT_REGRESSION if any(check["Status"] == "regression" for check in checks) else EXIT_OK
+
+
+if __name__ == "__main__":
+    sys.exit(main())
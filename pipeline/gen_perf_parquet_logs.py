@@ -38,7 +38,9 @@
 ##   --branch_instr 700000000 \
 ##   --branch_misses 50000 \
 ##   --miss_per_trial 0.0009 \
-##   --cycles_per_trial 16.9609
+##   --cycles_per_trial 16.9609 \
+##   --thread_count 8 \
+##   --repetition 0
 ## ```
 ## 
 ## \par Output
@@ -90,6 +92,29 @@ def parse_args():
 
     parser.add_argument("--miss_per_trial", required=True, help="Cache+TLB misses per trial")
     parser.add_argument("--cycles_per_trial", required=True, help="Cycles per trial")
+
+    parser.add_argument("--thread_count", default="NA", help="Worker threads used (omit if unknown)")
+    parser.add_argument("--repetition", default="NA", help="Repetition index within the benchmark (omit if unknown)")
+    parser.add_argument("--node", default="NA", help="Cluster node name, or 'cluster' for the reduced row (omit for local runs)")
+    parser.add_argument("--node_count", default="NA", help="Nodes in a distributed run (omit for local runs)")
+    parser.add_argument("--reduction_overhead_ns", default="NA", help="Coordinator wall time beyond the slowest node (cluster row only)")
+    parser.add_argument("--start_skew_ns", default="NA", help="Last worker's wake-up minus the first's (traced runs only)")
+    parser.add_argument("--join_wait_ns", default="NA", help="Last worker's finish minus the first's (traced runs only)")
+    parser.add_argument("--worker_busy_min_ns", default="NA", help="Least busy worker's chunk time (traced runs only)")
+    parser.add_argument("--worker_busy_max_ns", default="NA", help="Busiest worker's chunk time (traced runs only)")
+    parser.add_argument("--load_imbalance", default="NA", help="Busiest worker's chunk time over the mean (traced runs only)")
+    parser.add_argument("--host", default="NA", help="Machine the run executed on (regression baselines are per host)")
+    parser.add_argument("--cpu_model", default="NA", help="CPU model name (/proc/cpuinfo)")
+    parser.add_argument("--cpu_microarch", default="NA", help="CPU vendor / family / model / stepping, or ARM implementer / part")
+    parser.add_argument("--cpu_cores", default="NA", help="Logical CPUs of the host")
+    parser.add_argument("--cpu_max_freq_mhz", default="NA", help="Maximum CPU clock (cpufreq)")
+    parser.add_argument("--cpu_governor", default="NA", help="cpufreq governor")
+    parser.add_argument("--turbo", default="NA", help="Turbo / boost state: on or off")
+    parser.add_argument("--simd_kernel", default="NA", help="Bound SIMD backend and variant")
+    parser.add_argument("--pinning", default="NA", help="Pin policy, or 'none'")
+    parser.add_argument("--compiler", default="NA", help="Compiler name and version")
+    parser.add_argument("--build_flags", default="NA", help="Compile flags of the binary")
+    parser.add_argument("--git_revision", default="NA", help="Git revision the binary was built from")
     
     return parser.parse_args()
 
@@ -99,7 +124,8 @@ def update_parquet(args):
         raise FileNotFoundError(f"No batch directory found for batch ID {args.batchid}")
     batch_dir = Path(matches[-1])
 
-    parquet_path = batch_dir / f"perf_results_{args.method}_{args.timestamp}_{args.batchid}.parquet"
+    # Honor --out_path: sweep points of one method can share a timestamp
+    parquet_path = batch_dir / Path(args.out_path).name
 
     # 1. Build the raw row (match SCHEMA field names exactly)
     row = {
@@ -132,6 +158,28 @@ def update_parquet(args):
         "Branch Miss %": safe_div_percent(args.branch_misses, args.branch_instr),
         "Misses/Trial": args.miss_per_trial,
         "Cycles/Trial": args.cycles_per_trial,
+        "ThreadCount": args.thread_count,
+        "Repetition": args.repetition,
+        "Node": args.node,
+        "NodeCount": args.node_count,
+        "Reduction Overhead (ns)": args.reduction_overhead_ns,
+        "Start Skew (ns)": args.start_skew_ns,
+        "Join Wait (ns)": args.join_wait_ns,
+        "Worker Busy Min (ns)": args.worker_busy_min_ns,
+        "Worker Busy Max (ns)": args.worker_busy_max_ns,
+        "Load Imbalance": args.load_imbalance,
+        "Host": args.host,
+        "CPU Model": args.cpu_model,
+        "CPU Microarch": args.cpu_microarch,
+        "CPU Cores": args.cpu_cores,
+        "CPU Max Freq (MHz)": args.cpu_max_freq_mhz,
+        "CPU Governor": args.cpu_governor,
+        "Turbo": args.turbo,
+        "SIMD Kernel": args.simd_kernel,
+        "Pinning": args.pinning,
+        "Compiler": args.compiler,
+        "Build Flags": args.build_flags,
+        "Git Revision": args.git_revision,
     }
 
     row = {k: (None if v == "NA" else v) for k, v in row.items()}
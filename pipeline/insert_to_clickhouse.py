@@ -3,28 +3,43 @@
 # ===========================================
 
 ## \file insert_to_clickhouse.py
-## \brief Inserts filtered benchmarking logs into a ClickHouse database.
+## \brief Inserts benchmarking logs of one batch into a ClickHouse database.
 ## 
 ## \details
 ## \par Description
-##     This script reads a Parquet dataset, filters it by BatchID, and inserts
-##     the matching records into the `benchmark.performance` table in ClickHouse.
-##     It uses the clickhouse-driver to perform inserts and ensures that the
-##     table schema matches the format defined in `pipeline.schema`.
+##     This script reads the result files of a batch, casts them to the format
+##     defined in `pipeline.schema`, and inserts them into the `benchmark.performance`
+##     table in ClickHouse in fixed-size blocks. Only the batch's own files are read,
+##     so ingest time depends on the size of the batch, not on the size of `DB_PATH`.
 ## 
 ## \par Usage
+##     $ python3 insert_to_clickhouse.py --batchid <BATCH_ID> --files <results.arrows> [more files]
 ##     $ python3 insert_to_clickhouse.py --batchid <BATCH_ID>
+##     $ python3 insert_to_clickhouse.py --arrow <results.arrows>
 ## 
 ## \par Example
-##     $ python3 insert_to_clickhouse.py --batchid "batch_202405"
+##     $ python3 insert_to_clickhouse.py --batchid "batch_202405" \
+##           --files db/logs/batch_batch_202405_<ts>/perf_results_batch_202405.arrows
+##     $ python3 insert_to_clickhouse.py --batchid "batch_202405" --files results.arrows --http --compression zstd
 ## 
 ## \par Notes
 ##     - ClickHouse connection parameters are loaded from `.env`via `scripts/config.py`
-##     - The Parquet file path is set in `DB_PATH`
-##     - You may call `insert_batch(batch_id)` directly from other scripts or notebooks
+##     - `--files` accepts `.arrows` streams (`montecarlo --arrow-out`) and `.parquet` files;
+##       Parquet files are scanned lazily with the BatchID filter pushed down
+##     - Without `--files`, the batch is scanned out of `DB_PATH` the same way (legacy path)
+##     - `--arrow` bulk-loads every row of one Arrow IPC stream, whatever its BatchIDs
+##     - Rows go out in blocks of `--block-rows` over the native protocol (`CLICKHOUSE_TCP_PORT`),
+##       or with `--http` as Parquet bodies to `CLICKHOUSE_HTTP_PORT` using server-side async inserts
+##     - Idempotent per BatchID: a batch that already has rows in the table is skipped, unless
+##       `--replace` deletes those rows first (e.g. after an interrupted insert)
+##     - You may call `insert_batch(batch_id, paths)` directly from other scripts or notebooks
 
 
 import argparse
+import io
+import urllib.parse
+import urllib.request
+from pathlib import Path
 import polars as pl
 from clickhouse_driver import Client
 from pipeline.schema import SCHEMA
@@ -32,50 +47,230 @@ from pipeline.utils import safe_vector_cast
 from scripts.config import *
 
 
-def insert_batch(batch_id: str) -> None:
-    """!Filters and inserts a batch of records into ClickHouse.
+TABLE = "benchmark.performance"
+DEFAULT_BLOCK_ROWS = 10_000
 
-    Loads data from the Parquet file at DB_PATH, filters by BatchID,
-    and inserts the resulting records into the `benchmark.performance` table.
 
-    @param batch_id The BatchID to filter the dataset on.
+def read_batch(paths, batch_id=None) -> pl.DataFrame:
+    """!Reads the rows of one batch from its result files.
+
+    `.arrows` streams are small (one per batch) and read whole; `.parquet` files are scanned
+    lazily so that only the row groups holding `batch_id` are materialized.
+
+    @param paths Result files (`.arrows` or `.parquet`).
+    @param batch_id Keep only rows of this BatchID, or every row when None.
+
+    @return The rows, cast to SCHEMA.
+
+    @throws ValueError If a file has an unsupported extension.
+    """
+    frames = []
+    for path in map(Path, paths):
+        if path.suffix == ".arrows":
+            frame = pl.read_ipc_stream(path)
+            if batch_id is not None:
+                frame = frame.filter(pl.col("BatchID") == batch_id)
+        elif path.suffix == ".parquet":
+            scan = pl.scan_parquet(path)
+            if batch_id is not None:
+                scan = scan.filter(pl.col("BatchID") == batch_id)
+            frame = scan.collect()
+        else:
+            raise ValueError(f"Unsupported result file: {path}")
+        frames.append(safe_vector_cast(frame, SCHEMA))
+
+    if not frames:
+        return pl.DataFrame(schema={name: dtype for name, (dtype, _) in SCHEMA.items()})
+    return pl.concat(frames, how="vertical")
+
+
+class NativeSink:
+    """!Inserts blocks over the native TCP protocol (clickhouse-driver), column-oriented."""
+
+    def __init__(self, compression=None):
+        """!Opens a client.
+
+        @param compression None, "lz4" or "zstd"; needs the driver's matching extra
+               (`pip install clickhouse-driver[lz4]` / `[zstd]`).
+        """
+        self.client = Client(
+            host=CLICKHOUSE_HOST,
+            port=CLICKHOUSE_TCP_PORT,
+            user=CLICKHOUSE_USER,
+            password=CLICKHOUSE_PASSWORD,
+            compression=compression or False
+        )
+
+    def count(self, batch_id: str) -> int:
+        """!@return Number of rows of `batch_id` already in the table."""
+        return self.client.execute(f"SELECT count() FROM {TABLE} WHERE BatchID = %(batch)s",
+                                   {"batch": batch_id})[0][0]
+
+    def delete(self, batch_id: str) -> None:
+        """!Deletes the rows of `batch_id` and waits for the mutation to finish."""
+        self.client.execute(f"ALTER TABLE {TABLE} DELETE WHERE BatchID = %(batch)s",
+                            {"batch": batch_id}, settings={"mutations_sync": 1})
+
+    def insert(self, block: pl.DataFrame) -> None:
+        """!Inserts one block as a single native-protocol INSERT."""
+        columns = ", ".join(f"`{name}`" for name in block.columns)
+        self.client.execute(f"INSERT INTO {TABLE} ({columns}) VALUES",
+                            [block.get_column(name).to_list() for name in block.columns],
+                            columnar=True)
+
+
+class HttpSink:
+    """!Inserts blocks over HTTP as Parquet bodies, using ClickHouse async inserts.
+
+    The server buffers async inserts and flushes them as one part, so many small blocks do not
+    create many parts; `wait_for_async_insert=1` still reports failures per block.
+    """
+
+    def __init__(self, compression=None):
+        """!Prepares the endpoint.
+
+        @param compression Parquet codec of the request bodies ("lz4", "zstd"), or None.
+        """
+        self.url = f"http://{CLICKHOUSE_HOST}:{CLICKHOUSE_HTTP_PORT}/"
+        self.compression = compression or "uncompressed"
+
+    def _post(self, params: dict, body: bytes = b"") -> str:
+        """!Sends one request; raises on a non-200 reply."""
+        request = urllib.request.Request(
+            self.url + "?" + urllib.parse.urlencode(params), data=body, method="POST",
+            headers={"X-ClickHouse-User": CLICKHOUSE_USER, "X-ClickHouse-Key": CLICKHOUSE_PASSWORD})
+        with urllib.request.urlopen(request) as reply:
+            return reply.read().decode()
+
+    def count(self, batch_id: str) -> int:
+        """!@return Number of rows of `batch_id` already in the table."""
+        return int(self._post({"query": f"SELECT count() FROM {TABLE} WHERE BatchID = {{batch:String}}",
+                               "param_batch": batch_id}))
+
+    def delete(self, batch_id: str) -> None:
+        """!Deletes the rows of `batch_id` and waits for the mutation to finish."""
+        self._post({"query": f"ALTER TABLE {TABLE} DELETE WHERE BatchID = {{batch:String}}",
+                    "param_batch": batch_id, "mutations_sync": 1})
+
+    def insert(self, block: pl.DataFrame) -> None:
+        """!Inserts one block as a Parquet request body."""
+        body = io.BytesIO()
+        block.write_parquet(body, compression=self.compression)
+        self._post({"query": f"INSERT INTO {TABLE} FORMAT Parquet",
+                    "async_insert": 1, "wait_for_async_insert": 1}, body.getvalue())
+
+
+def insert_frame(df: pl.DataFrame, sink, block_rows: int = DEFAULT_BLOCK_ROWS, replace: bool = False) -> int:
+    """!Inserts rows in fixed-size blocks, at most once per BatchID.
+
+    For every BatchID in `df`, rows already in the table mean the batch was ingested before:
+    it is skipped, or with `replace` its old rows are deleted and it is inserted again.
+
+    @param df Rows cast to SCHEMA.
+    @param sink NativeSink or HttpSink.
+    @param block_rows Rows per INSERT.
+    @param replace Re-insert batches that already have rows.
+
+    @return Number of rows inserted.
+
+    @throws Exception If a ClickHouse request fails.
+    """
+    inserted = 0
+    for batch_id in df.get_column("BatchID").unique(maintain_order=True).to_list():
+        rows = df.filter(pl.col("BatchID") == batch_id)
+        existing = sink.count(batch_id)
+        if existing and not replace:
+            print(f"[INFO] Batch '{batch_id}' already has {existing} rows in ClickHouse; skipping (use --replace)")
+            continue
+        if existing:
+            print(f"[INFO] Replacing {existing} existing rows of batch '{batch_id}'")
+            sink.delete(batch_id)
+
+        for block in rows.iter_slices(n_rows=block_rows):
+            sink.insert(block)
+            inserted += block.height
+    return inserted
+
+
+def insert_batch(batch_id: str, paths=None, block_rows: int = DEFAULT_BLOCK_ROWS,
+                 http: bool = False, compression=None, replace: bool = False) -> None:
+    """!Inserts one batch into ClickHouse from its own result files.
+
+    @param batch_id The BatchID to ingest.
+    @param paths The batch's `.arrows` / `.parquet` files; DB_PATH when None.
+    @param block_rows Rows per INSERT.
+    @param http Insert over HTTP instead of the native protocol.
+    @param compression Wire / body compression ("lz4", "zstd"), or None.
+    @param replace Re-insert the batch if it already has rows.
 
     @throws Exception If ClickHouse insert fails.
     """
-    df = pl.read_parquet(DB_PATH)
-    df = df.filter(pl.col("BatchID") == batch_id)
+    df = read_batch(paths or [DB_PATH], batch_id)
+    sink = HttpSink(compression) if http else NativeSink(compression)
+
+    try:
+        inserted = insert_frame(df, sink, block_rows, replace)
+    except Exception as e:
+        print(f"[ERROR] Error inserting records into ClickHouse: {e}")
+        raise
+
+    print(f"[INFO] Inserted {inserted} records into ClickHouse for batch '{batch_id}'.")
 
-    # Optional: enforce schema casting
-    df = safe_vector_cast(df, SCHEMA)
 
-    client = Client(
-        host=CLICKHOUSE_HOST,
-        port=CLICKHOUSE_TCP_PORT,
-        user=CLICKHOUSE_USER,
-        password=CLICKHOUSE_PASSWORD
-    )
+def insert_arrow(path: str, block_rows: int = DEFAULT_BLOCK_ROWS,
+                 http: bool = False, compression=None, replace: bool = False) -> None:
+    """!Bulk-inserts every row of an Arrow IPC stream into ClickHouse.
 
-    records = df.to_dicts()
+    Reads a stream appended by `montecarlo --arrow-out` (one record batch per process),
+    casts it to SCHEMA and inserts it block by block, once per BatchID it contains.
+
+    @param path Path to the `.arrows` stream file.
+    @param block_rows Rows per INSERT.
+    @param http Insert over HTTP instead of the native protocol.
+    @param compression Wire / body compression ("lz4", "zstd"), or None.
+    @param replace Re-insert batches that already have rows.
+
+    @throws Exception If ClickHouse insert fails.
+    """
+    df = read_batch([path])
+    sink = HttpSink(compression) if http else NativeSink(compression)
 
     try:
-        client.execute("INSERT INTO benchmark.performance VALUES", records)
+        inserted = insert_frame(df, sink, block_rows, replace)
     except Exception as e:
         print(f"[ERROR] Error inserting records into ClickHouse: {e}")
         raise
 
-    print(f"[INFO] Inserted {len(records)} records into ClickHouse for batch '{batch_id}'.")
+    print(f"[INFO] Inserted {inserted} records into ClickHouse from '{path}'.")
 
 
 def main():
     """!CLI entrypoint for inserting a batch into ClickHouse.
 
-    Parses --batchid from command-line arguments and performs the insert.
+    Parses --batchid (optionally with --files) or --arrow from command-line arguments
+    and performs the insert.
     """
     parser = argparse.ArgumentParser(description="Insert benchmarking logs into ClickHouse")
-    parser.add_argument("--batchid", type=str, required=True, help="Batch ID to ingest")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--batchid", type=str, help="Batch ID to ingest")
+    source.add_argument("--arrow", type=str, help="Arrow IPC stream (montecarlo --arrow-out) to bulk-load")
+    parser.add_argument("--files", nargs="+", help="The batch's .arrows / .parquet files (default: DB_PATH)")
+    parser.add_argument("--block-rows", type=int, default=DEFAULT_BLOCK_ROWS, help="Rows per INSERT block")
+    parser.add_argument("--http", action="store_true", help="Insert over HTTP with async inserts")
+    parser.add_argument("--compression", choices=["lz4", "zstd"], help="Compress blocks on the wire")
+    parser.add_argument("--replace", action="store_true", help="Re-insert batches that already have rows")
     args = parser.parse_args()
 
-    insert_batch(args.batchid)
+    if args.block_rows < 1:
+        parser.error("--block-rows must be at least 1")
+    if args.files and not args.batchid:
+        parser.error("--files requires --batchid")
+
+    options = dict(block_rows=args.block_rows, http=args.http, compression=args.compression, replace=args.replace)
+    if args.arrow:
+        insert_arrow(args.arrow, **options)
+    else:
+        insert_batch(args.batchid, args.files, **options)
 
 
 if __name__ == "__main__":
@@ -23,6 +23,8 @@
 ##     - All timestamps use millisecond-resolution Datetime
 ##     - Percent fields are stored as Float64 (0–100%)
 ##     - L2/L3-related fields are nullable by default (may not be available on all CPUs)
+##     - Columns added after the initial release are nullable and appended at the end, so older
+##       parquet logs load (backfilled with nulls) and ClickHouse can migrate via ADD COLUMN
 ##     - Field names match CSV headers and ClickHouse columns exactly
 
 
@@ -74,4 +76,54 @@ SCHEMA = {
     "Branch Miss %": (pl.Float64(), False),
     "Misses/Trial": (pl.Float64(), False),
     "Cycles/Trial": (pl.Float64(), False),
+
+    # Added columns (nullable; absent from older logs)
+    "ThreadCount": (pl.Int64(), True),
+    "Repetition": (pl.Int64(), True),
+    "Node": (pl.Utf8(), True),
+    "NodeCount": (pl.Int64(), True),
+    "Reduction Overhead (ns)": (pl.Int64(), True),
+    "Start Skew (ns)": (pl.Int64(), True),
+    "Join Wait (ns)": (pl.Int64(), True),
+    "Worker Busy Min (ns)": (pl.Int64(), True),
+    "Worker Busy Max (ns)": (pl.Int64(), True),
+    "Load Imbalance": (pl.Float64(), True),
+    "Host": (pl.Utf8(), True),
+    "CPU Model": (pl.Utf8(), True),
+    "CPU Microarch": (pl.Utf8(), True),
+    "CPU Cores": (pl.Int64(), True),
+    "CPU Max Freq (MHz)": (pl.Int64(), True),
+    "CPU Governor": (pl.Utf8(), True),
+    "Turbo": (pl.Utf8(), True),
+    "SIMD Kernel": (pl.Utf8(), True),
+    "Pinning": (pl.Utf8(), True),
+    "Compiler": (pl.Utf8(), True),
+    "Build Flags": (pl.Utf8(), True),
+    "Git Revision": (pl.Utf8(), True),
+}
+
+
+"""!Schema of `benchmark.regressions`, written by `detect_regressions.py`.
+
+One row per (batch, baseline key, metric) check: the batch's median against the rolling median
+and MAD of the same key's earlier batches. Keys with too little history are not written.
+"""
+REGRESSION_SCHEMA = {
+    "Timestamp": (pl.Datetime("ms"), False),
+    "BatchID": (pl.Utf8(), False),
+    "Method": (pl.Utf8(), False),
+    "Host": (pl.Utf8(), False),
+    "Trials": (pl.Int64(), False),
+    "ThreadCount": (pl.Int64(), False),
+    "Node": (pl.Utf8(), False),
+    "SIMD Kernel": (pl.Utf8(), False),
+    "Pinning": (pl.Utf8(), False),
+    "Metric": (pl.Utf8(), False),
+    "Value": (pl.Float64(), False),
+    "Baseline Median": (pl.Float64(), False),
+    "Baseline MAD": (pl.Float64(), False),
+    "Baseline Batches": (pl.Int64(), False),
+    "Delta %": (pl.Float64(), False),
+    "Score": (pl.Float64(), False),
+    "Status": (pl.Utf8(), False),
 }
\ No newline at end of file
@@ -25,6 +25,9 @@
 ## ORDER BY (Method, Timestamp);
 ## \endcode
 ##
+## Tables created before a column was added are upgraded with `generate_clickhouse_migrations()`,
+## which emits one `ALTER TABLE ... ADD COLUMN IF NOT EXISTS` per nullable column.
+##
 ## \par Features
 ## - Handles both string-based and Polars-native dtype declarations
 ## - Adds Nullable(...) wrappers where needed
@@ -46,7 +49,7 @@
 ## }
 ## \endcode
 
-from pipeline.schema import SCHEMA
+from pipeline.schema import SCHEMA, REGRESSION_SCHEMA
 import polars as pl
 
 def polars_to_clickhouse_dtype(dtype, nullable):
@@ -90,13 +93,14 @@ def polars_to_clickhouse_dtype(dtype, nullable):
     return f"Nullable({ch_type})" if nullable else ch_type
 
 
-def generate_clickhouse_table(table_name="benchmark.performance"):
+def generate_clickhouse_table(table_name="benchmark.performance", schema=SCHEMA):
     """!Generates a CREATE TABLE SQL statement for ClickHouse.
 
-    Converts the SCHEMA dictionary into a fully-typed ClickHouse DDL statement.
+    Converts a schema dictionary (SCHEMA by default) into a fully-typed ClickHouse DDL statement.
     Each field is converted using polars_to_clickhouse_dtype().
 
     @param table_name The name of the target ClickHouse table.
+    @param schema Column definitions, e.g. SCHEMA or REGRESSION_SCHEMA.
 
     @return A multi-line SQL string to define the table in ClickHouse.
 
@@ -104,7 +108,7 @@ def generate_clickhouse_table(table_name="benchmark.performance"):
     """
     lines = []
 
-    for name, (dtype, nullable) in SCHEMA.items():
+    for name, (dtype, nullable) in schema.items():
         ch_type = polars_to_clickhouse_dtype(dtype, nullable)
         lines.append(f"    `{name}` {ch_type},")
 
@@ -114,5 +118,54 @@ def generate_clickhouse_table(table_name="benchmark.performance"):
 ORDER BY (Method, Timestamp);"""
 
 
+def generate_clickhouse_migrations(table_name="benchmark.performance"):
+    """!Generates ALTER TABLE statements that add missing nullable columns to an existing table.
+
+    `CREATE TABLE IF NOT EXISTS` leaves an older table untouched, so columns added to SCHEMA
+    later (all nullable) are added here. Statements are idempotent and safe to re-run.
+
+    @param table_name The name of the target ClickHouse table.
+
+    @return A list of SQL strings, one per nullable column.
+    """
+    return [
+        f"ALTER TABLE {table_name} ADD COLUMN IF NOT EXISTS `{name}` {polars_to_clickhouse_dtype(dtype, nullable)}"
+        for name, (dtype, nullable) in SCHEMA.items()
+        if nullable
+    ]
+
+
+def generate_regression_table(table_name="benchmark.regressions"):
+    """!Generates the CREATE TABLE statement for the regression flags of `detect_regressions.py`.
+
+    @param table_name The name of the target ClickHouse table.
+
+    @return A multi-line SQL string to define the table in ClickHouse.
+    """
+    return generate_clickhouse_table(table_name, REGRESSION_SCHEMA)
+
+
+def generate_regression_migrations(table_name="benchmark.regressions"):
+    """!Generates ALTER TABLE statements that add the later baseline-key columns to an older table.
+
+    `SIMD Kernel` and `Pinning` joined the key after the table's first version; existing rows get
+    the empty string, the value of rows without them.
+
+    @param table_name The name of the target ClickHouse table.
+
+    @return A list of SQL strings, one per added column.
+    """
+    return [
+        f"ALTER TABLE {table_name} ADD COLUMN IF NOT EXISTS `{name}` "
+        f"{polars_to_clickhouse_dtype(*REGRESSION_SCHEMA[name])} AFTER `{after}`"
+        for name, after in (("SIMD Kernel", "Node"), ("Pinning", "SIMD Kernel"))
+    ]
+
+
 if __name__ == "__main__":
-    print(generate_clickhouse_table())
\ No newline at end of file
+    print(generate_clickhouse_table())
+    print(generate_regression_table())
+    for statement in generate_regression_migrations():
+        print(f"{statement};")
+    for statement in generate_clickhouse_migrations():
+        print(f"{statement};")
\ No newline at end of file
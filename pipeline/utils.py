@@ -21,6 +21,7 @@
 ## 
 ## \par Design Notes
 ##     - Schema mismatches are surfaced with detailed debug output
+##     - Missing nullable columns (added to the schema after a log was written) are backfilled with nulls
 ##     - "NA" strings are treated as nulls when allow_na is True
 ##     - Division errors (e.g., zero division, bad input) are handled gracefully
 
@@ -35,16 +36,21 @@ def safe_vector_cast(df: pl.DataFrame, schema: dict) -> pl.DataFrame:
 
     This function enforces schema alignment between a raw input DataFrame (typically from CSV)
     and a declared schema. If `allow_na` is True in the schema, string values like "NA" will be
-    replaced with nulls prior to casting.
+    replaced with nulls prior to casting. Nullable columns missing from the DataFrame are added
+    as all-null columns, so logs written before a column was introduced still load.
 
     @param df The input Polars DataFrame to cast.
     @param schema Dictionary in the format { column_name: (dtype, allow_na) }.
 
     @return A new Polars DataFrame with all fields casted according to the schema.
 
-    @throws ValueError If any schema field is missing in the DataFrame.
+    @throws ValueError If any non-nullable schema field is missing in the DataFrame.
     """
     try:
+        backfill = [c for c, (_, allow_na) in schema.items() if allow_na and c not in df.columns]
+        if backfill:
+            df = df.with_columns([pl.lit(None).alias(c) for c in backfill])
+
         missing = [c for c in schema if c not in df.columns]
 
         if missing:
@@ -0,0 +1,290 @@
+// ========================================
+// runinfo.hpp - Host and build metadata of a run
+// ========================================
+/**
+ * @file runinfo.hpp
+ * @brief Describes the machine and build a result came from, for the metadata columns of `--arrow-out`.
+ *
+ * Numbers from different hosts, kernels or builds are not comparable, so every result row says
+ * where it came from:
+ * | Column                | Source                                                              |
+ * |-----------------------|---------------------------------------------------------------------|
+ * | `Host`                | `$MC_HOST`, else the host name                                      |
+ * | `CPU Model`           | `model name` (x86) or `CPU part` (ARM) of `/proc/cpuinfo`           |
+ * | `CPU Microarch`       | vendor / family / model / stepping (x86), implementer / part (ARM)  |
+ * | `CPU Cores`           | `std::thread::hardware_concurrency()`                               |
+ * | `CPU Max Freq (MHz)`  | cpufreq `cpuinfo_max_freq`                                          |
+ * | `CPU Governor`        | cpufreq `scaling_governor`                                          |
+ * | `Turbo`               | intel_pstate `no_turbo` or cpufreq `boost`: `on` / `off`            |
+ * | `SIMD Kernel`         | Bound backend and `SIMD` variant (filled in by the caller)          |
+ * | `Pinning`             | `--pin` policy, `none` when unpinned (filled in by the caller)      |
+ * | `Compiler`            | Compiler version macros                                             |
+ * | `Build Flags`         | `MC_BUILD_FLAGS`, assembled by CMakeLists.txt                       |
+ * | `Git Revision`        | `MC_GIT_REVISION`, set by CMakeLists.txt (`-dirty` with local edits) |
+ *
+ * Values the OS does not expose (no cpufreq in most VMs and containers) stay empty / 0 and are
+ * written as nulls. In a distributed run each worker sends its own `RunInfo` in `HELLO`
+ * (`encodeRunInfo()`), so node rows describe the worker; the reduced `cluster` row keeps only
+ * the values every worker shares (`commonRunInfo()`). The git revision is taken when CMake configures; the build re-configures
+ * whenever `.git/HEAD` or the index changes, and `-DMC_GIT_REVISION=...` overrides it for trees
+ * without `.git` (e.g. Docker build contexts).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+#ifndef MC_BUILD_FLAGS
+    #define MC_BUILD_FLAGS ""
+#endif
+
+#ifndef MC_GIT_REVISION
+    #define MC_GIT_REVISION ""
+#endif
+
+/**
+ * @brief First value of every key in `/proc/cpuinfo` (the first CPU's block wins).
+ * @return Key to value; empty where `/proc/cpuinfo` does not exist
+ */
+inline std::map<std::string, std::string> readCpuInfo() {
+    std::map<std::string, std::string> fields;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line);) {
+        std::size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0) continue;
+        std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+        std::string value = line.substr(std::min(line.size(), colon + 2));
+        if (!value.empty()) fields.emplace(key, value);
+    }
+    return fields;
+}
+
+/**
+ * @brief CPU model string, also the autotuning cache key (`autotune.hpp`).
+ * @return `model name` from `/proc/cpuinfo` (x86), else its `CPU part` (ARM), else "unknown"
+ */
+inline std::string cpuModelName() {
+    std::map<std::string, std::string> fields = readCpuInfo();
+    if (auto name = fields.find("model name"); name != fields.end()) return name->second;
+    if (auto part = fields.find("CPU part"); part != fields.end()) return "ARM part " + part->second;
+    return "unknown";
+}
+
+/**
+ * @brief Identifies the core design, which the marketing model name does not always pin down.
+ * @return e.g. `GenuineIntel family 6 model 143 stepping 8` or `ARM implementer 0x41 part 0xd0c`,
+ *         empty if `/proc/cpuinfo` has neither
+ */
+inline std::string cpuMicroarchitecture() {
+    std::map<std::string, std::string> fields = readCpuInfo();
+    auto field = [&](const char* key) {
+        auto it = fields.find(key);
+        return it == fields.end() ? std::string() : it->second;
+    };
+
+    std::string family = field("cpu family");
+    if (!family.empty()) {
+        std::string text = field("vendor_id") + " family " + family + " model " + field("model");
+        std::string stepping = field("stepping");
+        return stepping.empty() ? text : text + " stepping " + stepping;
+    }
+    std::string part = field("CPU part");
+    if (!part.empty()) return "ARM implementer " + field("CPU implementer") + " part " + part;
+    return "";
+}
+
+/**
+ * @brief CPU clock setup as exposed by the OS.
+ */
+struct CpuClock {
+    std::string governor;       ///< cpufreq governor of CPU 0 (empty if unknown)
+    std::string turbo;          ///< `on`, `off`, or empty if unknown
+    double curKHz = 0.0;        ///< Current clock of CPU 0 (0 = unknown)
+    double maxKHz = 0.0;        ///< Maximum clock of CPU 0 (0 = unknown)
+    double cpuinfoMHz = 0.0;    ///< `cpu MHz` of `/proc/cpuinfo`, read only without cpufreq (0 = unknown)
+};
+
+/**
+ * @brief Reads cpufreq and the turbo switch of intel_pstate or acpi-cpufreq from sysfs.
+ * @return Clock setup; fields the OS does not expose stay empty / 0
+ */
+inline CpuClock readCpuClock() {
+    auto readLine = [](const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    };
+
+    CpuClock clock;
+    const std::string cpufreq = "/sys/devices/system/cpu/cpu0/cpufreq/";
+    clock.governor = readLine(cpufreq + "scaling_governor");
+    clock.curKHz = std::atof(readLine(cpufreq + "scaling_cur_freq").c_str());
+    clock.maxKHz = std::atof(readLine(cpufreq + "cpuinfo_max_freq").c_str());
+
+    std::string noTurbo = readLine("/sys/devices/system/cpu/intel_pstate/no_turbo");
+    std::string boost = readLine("/sys/devices/system/cpu/cpufreq/boost");
+    if (!noTurbo.empty()) clock.turbo = noTurbo == "0" ? "on" : "off";
+    else if (!boost.empty()) clock.turbo = boost == "1" ? "on" : "off";
+
+    if (clock.curKHz <= 0.0) {
+        std::map<std::string, std::string> fields = readCpuInfo();
+        if (auto mhz = fields.find("cpu MHz"); mhz != fields.end()) clock.cpuinfoMHz = std::atof(mhz->second.c_str());
+    }
+    return clock;
+}
+
+/**
+ * @brief Compiler that built this binary.
+ * @return e.g. `gcc 12.2.0`, `clang 17.0.6`, `msvc 193933523`
+ */
+inline std::string compilerVersion() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "";
+#endif
+}
+
+/**
+ * @brief Host name for the `Host` column.
+ * @return `$MC_HOST` if set, else the host name, else "unknown"
+ */
+inline std::string localHostName() {
+    if (const char* name = std::getenv("MC_HOST"); name && *name) return name;
+#if defined(__unix__) || defined(__APPLE__)
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0 && name[0] != '\0') return name;
+#else
+    if (const char* name = std::getenv("COMPUTERNAME"); name && *name) return name;
+#endif
+    return "unknown";
+}
+
+/**
+ * @brief Host and build metadata written with every result row.
+ */
+struct RunInfo {
+    std::string host;            ///< `Host`
+    std::string cpuModel;        ///< `CPU Model`
+    std::string cpuMicroarch;    ///< `CPU Microarch`
+    std::int64_t cpuCores = 0;   ///< `CPU Cores` (0 = unknown)
+    std::int64_t maxFreqMHz = 0; ///< `CPU Max Freq (MHz)` (0 = unknown)
+    std::string governor;        ///< `CPU Governor`
+    std::string turbo;           ///< `Turbo`
+    std::string simdKernel;      ///< `SIMD Kernel` (empty unless the caller sets it)
+    std::string pinning;         ///< `Pinning` (empty unless the caller sets it)
+    std::string compiler;        ///< `Compiler`
+    std::string buildFlags;      ///< `Build Flags`
+    std::string gitRevision;     ///< `Git Revision`
+
+    /**
+     * @brief Reads everything the process can find out by itself (all but `simdKernel` / `pinning`).
+     * @return Metadata of this host and binary
+     */
+    static RunInfo capture() {
+        RunInfo info;
+        CpuClock clock = readCpuClock();
+        info.host = localHostName();
+        info.cpuModel = cpuModelName();
+        info.cpuMicroarch = cpuMicroarchitecture();
+        info.cpuCores = static_cast<std::int64_t>(std::thread::hardware_concurrency());
+        info.maxFreqMHz = static_cast<std::int64_t>(clock.maxKHz / 1e3 + 0.5);
+        info.governor = clock.governor;
+        info.turbo = clock.turbo;
+        info.compiler = compilerVersion();
+        info.buildFlags = MC_BUILD_FLAGS;
+        info.gitRevision = MC_GIT_REVISION;
+        return info;
+    }
+};
+
+/**
+ * @brief Serializes a `RunInfo` as one tab-separated line (tabs / newlines in values become spaces).
+ * @param info Metadata to send
+ * @return Fields in `RunInfo` declaration order
+ */
+inline std::string encodeRunInfo(const RunInfo& info) {
+    auto clean = [](std::string value) {
+        std::replace_if(value.begin(), value.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+        return value;
+    };
+    const std::string fields[] = {info.host, info.cpuModel, info.cpuMicroarch, std::to_string(info.cpuCores),
+                                  std::to_string(info.maxFreqMHz), info.governor, info.turbo, info.simdKernel,
+                                  info.pinning, info.compiler, info.buildFlags, info.gitRevision};
+    std::string line = clean(fields[0]);
+    for (std::size_t i = 1; i < std::size(fields); ++i) line += "\t" + clean(fields[i]);
+    return line;
+}
+
+/**
+ * @brief Parses a line written by `encodeRunInfo()`.
+ * @param line Tab-separated fields
+ * @param info Decoded metadata on success
+ * @return false if the field count does not match
+ */
+inline bool decodeRunInfo(const std::string& line, RunInfo& info) {
+    std::vector<std::string> fields;
+    std::istringstream stream(line);
+    for (std::string field; std::getline(stream, field, '\t');) fields.push_back(field);
+    if (!line.empty() && line.back() == '\t') fields.emplace_back();
+    if (fields.size() != 12) return false;
+
+    info.host = fields[0];
+    info.cpuModel = fields[1];
+    info.cpuMicroarch = fields[2];
+    info.cpuCores = std::atoll(fields[3].c_str());
+    info.maxFreqMHz = std::atoll(fields[4].c_str());
+    info.governor = fields[5];
+    info.turbo = fields[6];
+    info.simdKernel = fields[7];
+    info.pinning = fields[8];
+    info.compiler = fields[9];
+    info.buildFlags = fields[10];
+    info.gitRevision = fields[11];
+    return true;
+}
+
+/**
+ * @brief Metadata of a row combining several machines' work (the `cluster` row).
+ * @param infos Metadata of every contributor (non-empty)
+ * @return Each field where all contributors agree, empty / 0 (written as null) where they differ
+ */
+inline RunInfo commonRunInfo(const std::vector<RunInfo>& infos) {
+    RunInfo common = infos.front();
+    for (const RunInfo& info : infos) {
+        auto merge = [](auto& kept, const auto& other) {
+            if (kept != other) kept = {};
+        };
+        merge(common.host, info.host);
+        merge(common.cpuModel, info.cpuModel);
+        merge(common.cpuMicroarch, info.cpuMicroarch);
+        merge(common.cpuCores, info.cpuCores);
+        merge(common.maxFreqMHz, info.maxFreqMHz);
+        merge(common.governor, info.governor);
+        merge(common.turbo, info.turbo);
+        merge(common.simdKernel, info.simdKernel);
+        merge(common.pinning, info.pinning);
+        merge(common.compiler, info.compiler);
+        merge(common.buildFlags, info.buildFlags);
+        merge(common.gitRevision, info.gitRevision);
+    }
+    return common;
+}
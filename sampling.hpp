@@ -0,0 +1,341 @@
+// ========================================
+// sampling.hpp - Variance-reducing sampling strategies
+// ========================================
+/**
+ * @file sampling.hpp
+ * @brief Stratified, Latin-hypercube, Sobol and Halton darts, counted by the SIMD count stages.
+ *
+ * Every other method throws i.i.d. uniform darts, so the error of π̂ shrinks as 1/√N. Spreading
+ * the darts more evenly over the unit square lowers the variance of the hit count without
+ * changing the estimator (`4 · hits / trials`); for the smooth-boundary quarter circle the
+ * error falls faster than 1/√N, so the same precision needs fewer trials:
+ *
+ * | Strategy         | Darts per chunk                                           | RMSE (approx.)     |
+ * |------------------|-----------------------------------------------------------|--------------------|
+ * | `Stratified`     | one jittered dart per cell of a ⌊√n⌋ × ⌊√n⌋ grid          | n^-3/4 per chunk   |
+ * | `LatinHypercube` | one dart per row and column band of each buffer           | ~ N^-1/2, smaller C |
+ * | `Sobol`          | 2-D Sobol sequence, random digital shift                  | ~ N^-3/4           |
+ * | `Halton`         | bases 2 / 3 radical inverses, random Cranley–Patterson shift | ~ N^-3/4 (log terms) |
+ *
+ * ---
+ *
+ * ## Pipeline
+ * Each kernel reuses the two-stage structure of `buffered.hpp`: a sampler fills the SoA
+ * `x[]`, `y[]` buffers, then the backend's `BufferedStages<ISA>::count` — the same unrolled
+ * `x² + y² ≤ 1` compare-and-accumulate `SIMDBuffered` uses — counts them. The jittered
+ * strategies take their uniforms from the backend's vector xoshiro256+ fill stage and only
+ * shift and scale them into their cells afterwards; Sobol and Halton points are generated with
+ * integer Gray-code / digit-carry updates (amortized O(1) per point) in 64-bit fixed point.
+ *
+ * ## Randomization and Chunks
+ * Each design is laid out per pool chunk (per buffer for Latin hypercube, whose permutation
+ * must fit next to the buffers) and randomized from `chunkSeed()`: fresh jitter, a fresh
+ * permutation, a fresh digital / rotation shift. Chunks are therefore independent, unbiased
+ * replicates — any subset of chunks (early stop, work stealing) still gives an unbiased π̂,
+ * results under `--seed` stay reproducible, and each full 2^20-trial chunk is a complete
+ * Sobol net. The cost is that the "error falls faster than 1/√N" gain stops growing past one
+ * chunk: beyond `kDefaultChunkTrials`, more chunks average independent replicates (1/√chunks).
+ *
+ * ## Early Stop
+ * `estimator.hpp` computes its confidence interval from the binomial variance of i.i.d. darts,
+ * which overstates the variance of these designs, so `--epsilon` stops them conservatively late.
+ *
+ * ## Example
+ * ```cpp
+ * std::int64_t hits = *monteCarloPI_SOBOL(1 << 20);   // one full Sobol net on the active backend
+ * ```
+ */
+
+#pragma once
+
+#include "buffered.hpp"
+#include "montecarlo.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * @brief Converts a 64-bit fixed-point fraction to a double in [0, 1).
+ * @param bits Fraction · 2^64
+ * @return Top 53 bits as a double
+ */
+inline double fixedPointToUnit(std::uint64_t bits) {
+    return static_cast<double>(bits >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief Jittered grid: one uniform dart per cell of a `side × side` grid over the chunk.
+ *
+ * Cells are visited row by row across buffers; the `n − side²` darts left over when the chunk
+ * size is not a square are plain uniform darts.
+ */
+struct StratifiedSampler {
+    std::int64_t side;          ///< Cells per axis, ⌊√trials⌋
+    double cellWidth;           ///< 1 / side
+    std::int64_t row = 0;       ///< Row of the next cell
+    std::int64_t column = 0;    ///< Column of the next cell
+
+    /**
+     * @brief Lays out the grid for one call.
+     * @param trials Darts in this call
+     */
+    StratifiedSampler(SplitMix64&, std::int64_t trials, PoolAllocator&, std::size_t) {
+        side = static_cast<std::int64_t>(std::sqrt(static_cast<double>(trials)));
+        while (side * side > trials) --side;
+        while ((side + 1) * (side + 1) <= trials) ++side;
+        cellWidth = side > 0 ? 1.0 / static_cast<double>(side) : 1.0;
+    }
+
+    /**
+     * @brief Fills the next `n` darts: uniform jitter from the fill stage, moved into cells.
+     * @param stages    Backend stages (fill provides the jitter)
+     * @param x         Buffer for x coordinates
+     * @param y         Buffer for y coordinates
+     * @param n         Darts in this buffer
+     * @param generated `n` rounded up to the fill stage's lane count
+     */
+    template <typename Stages>
+    void fill(Stages& stages, double* x, double* y, std::size_t n, std::size_t generated) {
+        stages.fill(x, y, generated);
+
+        std::size_t i = 0;
+        while (i < n && row < side) {
+            std::size_t run = static_cast<std::size_t>(std::min<std::int64_t>(static_cast<std::int64_t>(n - i), side - column));
+            const double rowBase = static_cast<double>(row);
+            const double columnBase = static_cast<double>(column);
+            double* cellX = x + i;
+            double* cellY = y + i;
+            // 32-bit offsets (a run never exceeds one 2^30-dart buffer) convert to double in any vector ISA
+            for (std::int32_t k = 0; k < static_cast<std::int32_t>(run); ++k) {
+                cellX[k] = (columnBase + static_cast<double>(k) + cellX[k]) * cellWidth;
+                cellY[k] = (rowBase + cellY[k]) * cellWidth;
+            }
+            i += run;
+            column += static_cast<std::int64_t>(run);
+            if (column == side) {
+                column = 0;
+                ++row;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Latin hypercube per buffer: dart i sits in column band i and row band π(i).
+ *
+ * Every one of the `n` bands per axis holds exactly one dart. The row permutation is shuffled
+ * per buffer (Fisher–Yates) into pool memory next to the coordinate buffers.
+ */
+struct LatinHypercubeSampler {
+    Xoshiro256Plus shuffle;          ///< Permutation generator
+    std::uint32_t* permutation;      ///< Row band of each dart (buffer-sized)
+
+    /**
+     * @brief Seeds the shuffle and allocates the permutation.
+     * @param seeder       Seed sequence (consumed after the fill stage)
+     * @param pool         Calling kernel's pool
+     * @param bufferTrials Darts per buffer
+     */
+    LatinHypercubeSampler(SplitMix64& seeder, std::int64_t, PoolAllocator& pool, std::size_t bufferTrials)
+        : shuffle(seeder), permutation(pool.allocate_array<std::uint32_t>(bufferTrials, 64)) {
+        if (!permutation) throw PoolExhausted();
+    }
+
+    /**
+     * @brief Fills one buffer as an `n`-dart Latin hypercube.
+     * @param stages    Backend stages (fill provides the jitter)
+     * @param x         Buffer for x coordinates
+     * @param y         Buffer for y coordinates
+     * @param n         Darts in this buffer
+     * @param generated `n` rounded up to the fill stage's lane count
+     */
+    template <typename Stages>
+    void fill(Stages& stages, double* x, double* y, std::size_t n, std::size_t generated) {
+        stages.fill(x, y, generated);
+
+        for (std::size_t i = 0; i < n; ++i) permutation[i] = static_cast<std::uint32_t>(i);
+        for (std::size_t i = n; i > 1; --i) {
+            // Multiply-shift maps 32 random bits onto [0, i); the bias (< i / 2^32) is negligible
+            std::uint64_t j = ((shuffle.next() >> 32) * static_cast<std::uint64_t>(i)) >> 32;
+            std::swap(permutation[i - 1], permutation[j]);
+        }
+
+        // Bands fit 32 bits (buffers are at most 2^30 darts), so the conversions vectorize
+        const double bandWidth = 1.0 / static_cast<double>(n);
+        for (std::int32_t i = 0; i < static_cast<std::int32_t>(n); ++i) {
+            x[i] = (static_cast<double>(i) + x[i]) * bandWidth;
+            y[i] = (static_cast<double>(static_cast<std::int32_t>(permutation[i])) + y[i]) * bandWidth;
+        }
+    }
+};
+
+/**
+ * @brief Two-dimensional Sobol sequence in Gray-code order with a random digital shift.
+ *
+ * Dimension 1 is the van der Corput sequence, dimension 2 uses the primitive polynomial x + 1.
+ * Point i+1 differs from point i by one direction number (the lowest set bit of i+1), so each
+ * point costs one XOR per axis. XOR-ing both axes with a random shift keeps every aligned
+ * block of 2^k points a (0, k, 2)-net.
+ */
+struct SobolSampler {
+    std::array<std::uint64_t, 64> directionX{};   ///< Direction numbers, dimension 1
+    std::array<std::uint64_t, 64> directionY{};   ///< Direction numbers, dimension 2
+    std::uint64_t pointX;                         ///< Current x · 2^64 (shift included)
+    std::uint64_t pointY;                         ///< Current y · 2^64 (shift included)
+    std::uint64_t index = 0;                      ///< Index of the current point
+
+    /**
+     * @brief Builds the direction numbers and draws the digital shift.
+     * @param seeder Seed sequence (consumed after the fill stage)
+     */
+    SobolSampler(SplitMix64& seeder, std::int64_t, PoolAllocator&, std::size_t) {
+        std::uint64_t v = std::uint64_t{1} << 63;
+        for (int j = 0; j < 64; ++j) {
+            directionX[j] = std::uint64_t{1} << (63 - j);
+            directionY[j] = v;
+            v ^= v >> 1;
+        }
+        pointX = seeder.next();
+        pointY = seeder.next();
+    }
+
+    /**
+     * @brief Fills the next `n` points of the sequence.
+     * @param x Buffer for x coordinates
+     * @param y Buffer for y coordinates
+     * @param n Darts in this buffer
+     */
+    template <typename Stages>
+    void fill(Stages&, double* x, double* y, std::size_t n, std::size_t) {
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = fixedPointToUnit(pointX);
+            y[i] = fixedPointToUnit(pointY);
+            int bit = __builtin_ctzll(++index);
+            pointX ^= directionX[bit];
+            pointY ^= directionY[bit];
+        }
+    }
+};
+
+/**
+ * @brief Radical inverse φ_b(i) of consecutive indices, in 64-bit fixed point.
+ *
+ * Keeps the base-b digits of i and their weights `2^64 / b^(k+1)`; incrementing i carries
+ * through trailing (b − 1) digits, amortized b / (b − 1) digit updates per point.
+ */
+struct RadicalInverse {
+    std::uint64_t base;                      ///< Digit base
+    std::array<std::uint64_t, 64> weights{}; ///< Fixed-point weight of digit k
+    std::array<std::uint8_t, 64> digits{};   ///< Base-b digits of the index, least significant first
+    std::uint64_t value = 0;                 ///< φ_b(index) · 2^64
+
+    /**
+     * @brief Starts at index 0 (φ = 0).
+     * @param base Digit base: 2 or an odd number
+     */
+    explicit RadicalInverse(std::uint64_t base) : base(base) {
+        // ⌊(2^64 − 1) / b^(k+1)⌋ equals ⌊2^64 / b^(k+1)⌋ unless b^(k+1) divides 2^64, i.e. b = 2
+        std::uint64_t remainderScale = ~std::uint64_t{0};
+        for (auto& weight : weights) {
+            remainderScale /= base;
+            weight = remainderScale + (base == 2 ? 1 : 0);
+        }
+    }
+
+    /**
+     * @brief Advances to the next index.
+     * @return φ_b(index) · 2^64 of the new index
+     */
+    std::uint64_t next() {
+        std::size_t k = 0;
+        while (digits[k] == base - 1) {
+            digits[k] = 0;
+            value -= (base - 1) * weights[k];
+            ++k;
+        }
+        ++digits[k];
+        value += weights[k];
+        return value;
+    }
+};
+
+/**
+ * @brief Two-dimensional Halton sequence (bases 2 and 3) with a random Cranley–Patterson rotation.
+ *
+ * Adding a shift modulo 1 is a plain `uint64_t` add in fixed point (overflow wraps).
+ */
+struct HaltonSampler {
+    RadicalInverse axisX{2};    ///< Base-2 radical inverse
+    RadicalInverse axisY{3};    ///< Base-3 radical inverse
+    std::uint64_t shiftX;       ///< x rotation · 2^64
+    std::uint64_t shiftY;       ///< y rotation · 2^64
+
+    /**
+     * @brief Draws the rotation.
+     * @param seeder Seed sequence (consumed after the fill stage)
+     */
+    HaltonSampler(SplitMix64& seeder, std::int64_t, PoolAllocator&, std::size_t)
+        : shiftX(seeder.next()), shiftY(seeder.next()) {}
+
+    /**
+     * @brief Fills the next `n` points of the sequence.
+     * @param x Buffer for x coordinates
+     * @param y Buffer for y coordinates
+     * @param n Darts in this buffer
+     */
+    template <typename Stages>
+    void fill(Stages&, double* x, double* y, std::size_t n, std::size_t) {
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = fixedPointToUnit(axisX.value + shiftX);
+            y[i] = fixedPointToUnit(axisY.value + shiftY);
+            axisX.next();
+            axisY.next();
+        }
+    }
+};
+
+/**
+ * @brief Sampled two-stage kernel: per buffer, the sampler places darts, then the backend counts.
+ *
+ * Instantiated once per (ISA, sampler) pair; each instantiation keeps its own `thread_local`
+ * pool. Only call an ISA's instantiation when its CPU check passes.
+ *
+ * @tparam Stages  Backend stages from `buffered.hpp` (vector fill for jitter, vector count)
+ * @tparam Sampler `StratifiedSampler`, `LatinHypercubeSampler`, `SobolSampler` or `HaltonSampler`
+ * @param numberOfTrials Total number of darts to throw
+ * @return Pointer to pool-allocated counter storing hits inside the circle
+ */
+template <typename Stages, typename Sampler>
+inline std::int64_t* runSampledStages(std::int64_t numberOfTrials) {
+    thread_local PoolAllocator pool(kBufferedPoolBytes, PoolPages::Huge);
+    std::int64_t* hits = allocateHitCounter(pool);
+
+    const std::size_t bufferTrials = BufferConfig::global().trials;
+    double* bufferX = pool.allocate_array<double>(bufferTrials, 64);
+    double* bufferY = pool.allocate_array<double>(bufferTrials, 64);
+    if (!bufferX || !bufferY) throw PoolExhausted();
+
+    SplitMix64 seeder{chunkSeed()};
+    Stages stages(seeder);
+    Sampler sampler(seeder, numberOfTrials, pool, bufferTrials);
+
+    std::int64_t count = 0;
+    for (std::int64_t done = 0; done < numberOfTrials; done += static_cast<std::int64_t>(bufferTrials)) {
+        std::size_t n = static_cast<std::size_t>(std::min<std::int64_t>(bufferTrials, numberOfTrials - done));
+        std::size_t generated = (n + Stages::lanes - 1) / Stages::lanes * Stages::lanes;
+
+        {
+            MC_TRACE_SCOPE_ARG("rng.fill", generated);
+            sampler.fill(stages, bufferX, bufferY, n, generated);
+        }
+        MC_TRACE_SCOPE_ARG("count", n);
+        count += stages.count(bufferX, bufferY, n);
+    }
+
+    *hits = count;
+    return hits;
+}
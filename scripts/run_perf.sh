@@ -7,8 +7,9 @@
 ## \brief Dockerized perf benchmarker for Monte Carlo simulation engine
 ##
 ## \details
-## Benchmarks simulation methods (SIMD, Pool, Heap, etc.) using `perf stat`,
-## and logs system performance metrics to structured logs (CSV, Parquet).
+## Benchmarks simulation methods (SIMD, Pool, Heap, etc.) with the binary's in-process
+## hardware counters (`--counters`, perf_event_open around the timed region only),
+## and logs system performance metrics to structured logs (Arrow IPC, Parquet).
 ##
 ## === Metrics Logged ===
 ##
@@ -19,8 +20,8 @@
 ##   - cycles_per_trial:    Avg CPU cycles used per simulation trial
 ##
 ## Time
-##   - wall_time_s:         Real-world elapsed time (sec)
-##   - wall_time_ns:        Real-world elapsed time (nanoseconds, high-precision)
+##   - wall_time_s:         Elapsed time of the timed region (sec)
+##   - wall_time_ns:        Elapsed time of the timed region (nanoseconds, high-precision)
 ##
 ## Cache Accesses
 ##   - l1_loads:            L1 data cache load attempts
@@ -54,6 +55,9 @@
 ##   $ perf list | grep -i l2
 ##   $ lscpu     # check microarchitecture
 ##
+## Unsupported events are logged as NA; if perf_event_open is blocked entirely the binary
+## prints a [WARN] and every counter is NA (check /proc/sys/kernel/perf_event_paranoid).
+##
 ## === ClickHouse Integration ===
 ##
 ## By default, results are inserted into ClickHouse at the end of each batch run.
@@ -64,19 +68,65 @@
 ## To skip ClickHouse insertion (e.g., CI, dry runs):
 ##   ./run_perf.sh 50000000 SIMD insert_db=false
 ##
+## === Threads & Scaling Sweeps ===
+##
+## Options are `key=value` and may follow the positional arguments in any order:
+##   threads=N            Worker threads (default: nproc); logged in the ThreadCount column
+##   pin=POLICY           Pin workers: compact | scatter | CPU list (recommended for regression runs)
+##   sweep=strong|weak    Run each method at 1, 2, 4, ..., threads workers (one perf run per point)
+##                        strong: TRIALS total at every point; weak: TRIALS per thread
+##   reps=N               Timed repetitions per run (default: 1); one Parquet row each, logged
+##                        in the Repetition column, so ClickHouse stores the distribution
+##   warmup=N             Untimed warmup calls per run before the repetitions (default: 0)
+##   micro=true           Also run ./build/microbench (RNG, allocator and count-kernel costs);
+##                        its rows land in the same batch with Method = Micro/<Group>/<Case>
+##   host=NAME            Host label logged in the Host column (default: $MC_HOST, else hostname);
+##                        baselines are per host, so give containers a stable NAME
+##   regress=false        Skip the regression check (pipeline/detect_regressions.py)
+##   spec=PATH            Run this JSON matrix (sweepspec.hpp) instead of the positional
+##                        arguments / threads / sweep / pin / reps / warmup
+##
+## === Single-Process Runs ===
+##
+## The arguments are turned into a sweep spec (db/logs/batch_*/sweep_spec_<BATCHID>.json) that
+## one `montecarlo --spec` process runs end to end: one thread pool per thread count, counters
+## opened once, warm caches between points, every row appended to the batch's Arrow stream.
+##
+## === Regression Check ===
+##
+## After the batch, every (Method, Host, Trials, ThreadCount, Node, SIMD Kernel, Pinning) key is
+## compared with the rolling median / MAD of its previous 20 batches; Cycles/Trial, IPC and Wall
+## Time drifting past the tolerance are printed as [REGRESSION] and stored in
+## benchmark.regressions (Grafana "Regression Flags" panel). With insert_db=false the history is
+## read from the local db/logs/batch_*/perf_results_*.arrows streams instead and nothing is stored.
+##
+## === Exit Codes ===
+##   0  Batch finished, no regression flagged
+##   1  Error (build missing, benchmark failed, insert or regression check failed)
+##   3  Batch finished and inserted, but at least one metric regressed
+##
 ## === Usage ===
 ##   ./run_perf.sh                             # Run all methods with default trials, insert to DB
 ##   ./run_perf.sh 50000000                    # All methods, custom trials
 ##   ./run_perf.sh SIMD                        # Single method, default trials
 ##   ./run_perf.sh 50000000 Pool               # Custom trials and single method
 ##   ./run_perf.sh 50000000 SIMD insert_db=false  # Run without inserting to ClickHouse
+##   ./run_perf.sh 50000000 Pool sweep=strong threads=64 pin=scatter   # Strong-scaling curve
+##   ./run_perf.sh 50000000 SIMD reps=15 warmup=2   # 15 rows per method for regression alerts
+##   ./run_perf.sh 50000000 SIMD micro=true    # Plus the microbenchmarks, same batch
+##   ./run_perf.sh spec=samples/sweep_spec.json   # Methods x trials x threads x kernels matrix
+##   ./run_perf.sh 50000000 SIMD reps=5 host=ci-runner-1 || [[ $? -eq 3 ]]   # Tolerate regressions
 ##
 ## === Output Files ===
-##   db/logs/batch_<BATCHID>/perf_<METHOD>_<TIMESTAMP>.csv
-##     → Raw perf stat output
+##   db/logs/batch_<BATCHID>/sweep_spec_<BATCHID>.json
+##     → The matrix built from the arguments (not written with spec=PATH)
 ##
-##   db/logs/batch_<BATCHID>/perf_results_<METHOD>_<TIMESTAMP>_<BATCHID>.parquet
-##     → Parsed structured metrics for that method
+##   db/logs/batch_<BATCHID>/perf_sweep_<TIMESTAMP>.log
+##     → Benchmark output, including the [PERF] counter records and the sweep summary
+##
+##   db/logs/batch_<BATCHID>/perf_results_<BATCHID>.arrows
+##     → Every row of the batch (one per repetition), appended by the binary itself
+##       via --arrow-out; one record batch for the whole sweep
 ##
 ##   db/logs/batch_<BATCHID>/perf_results_all_<BATCHID>.parquet
 ##     → Combined metrics across all methods (for analysis or dashboarding)
@@ -89,21 +139,66 @@ set -e
 
 # -------- Config --------
 DEFAULT_TRIALS=100000000
-ALL_METHODS=("Sequential" "Heap" "Pool" "SIMD")
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 BATCHID=$(uuidgen | cut -d'-' -f1)
 BUILD_PATH="./build/montecarlo"
+MICRO_PATH="./build/microbench"
+
+# Method names come from the binary's registry (methods.hpp), so new methods need no edit here
+if [[ ! -x "$BUILD_PATH" ]]; then
+    echo "[ERROR] $BUILD_PATH not found; build the project first"
+    exit 1
+fi
+mapfile -t ALL_METHODS < <("$BUILD_PATH" --list=names)
+mapfile -t THREADED_METHODS < <("$BUILD_PATH" --list=threaded)
 GLOBAL_TIMESTAMP=$(date "+%Y-%m-%d_%H-%M-%S")
 
 # -------- CLI Args --------
-ARG1="$1"
-ARG2="$2"
-ARG3="$3"
-
 INSERT_DB=true
+THREADS=$(nproc)
+PIN=""
+SWEEP=""
+REPS=1
+WARMUP=0
+MICRO=false
+REGRESS=true
+SPEC=""
+POSITIONAL=()
+
+for ARG in "$@"; do
+    case "$ARG" in
+        insert_db=false) INSERT_DB=false ;;
+        threads=*)       THREADS="${ARG#threads=}" ;;
+        pin=*)           PIN="${ARG#pin=}" ;;
+        sweep=*)         SWEEP="${ARG#sweep=}" ;;
+        reps=*)          REPS="${ARG#reps=}" ;;
+        warmup=*)        WARMUP="${ARG#warmup=}" ;;
+        micro=true)      MICRO=true ;;
+        host=*)          export MC_HOST="${ARG#host=}" ;;
+        regress=false)   REGRESS=false ;;
+        spec=*)          SPEC="${ARG#spec=}" ;;
+        *)               POSITIONAL+=("$ARG") ;;
+    esac
+done
+
+ARG1="${POSITIONAL[0]}"
+ARG2="${POSITIONAL[1]}"
 
-if [[ "$ARG3" == "insert_db=false" ]]; then
-    INSERT_DB=false
+if [[ ! "$THREADS" =~ ^[1-9][0-9]*$ ]]; then
+    echo "[ERROR] Invalid threads=$THREADS"
+    exit 1
+fi
+if [[ ! "$REPS" =~ ^[1-9][0-9]*$ || ! "$WARMUP" =~ ^[0-9]+$ ]]; then
+    echo "[ERROR] Invalid reps=$REPS / warmup=$WARMUP"
+    exit 1
+fi
+if [[ -n "$SPEC" && ! -f "$SPEC" ]]; then
+    echo "[ERROR] Sweep spec not found: $SPEC"
+    exit 1
+fi
+if [[ -n "$SWEEP" && "$SWEEP" != "strong" && "$SWEEP" != "weak" ]]; then
+    echo "[ERROR] Invalid sweep=$SWEEP (expected strong or weak)"
+    exit 1
 fi
 
 if [[ -z "$ARG1" && -z "$ARG2" ]]; then
@@ -112,7 +207,7 @@ if [[ -z "$ARG1" && -z "$ARG2" ]]; then
 elif [[ "$ARG1" =~ ^[0-9]+$ && -z "$ARG2" ]]; then
     TRIALS="$ARG1"
     METHODS=("${ALL_METHODS[@]}")
-elif [[ "$ARG1" =~ ^[a-zA-Z]+$ && -z "$ARG2" ]]; then
+elif [[ "$ARG1" =~ ^[a-zA-Z][a-zA-Z0-9]*$ && -z "$ARG2" ]]; then
     TRIALS=$DEFAULT_TRIALS
     METHODS=("$ARG1")
 else
@@ -121,84 +216,132 @@ else
 fi
 
 # -------- Info --------
-echo "[INFO] Trials   : $TRIALS"
-echo "[INFO] Methods  : ${METHODS[*]}"
+if [[ -n "$SPEC" ]]; then
+    echo "[INFO] Spec     : $SPEC (trials, methods, threads and reps come from the spec)"
+else
+    echo "[INFO] Trials   : $TRIALS"
+    echo "[INFO] Methods  : ${METHODS[*]}"
+    echo "[INFO] Threads  : $THREADS${PIN:+ (pin $PIN)}${SWEEP:+ ($SWEEP sweep)}"
+    echo "[INFO] Reps     : $REPS (+$WARMUP warmup)"
+fi
+echo "[INFO] Micro    : $MICRO"
+echo "[INFO] Host     : ${MC_HOST:-$(hostname)}"
 echo "[INFO] Batch ID : $BATCHID"
 echo "[INFO] Timestamp: $GLOBAL_TIMESTAMP"
 
 LOG_DIR="db/logs/batch_${BATCHID}_${GLOBAL_TIMESTAMP}"
+ARROW_PATH="$LOG_DIR/perf_results_${BATCHID}.arrows"
 mkdir -p "$LOG_DIR"
 
-# -------- Perf Event Creation --------
-PERF_EVENTS=""
-PERF_EVENTS+="cycles,instructions,"
-PERF_EVENTS+="cache-references,cache-misses,"
-PERF_EVENTS+="branch-instructions,branch-misses,"
-PERF_EVENTS+="L1-dcache-loads,L1-dcache-load-misses,"
-PERF_EVENTS+="dTLB-loads,dTLB-load-misses"
-
-echo "[INFO] Using perf events:"
-echo "$PERF_EVENTS" | tr ',' '\n' | sed 's/^/  - /'
-
-# -------- Run Each Method --------
-for METHOD in "${METHODS[@]}"; do
-    METHOD_TIMESTAMP=$(date +"%Y-%m-%d %H:%M:%S")
-    echo "[▶] Running: $METHOD"
-
-    LOG_PATH="$LOG_DIR/perf_${METHOD}_${METHOD_TIMESTAMP}.csv"
-    PERF_PARQUET="$LOG_DIR/perf_results_${METHOD}_${METHOD_TIMESTAMP}_${BATCHID}.parquet"
-
-    mkdir -p "$(dirname "$LOG_PATH")"
-
-    START_NS=$(date +%s%N)
-    perf stat -x, -o "$LOG_PATH" -e $PERF_EVENTS "$BUILD_PATH" "$TRIALS" "$METHOD" > /dev/null
-    END=$(date +%s%N)
-
-    WALL_NS=$((END - START_NS))
-    WALL_S=$(awk "BEGIN {printf \"%.6f\", $WALL_NS / 1000000000}")
-
-    # Pull metrics into shell vars
-    eval "$(python3 pipeline/parse_perf_metrics.py "$LOG_PATH" "$TRIALS")"
-
-    python3 pipeline/gen_perf_parquet_logs.py \
-        --out_path "$PERF_PARQUET" \
-        --wall_time_s "$WALL_S" \
-        --wall_time_ns "$WALL_NS" \
-        --timestamp "$METHOD_TIMESTAMP" \
-        --batchid "$BATCHID" \
-        --method "$METHOD" \
-        --trials "$TRIALS" \
-        --cycles "$CYCLES" \
-        --instr "$INSTR" \
-        --ipc "$IPC" \
-        --cache_loads "$CACHE_LOADS" \
-        --cache_miss "$CACHE_MISS" \
-        --l1_loads "$L1_LOADS" \
-        --l1_misses "$L1_MISSES" \
-        --l2_loads "$L2_LOADS" \
-        --l2_misses "$L2_MISSES" \
-        --l3_loads "$L3_LOADS" \
-        --l3_misses "$L3_MISSES" \
-        --tlb_loads "$TLB_LOADS" \
-        --tlb_misses "$TLB_MISSES" \
-        --branch_instr "$BRANCH_INSTR" \
-        --branch_misses "$BRANCH_MISSES" \
-        --miss_per_trial "$MISS_PER_TRIAL" \
-        --cycles_per_trial "$CYCLES_PER_TRIAL"
-done
+# -------- Counters --------
+# The binary opens cycles, instructions, cache-references/misses, L1-dcache-loads/misses,
+# dTLB-loads/misses and branch-instructions/misses itself (perfcounters.hpp)
+echo "[INFO] Using in-process perf counters (--counters)"
+
+# -------- Thread Counts --------
+# Sweeps run 1, 2, 4, ... up to THREADS (and THREADS itself); otherwise just THREADS
+if [[ -n "$SWEEP" ]]; then
+    THREAD_COUNTS=()
+    for ((T = 1; T < THREADS; T *= 2)); do THREAD_COUNTS+=("$T"); done
+    THREAD_COUNTS+=("$THREADS")
+else
+    THREAD_COUNTS=("$THREADS")
+fi
+
+# -------- Sweep Spec --------
+# The whole matrix runs in one process (montecarlo --spec, sweepspec.hpp): one pool per thread
+# count, counters opened once, caches warm between points, rows appended to one Arrow stream.
+# spec=PATH runs a hand-written matrix instead of the one built from the arguments.
+if [[ -n "$SPEC" ]]; then
+    SPEC_PATH="$SPEC"
+else
+    SPEC_PATH="$LOG_DIR/sweep_spec_${BATCHID}.json"
+    SPEC_METHODS=()
+    for METHOD in "${METHODS[@]}"; do
+        if [[ -n "$SWEEP" && ! " ${THREADED_METHODS[*]} " =~ " $METHOD " ]]; then
+            echo "[INFO] Skipping $METHOD in $SWEEP sweep (single-threaded)"
+            continue
+        fi
+        SPEC_METHODS+=("\"$METHOD\"")
+    done
+    if [[ ${#SPEC_METHODS[@]} -eq 0 ]]; then
+        echo "[ERROR] No method left to run"
+        exit 1
+    fi
+
+    # Weak scaling keeps trials per thread fixed (the binary multiplies by the thread count)
+    {
+        echo "{"
+        echo "  \"methods\": [$(IFS=,; echo "${SPEC_METHODS[*]}")],"
+        echo "  \"trials\": [$TRIALS],"
+        echo "  \"threads\": [$(IFS=,; echo "${THREAD_COUNTS[*]}")],"
+        if [[ -n "$PIN" ]]; then echo "  \"pin\": \"$PIN\","; fi
+        echo "  \"scaling\": \"${SWEEP:-strong}\","
+        echo "  \"reps\": $REPS,"
+        echo "  \"warmup\": $WARMUP"
+        echo "}"
+    } > "$SPEC_PATH"
+fi
+
+LOG_PATH="$LOG_DIR/perf_sweep_${GLOBAL_TIMESTAMP}.log"
+echo "[▶] Running: $SPEC_PATH"
+if ! "$BUILD_PATH" --spec "$SPEC_PATH" --counters \
+    --arrow-out "$ARROW_PATH" --batch-id "$BATCHID" > "$LOG_PATH"; then
+    echo "[ERROR] Sweep failed; see $LOG_PATH"
+    exit 1
+fi
+sed -n '/^Sweep summary/,$p' "$LOG_PATH"
+
+# -------- Microbenchmarks --------
+# Same Arrow stream and batch; the Micro/ prefix keeps these rows apart from the methods
+if [ "$MICRO" = true ]; then
+    if [[ ! -x "$MICRO_PATH" ]]; then
+        echo "[ERROR] $MICRO_PATH not found; build the project first"
+        exit 1
+    fi
+    echo "[▶] Running: microbenchmarks"
+    MICRO_LOG="$LOG_DIR/perf_micro_${GLOBAL_TIMESTAMP}.log"
+    if ! "$MICRO_PATH" "$TRIALS" --reps "$REPS" --warmup "$WARMUP" --counters \
+        --arrow-out "$ARROW_PATH" --batch-id "$BATCHID" > "$MICRO_LOG"; then
+        echo "[ERROR] Microbenchmarks failed; see $MICRO_LOG"
+        exit 1
+    fi
+fi
 
 python3 pipeline/combine_batch_parquets.py \
   "$LOG_DIR" \
   "$LOG_DIR/perf_results_all_${BATCHID}.parquet"
 
 if [ "$INSERT_DB" = true ]; then
+    # Reads only this batch's Arrow stream, not the whole DB_PATH history
     python3 pipeline/insert_to_clickhouse.py \
-    --batchid "$BATCHID"
+    --batchid "$BATCHID" --files "$ARROW_PATH"
 else
   echo "[INFO] Skipping ClickHouse insertion (insert_db=false)"
 fi
 
+# -------- Regression Check --------
+# Exit code 3 is reported after the summary, so the batch's files and rows are kept either way
+REGRESSION_STATUS=0
+if [ "$REGRESS" = true ]; then
+    REGRESS_ARGS=(--batchid "$BATCHID" --json "$LOG_DIR/regressions_${BATCHID}.json")
+    if [ "$INSERT_DB" != true ]; then
+        REGRESS_ARGS+=(--files db/logs/batch_*/perf_results_*.arrows)
+    fi
+    python3 pipeline/detect_regressions.py "${REGRESS_ARGS[@]}" || REGRESSION_STATUS=$?
+    if [[ "$REGRESSION_STATUS" -ne 0 && "$REGRESSION_STATUS" -ne 3 ]]; then
+        echo "[ERROR] Regression check failed"
+        exit 1
+    fi
+else
+    echo "[INFO] Skipping regression check (regress=false)"
+fi
+
 echo "[INFO] Simulation Finished:"
-echo "     └─ Exported CSV & Parquet logs to  : $LOG_DIR"
+echo "     └─ Exported run logs & Arrow rows to : $LOG_DIR"
+echo "     └─ Batch Arrow stream            : $ARROW_PATH"
 echo "     └─ Combined batch Parquet logs  : $LOG_DIR/perf_results_all_${BATCHID}.parquet"
-
+if [ "$REGRESSION_STATUS" -eq 3 ]; then
+    echo "     └─ Regressions flagged           : $LOG_DIR/regressions_${BATCHID}.json"
+    exit 3
+fi
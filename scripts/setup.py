@@ -41,7 +41,9 @@ from pathlib import Path
 from clickhouse_driver import Client
 import polars as pl
 
-from pipeline.schema_to_clickhouse import generate_clickhouse_table
+from pipeline.schema_to_clickhouse import (
+    generate_clickhouse_table, generate_clickhouse_migrations, generate_regression_table, generate_regression_migrations
+)
 from pipeline.schema import SCHEMA
 from pipeline.utils import safe_vector_cast
 from scripts.config import *
@@ -97,6 +99,11 @@ def setup_clickhouse(client: Client):
     log("Setting up ClickHouse database and table.")
     client.execute("CREATE DATABASE IF NOT EXISTS benchmark")
     client.execute(generate_clickhouse_table())
+    for statement in generate_clickhouse_migrations():
+        client.execute(statement)
+    client.execute(generate_regression_table())
+    for statement in generate_regression_migrations():
+        client.execute(statement)
     log("Schema loaded into ClickHouse.")
 
 def load_db_to_clickhouse(client: Client, db_path: Path):
@@ -159,8 +166,7 @@ def main():
     if args.load_from_sample or args.load_from_db:
         ## Create the database and table if they don't exist
         log("Creating database and table if they don't exist.")
-        client.execute("CREATE DATABASE IF NOT EXISTS benchmark")
-        client.execute(generate_clickhouse_table())
+        setup_clickhouse(client)
         
     if args.load_from_sample:
         log(f"Loading from sample data: {SAMPLE_PATH}")
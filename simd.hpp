@@ -0,0 +1,96 @@
+// ========================================
+// simd.hpp - SIMD backend selection
+// ========================================
+/**
+ * @file simd.hpp
+ * @brief Instruction-set includes, per-function target attributes, and CPU feature checks.
+ *
+ * Every SIMD header in the engine includes this file instead of pulling in
+ * `<immintrin.h>` / `<arm_neon.h>` directly, so backend selection lives in one place.
+ *
+ * ## One Binary, Every Kernel
+ * The translation unit is compiled for the architecture baseline only (no `-mavx2`).
+ * x86 kernels are instead compiled with per-function target attributes:
+ * - `MC_TARGET_AVX2`   → `__attribute__((target("avx2")))`
+ * - `MC_TARGET_AVX512` → `__attribute__((target("avx512f")))`
+ *
+ * The compiler never emits AVX2 / AVX-512 instructions outside those functions, so the same
+ * binary starts on any x86-64 CPU. `dispatch.hpp` checks CPUID once at startup and only
+ * hands out kernels the CPU can execute.
+ *
+ * ## Feature Checks
+ * - `cpuSupportsAVX2()`   — CPUID (via `__builtin_cpu_supports`, which also checks OS XSAVE state)
+ * - `cpuSupportsAVX512()` — CPUID AVX-512F
+ * - `cpuSupportsNEON()`   — `HWCAP_ASIMD` on Linux; always true on Apple Silicon
+ *
+ * If neither `USE_AVX` nor NEON is available, only the scalar kernels are built.
+ */
+
+#pragma once
+
+#if defined(USE_AVX)
+    // GCC 12's AVX-512 intrinsics seed masked builtins with `_mm512_undefined_*()`,
+    // which trips a false -Wmaybe-uninitialized once they are inlined into our kernels.
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #include <immintrin.h>
+    #pragma GCC diagnostic pop
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define USE_NEON
+    #include <arm_neon.h>
+    #if defined(__linux__)
+        #include <sys/auxv.h>
+        #include <asm/hwcap.h>
+    #endif
+#endif
+
+#if defined(USE_AVX) && (defined(__GNUC__) || defined(__clang__))
+    #define USE_AVX512
+    #define MC_TARGET_AVX2 __attribute__((target("avx2")))
+    #define MC_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+    #define MC_TARGET_AVX2
+#endif
+
+/**
+ * @brief Checks whether the running CPU (and OS) support AVX2.
+ * @return true if AVX2 kernels may be executed
+ */
+inline bool cpuSupportsAVX2() {
+#if defined(USE_AVX) && (defined(__GNUC__) || defined(__clang__))
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#elif defined(USE_AVX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Checks whether the running CPU (and OS) support AVX-512F.
+ * @return true if AVX-512 kernels may be executed
+ */
+inline bool cpuSupportsAVX512() {
+#ifdef USE_AVX512
+    static const bool supported = __builtin_cpu_supports("avx512f");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Checks whether the running CPU supports 64-bit NEON (ASIMD).
+ * @return true if NEON kernels may be executed
+ */
+inline bool cpuSupportsNEON() {
+#if defined(USE_NEON) && defined(__linux__) && defined(HWCAP_ASIMD)
+    static const bool supported = (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+    return supported;
+#elif defined(USE_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
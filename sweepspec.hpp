@@ -0,0 +1,399 @@
+// ========================================
+// sweepspec.hpp - Benchmark matrix spec (--spec)
+// ========================================
+/**
+ * @file sweepspec.hpp
+ * @brief Reads a JSON benchmark matrix that one `montecarlo --spec` process runs end to end.
+ *
+ * A matrix of methods × trial counts × thread counts × SIMD kernels run as one process per
+ * point spends more time on process start, pool start-up, cold caches and counter setup than on
+ * the darts. `--spec` runs the whole matrix in one process: one `ThreadPool` per thread count,
+ * reused for every kernel, method and trial count; counters opened once; every row appended to
+ * one Arrow stream for the batch.
+ *
+ * ---
+ *
+ * ## Format
+ * ```json
+ * {
+ *   "methods": ["SIMDXoshiro", "SIMDBuffered", "Pool"],
+ *   "trials":  [1e7, 1e8],
+ *   "threads": [1, 2, 4, 8],
+ *   "kernels": ["avx512", "avx2"],
+ *   "pin":     "compact",
+ *   "scaling": "strong",
+ *   "reps":    5,
+ *   "warmup":  1
+ * }
+ * ```
+ * | Key       | Value                                               | Default            |
+ * |-----------|-----------------------------------------------------|--------------------|
+ * | `methods` | Method names, or `"All"`                            | required           |
+ * | `trials`  | Trial count or list of counts (whole numbers)       | required           |
+ * | `threads` | Thread count or list of counts                      | `--threads`        |
+ * | `kernels` | SIMD backend name or list of names                  | `--kernel` / auto  |
+ * | `pin`     | `--pin` policy                                      | `--pin`            |
+ * | `scaling` | `strong` (trials in total) or `weak` (trials per thread, threaded methods) | `strong` |
+ * | `reps`    | Timed repetitions per point                         | `--reps`           |
+ * | `warmup`  | Untimed calls per point                             | `--warmup`         |
+ *
+ * Unknown keys are errors, so a typo never silently shrinks the matrix. Only JSON is read
+ * (no YAML dependency); `//` comments are not allowed.
+ *
+ * ## Matrix
+ * Thread counts are the outer loop (one pool each), then kernels, methods and trial counts.
+ * Kernels only multiply `MethodIsa::SimdBackend` methods, and single-threaded methods run once
+ * per kernel at `ThreadCount` 1 rather than once per thread count — other points would only
+ * repeat the same measurement.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Parsed JSON value.
+ */
+struct JsonValue {
+    /// JSON type.
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;                                  ///< Which of the fields below is set
+    bool boolean = false;                                    ///< `Bool` value
+    double number = 0.0;                                     ///< `Number` value
+    std::string text;                                        ///< `String` value
+    std::vector<JsonValue> items;                            ///< `Array` elements
+    std::vector<std::pair<std::string, JsonValue>> members;  ///< `Object` members, in file order
+};
+
+/**
+ * @brief Recursive-descent JSON parser (RFC 8259, without `\u` surrogate pairs beyond the BMP).
+ */
+class JsonParser {
+public:
+    /**
+     * @brief Parser over `text`.
+     * @param text Complete JSON document
+     */
+    explicit JsonParser(const std::string& text) : input(text) {}
+
+    /**
+     * @brief Parses the document.
+     * @param value Parsed value on success
+     * @param error Message with the byte offset on failure
+     * @return false if the document is not valid JSON
+     */
+    bool parse(JsonValue& value, std::string& error) {
+        bool ok = parseValue(value, 0);
+        if (ok) {
+            skipSpace();
+            if (pos != input.size()) ok = fail("trailing characters");
+        }
+        if (!ok) error = message + " at byte " + std::to_string(pos);
+        return ok;
+    }
+
+private:
+    /// Nesting limit, so a hostile file cannot overflow the stack.
+    static constexpr int kMaxDepth = 64;
+
+    /// Records the first error; always returns false.
+    bool fail(const char* what) {
+        if (message.empty()) message = what;
+        return false;
+    }
+
+    /// Skips JSON whitespace.
+    void skipSpace() {
+        while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\t' || input[pos] == '\n' || input[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    /// Consumes `true`, `false` or `null`.
+    bool literal(const char* word) {
+        std::size_t length = std::char_traits<char>::length(word);
+        if (input.compare(pos, length, word) != 0) return fail("invalid literal");
+        pos += length;
+        return true;
+    }
+
+    /// Parses any value at nesting level `depth`.
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > kMaxDepth) return fail("nesting too deep");
+        skipSpace();
+        if (pos >= input.size()) return fail("unexpected end of input");
+
+        char c = input[pos];
+        if (c == '{') return parseObject(value, depth);
+        if (c == '[') return parseArray(value, depth);
+        if (c == '"') {
+            value.type = JsonValue::Type::String;
+            return parseString(value.text);
+        }
+        if (c == 't' || c == 'f') {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = c == 't';
+            return literal(value.boolean ? "true" : "false");
+        }
+        if (c == 'n') {
+            value.type = JsonValue::Type::Null;
+            return literal("null");
+        }
+        return parseNumber(value);
+    }
+
+    /// Parses a number matching the JSON grammar `-?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d+)?`.
+    bool parseNumber(JsonValue& value) {
+        auto digit = [&](std::size_t at) { return at < input.size() && input[at] >= '0' && input[at] <= '9'; };
+        std::size_t end = pos;
+        if (end < input.size() && input[end] == '-') ++end;
+        if (!digit(end)) return fail("unexpected character");
+        if (input[end] == '0') {
+            ++end;
+        } else {
+            while (digit(end)) ++end;
+        }
+        if (end < input.size() && input[end] == '.') {
+            if (!digit(++end)) return fail("invalid number");
+            while (digit(end)) ++end;
+        }
+        if (end < input.size() && (input[end] == 'e' || input[end] == 'E')) {
+            ++end;
+            if (end < input.size() && (input[end] == '+' || input[end] == '-')) ++end;
+            if (!digit(end)) return fail("invalid number");
+            while (digit(end)) ++end;
+        }
+
+        // strtod only sees the validated text, so hex floats, inf and nan never reach it
+        std::string text = input.substr(pos, end - pos);
+        value.type = JsonValue::Type::Number;
+        value.number = std::strtod(text.c_str(), nullptr);
+        if (!std::isfinite(value.number)) return fail("invalid number");
+        pos = end;
+        return true;
+    }
+
+    /// Parses a quoted string into `out`, decoding escapes to UTF-8.
+    bool parseString(std::string& out) {
+        ++pos;   // opening quote
+        while (pos < input.size()) {
+            char c = input[pos++];
+            if (c == '"') return true;
+            if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= input.size()) break;
+            char escape = input[pos++];
+            switch (escape) {
+                case '"': case '\\': case '/': out += escape; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (pos + 4 > input.size()) return fail("truncated \\u escape");
+                    char* end = nullptr;
+                    std::string hex = input.substr(pos, 4);
+                    unsigned long code = std::strtoul(hex.c_str(), &end, 16);
+                    if (*end != '\0') return fail("invalid \\u escape");
+                    pos += 4;
+                    // UTF-8 encode a BMP code point
+                    if (code < 0x80) {
+                        out += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    /// Parses `[ value, ... ]`.
+    bool parseArray(JsonValue& value, int depth) {
+        value.type = JsonValue::Type::Array;
+        ++pos;
+        skipSpace();
+        if (pos < input.size() && input[pos] == ']') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            value.items.emplace_back();
+            if (!parseValue(value.items.back(), depth + 1)) return false;
+            skipSpace();
+            if (pos < input.size() && input[pos] == ',') {
+                ++pos;
+            } else if (pos < input.size() && input[pos] == ']') {
+                ++pos;
+                return true;
+            } else {
+                return fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    /// Parses `{ "key": value, ... }`; duplicate keys are kept in order.
+    bool parseObject(JsonValue& value, int depth) {
+        value.type = JsonValue::Type::Object;
+        ++pos;
+        skipSpace();
+        if (pos < input.size() && input[pos] == '}') {
+            ++pos;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            if (pos >= input.size() || input[pos] != '"') return fail("expected a member name");
+            std::string key;
+            if (!parseString(key)) return false;
+            skipSpace();
+            if (pos >= input.size() || input[pos] != ':') return fail("expected ':'");
+            ++pos;
+            value.members.emplace_back(std::move(key), JsonValue{});
+            if (!parseValue(value.members.back().second, depth + 1)) return false;
+            skipSpace();
+            if (pos < input.size() && input[pos] == ',') {
+                ++pos;
+            } else if (pos < input.size() && input[pos] == '}') {
+                ++pos;
+                return true;
+            } else {
+                return fail("expected ',' or '}'");
+            }
+        }
+    }
+
+    const std::string& input;   ///< Document
+    std::size_t pos = 0;        ///< Read position
+    std::string message;        ///< First error
+};
+
+/**
+ * @brief Benchmark matrix of `--spec`; empty / negative fields fall back to the CLI options.
+ */
+struct SweepSpec {
+    std::string methods;                 ///< `All` or comma-separated method names (as argv[2])
+    std::vector<std::int64_t> trials;    ///< Trial counts, in run order
+    std::vector<unsigned> threads;       ///< Thread counts (empty = `--threads`)
+    std::vector<std::string> kernels;    ///< SIMD backends (empty = `--kernel` / auto-selected)
+    std::string pin;                     ///< Pin policy (used only if `hasPin`)
+    bool hasPin = false;                 ///< `pin` was given
+    bool weak = false;                   ///< Trial counts are per thread (threaded methods only)
+    int reps = 0;                        ///< Timed repetitions (0 = `--reps`)
+    int warmup = -1;                     ///< Warmup calls (-1 = `--warmup`)
+};
+
+/**
+ * @brief Reads a `--spec` file.
+ * @param path JSON file
+ * @param spec Parsed matrix on success
+ * @return false (after printing an `[ERROR]`) if the file is unreadable, not JSON, or not a valid spec
+ */
+inline bool loadSweepSpec(const std::string& path, SweepSpec& spec) {
+    auto error = [&](const std::string& what) {
+        std::cerr << "[ERROR] Sweep spec " << path << ": " << what << "\n";
+        return false;
+    };
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return error("cannot open file");
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+
+    JsonValue root;
+    std::string parseError;
+    if (!JsonParser(text).parse(root, parseError)) return error(parseError);
+    if (root.type != JsonValue::Type::Object) return error("expected an object at the top level");
+
+    // Scalars are accepted wherever a list is, as a list of one
+    auto elements = [](const JsonValue& value) {
+        return value.type == JsonValue::Type::Array ? value.items : std::vector<JsonValue>{value};
+    };
+    auto whole = [](const JsonValue& value, double low, double high, double& out) {
+        out = value.number;
+        return value.type == JsonValue::Type::Number && out >= low && out <= high && out == std::floor(out);
+    };
+
+    bool hasMethods = false;
+    for (const auto& [key, value] : root.members) {
+        double number = 0.0;
+        if (key == "methods") {
+            for (const JsonValue& item : elements(value)) {
+                if (item.type != JsonValue::Type::String || item.text.empty()) return error("methods must be names");
+                spec.methods += (spec.methods.empty() ? "" : ",") + item.text;
+            }
+            hasMethods = !spec.methods.empty();
+        } else if (key == "trials") {
+            for (const JsonValue& item : elements(value)) {
+                if (!whole(item, 1.0, 9.2e18, number)) return error("trials must be positive whole numbers");
+                spec.trials.push_back(static_cast<std::int64_t>(number));
+            }
+        } else if (key == "threads") {
+            for (const JsonValue& item : elements(value)) {
+                if (!whole(item, 1.0, 65536.0, number)) return error("threads must be whole numbers from 1 to 65536");
+                spec.threads.push_back(static_cast<unsigned>(number));
+            }
+        } else if (key == "kernels") {
+            for (const JsonValue& item : elements(value)) {
+                if (item.type != JsonValue::Type::String || item.text.empty()) return error("kernels must be names");
+                spec.kernels.push_back(item.text);
+            }
+        } else if (key == "pin") {
+            if (value.type != JsonValue::Type::String) return error("pin must be a string");
+            spec.pin = value.text;
+            spec.hasPin = true;
+        } else if (key == "scaling") {
+            if (value.type != JsonValue::Type::String || (value.text != "strong" && value.text != "weak")) {
+                return error("scaling must be \"strong\" or \"weak\"");
+            }
+            spec.weak = value.text == "weak";
+        } else if (key == "reps" || key == "warmup") {
+            bool reps = key == "reps";
+            if (!whole(value, reps ? 1.0 : 0.0, 1'000'000.0, number)) return error(key + " must be a whole number");
+            (reps ? spec.reps : spec.warmup) = static_cast<int>(number);
+        } else {
+            return error("unknown key '" + key + "'");
+        }
+    }
+
+    if (!hasMethods) return error("missing 'methods'");
+    if (spec.trials.empty()) return error("missing 'trials'");
+    return true;
+}
+
+/**
+ * @brief Checks that weak scaling keeps every point's trial count (`trials` × threads) in 64 bits.
+ * @param spec Matrix whose `threads` list is final (after the `--threads` fallback)
+ * @return false if some trial count times some thread count overflows `std::int64_t`
+ */
+inline bool sweepSpecTrialsFit(const SweepSpec& spec) {
+    if (!spec.weak) return true;
+    for (unsigned threads : spec.threads) {
+        for (std::int64_t trials : spec.trials) {
+            if (trials > std::numeric_limits<std::int64_t>::max() / threads) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,379 @@
+// ========================================
+// threadpool.hpp - Persistent work-stealing pool
+// ========================================
+/**
+ * @file threadpool.hpp
+ * @brief Fixed set of worker threads that split Monte Carlo trials into chunks and steal idle work.
+ *
+ * The original runners spawned a fresh `std::vector<std::thread>` per benchmark and split
+ * `totalTrials / threadCount` statically. That costs thread creation on every run, lets one
+ * slow core stretch the tail, and silently drops the `totalTrials % threadCount` remainder.
+ *
+ * `ThreadPool` fixes all three:
+ * - **Persistent workers:** created once, parked on a condition variable between runs
+ * - **Chunked work:** trials are cut into `chunkTrials`-sized chunks; the last chunk takes the
+ *   remainder, so every trial is executed
+ * - **Work stealing:** each worker owns a contiguous range of chunk indices and drains it
+ *   front to back; once empty it steals from the other workers' ranges
+ *
+ * ---
+ *
+ * ## Stealing Model
+ * Each worker's range is an `alignas(64)` `{next, end}` pair. Owner and thieves both claim
+ * chunks with a single `fetch_add` on `next`, so a chunk is taken exactly once without locks.
+ * Ranges sit on separate cache lines; contention only appears once a worker runs dry.
+ *
+ * ## Thread-Local State
+ * Workers outlive individual runs, so the `thread_local` PoolAllocators and RNGs inside the
+ * kernels persist across chunks and across benchmarks.
+ *
+ * ## Result Slots
+ * Each worker sums its chunks' hits in a local and publishes the total once per run into its own
+ * `alignas(64)` `WorkerResult`, so no two workers ever write the same cache line. The caller
+ * sums the slots after the last worker signals completion.
+ *
+ * ## Chunk Streams
+ * Before running a chunk, a worker stores its index in `RunSeed::currentChunk()`. Chunk indices
+ * depend only on `totalTrials` and `chunkTrials`, so kernels seeded per chunk (`philox.hpp`)
+ * produce the same total no matter which worker runs which chunk. `setChunkBase()` offsets the
+ * indices, so a pool can run one slice of a larger run's streams (see `distributed.hpp`).
+ *
+ * ## Early Stop
+ * `runUntil()` takes a stop predicate that workers poll before claiming each chunk. Once it
+ * returns true no new chunks start; chunks already running finish, so a run overshoots its stop
+ * point by at most one chunk per worker. The executed trial count is returned alongside the hits.
+ *
+ * ## Errors
+ * A kernel that throws (e.g. `PoolExhausted`) stops its worker's run; the other workers stop
+ * claiming chunks, and `run()` / `runUntil()` rethrow the first exception on the calling thread
+ * once every worker is idle, so the pool stays usable.
+ *
+ * ## Pinning
+ * Given a CPU list (see `affinity.hpp`), worker `i` pins itself to `cpus[i % cpus.size()]`
+ * before it runs anything, and the constructor waits until every worker has done so. The
+ * thread-local pools are therefore first-touched — and placed — on the worker's own NUMA node.
+ *
+ * ## Counters
+ * When `PerfCounters` is enabled, each worker opens its counter groups (`perfcounters.hpp`) in
+ * the same start-up step, so they exist before any timed region can begin.
+ *
+ * ## Tracing
+ * With `MC_TRACE` and `--trace`, the pool records the `pool.spawn`, `worker.start`, `pool.run`,
+ * `worker.run`, `chunk` and `pool.reduce` spans (`trace.hpp`), and each worker publishes its
+ * run bounds and chunk time next to its hits, so `runUntil()` can add the run's start skew,
+ * join wait and busy spread to the `TraceLog` balance totals. Without tracing these are the
+ * constant-false branches of `TraceSpan` and compile away.
+ *
+ * ## Example
+ * ```cpp
+ * ThreadPool pool(4);                      // or ThreadPool pool(4, {0, 2, 4, 6});
+ * std::int64_t hits = pool.run(100'000'000, kDefaultChunkTrials, [](std::int64_t trials) {
+ *     return *monteCarloPI_POOL(trials);
+ * });
+ * ```
+ */
+
+#pragma once
+
+#include "affinity.hpp"
+#include "perfcounters.hpp"
+#include "philox.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Default chunk size: large enough to amortize per-chunk setup, small enough to balance load.
+constexpr std::int64_t kDefaultChunkTrials = 1 << 20;
+
+/**
+ * @brief Persistent pool of workers that execute chunked trial kernels with work stealing.
+ */
+class ThreadPool {
+public:
+    /// Kernel run on one chunk: receives the chunk's trial count, returns its hit count.
+    using ChunkKernel = std::function<std::int64_t(std::int64_t)>;
+
+    /// Polled before each chunk by `runUntil()`; returning true stops claiming new chunks.
+    using StopCondition = std::function<bool()>;
+
+    /// Trials actually executed and their hits, as returned by `runUntil()`.
+    struct RunTotals {
+        std::int64_t trials = 0;   ///< Trials executed (less than requested if stopped early)
+        std::int64_t hits = 0;     ///< Hits inside the circle
+    };
+
+    /**
+     * @brief Start a fixed number of worker threads, optionally pinned to CPUs.
+     *
+     * Returns once every worker is running (and pinned, if requested).
+     *
+     * @param workerCount Number of workers (at least 1)
+     * @param cpus        CPU per worker, reused cyclically; empty leaves workers unpinned
+     */
+    explicit ThreadPool(unsigned workerCount, std::vector<int> cpus = {})
+        : queues(std::max(1u, workerCount)), results(queues.size()), cpuList(std::move(cpus)) {
+        MC_TRACE_SCOPE_ARG("pool.spawn", queues.size());
+        workers.reserve(queues.size());
+        for (unsigned i = 0; i < queues.size(); ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return started == queues.size(); });
+    }
+
+    /**
+     * @brief Stop and join all workers.
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Number of worker threads.
+     * @return Worker count
+     */
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    /**
+     * @brief Index of the calling pool worker.
+     *
+     * Lets chunk kernels address per-worker state (see `falsesharing.hpp`).
+     *
+     * @return Worker index in [0, size()), or 0 when called outside a pool worker
+     */
+    static unsigned currentWorker() {
+        return workerIndexSlot();
+    }
+
+    /**
+     * @brief Number of workers successfully pinned to their CPU.
+     * @return Pinned worker count (0 when no CPU list was given)
+     */
+    unsigned pinnedCount() const {
+        return pinned.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Offset added to every chunk index (and so to every chunk's RNG stream).
+     * @param base Global index of this pool's first chunk (0 for a standalone run)
+     */
+    void setChunkBase(std::uint64_t base) {
+        chunkBase = base;
+    }
+
+    /**
+     * @brief Run `totalTrials` trials split into chunks across all workers.
+     *
+     * Blocks until every chunk has been executed.
+     *
+     * @param totalTrials Total number of trials (remainder included)
+     * @param chunkTrials Trials per chunk (the last chunk may be smaller)
+     * @param kernel      Chunk kernel returning hits for its trials
+     * @return Sum of hits over all chunks
+     * @throws Whatever the kernel threw first
+     */
+    std::int64_t run(std::int64_t totalTrials, std::int64_t chunkTrials, const ChunkKernel& kernel) {
+        return runUntil(totalTrials, chunkTrials, kernel, {}).hits;
+    }
+
+    /**
+     * @brief Run up to `totalTrials` trials, stopping early once `stop` returns true.
+     *
+     * Blocks until every claimed chunk has finished.
+     *
+     * @param totalTrials Trial budget (remainder included)
+     * @param chunkTrials Trials per chunk (the last chunk may be smaller)
+     * @param kernel      Chunk kernel returning hits for its trials
+     * @param stop        Polled before each chunk; empty runs the full budget
+     * @return Executed trials and their hits
+     * @throws Whatever the kernel threw first
+     */
+    RunTotals runUntil(std::int64_t totalTrials, std::int64_t chunkTrials, const ChunkKernel& kernel,
+                       const StopCondition& stop) {
+        RunTotals totals;
+        if (totalTrials <= 0) return totals;
+        chunkTrials = std::max<std::int64_t>(1, chunkTrials);
+
+        const std::int64_t chunkCount = (totalTrials + chunkTrials - 1) / chunkTrials;
+        const std::int64_t workerCount = static_cast<std::int64_t>(queues.size());
+
+        MC_TRACE_SCOPE_ARG("pool.run", chunkCount);
+        std::unique_lock<std::mutex> lock(mutex);
+        for (std::int64_t w = 0; w < workerCount; ++w) {
+            queues[w].next.store(chunkCount * w / workerCount, std::memory_order_relaxed);
+            queues[w].end = chunkCount * (w + 1) / workerCount;
+        }
+
+        job = Job{&kernel, stop ? &stop : nullptr, totalTrials, chunkTrials, chunkBase};
+        pending = static_cast<unsigned>(workerCount);
+        failure = nullptr;
+        failed.store(false, std::memory_order_relaxed);
+        ++generation;
+
+        wake.notify_all();
+        done.wait(lock, [this]() { return pending == 0; });
+        if (failure) std::rethrow_exception(failure);
+
+        MC_TRACE_SCOPE("pool.reduce");
+        for (const WorkerResult& result : results) {
+            totals.trials += result.trials;
+            totals.hits += result.hits;
+        }
+        if (TraceLog::global().active()) {
+            std::vector<TraceWorkerRun> runs;
+            for (const WorkerResult& result : results) runs.push_back(result.trace);
+            TraceLog::global().addPoolRun(runs);
+        }
+        return totals;
+    }
+
+private:
+    friend class JobScheduler;   // runs jobs.hpp chunks under pool-style worker indices
+
+    /// Parameters of the run currently being executed.
+    struct Job {
+        const ChunkKernel* kernel = nullptr;   ///< Chunk kernel
+        const StopCondition* stop = nullptr;   ///< Early-stop predicate (null = run everything)
+        std::int64_t totalTrials = 0;          ///< Total trials in the run
+        std::int64_t chunkTrials = 0;          ///< Trials per chunk
+        std::uint64_t chunkBase = 0;           ///< Offset of chunk 0's stream index
+    };
+
+    /// Hits published by one worker per run; padded to a full cache line.
+    struct alignas(64) WorkerResult {
+        std::int64_t hits = 0;                 ///< Worker's hit total for the last run
+        std::int64_t trials = 0;               ///< Worker's executed trials for the last run
+        TraceWorkerRun trace;                  ///< Run bounds and chunk time (zero unless tracing)
+    };
+
+    /// Range of chunk indices owned by one worker; padded so owners don't false-share.
+    struct alignas(64) WorkerQueue {
+        std::atomic<std::int64_t> next{0};     ///< Next unclaimed chunk index
+        std::int64_t end = 0;                  ///< One past the last chunk index
+    };
+
+    /**
+     * @brief Worker main loop: wait for a run, drain own range, steal, report.
+     * @param self Index of this worker's queue
+     */
+    void workerLoop(unsigned self) {
+        workerIndexSlot() = self;
+        TraceSpan startSpan("worker.start");
+        TraceLog::nameCurrentThread("worker " + std::to_string(self));
+        if (!cpuList.empty() && pinCurrentThread(cpuList[self % cpuList.size()])) {
+            pinned.fetch_add(1, std::memory_order_relaxed);
+        }
+        PerfCounters::attachCurrentThread();
+        startSpan.finish();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++started == queues.size()) done.notify_one();
+        }
+
+        std::uint64_t seen = 0;
+
+        for (;;) {
+            Job current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                current = job;
+            }
+
+            TraceSpan runSpan("worker.run");
+            std::uint64_t busyTicks = 0;
+            std::int64_t hits = 0;
+            std::int64_t executed = 0;
+            const unsigned workerCount = static_cast<unsigned>(queues.size());
+
+            // Own range first, then steal from the others in round-robin order
+            bool stopped = false;
+            try {
+                for (unsigned k = 0; k < workerCount && !stopped; ++k) {
+                    WorkerQueue& queue = queues[(self + k) % workerCount];
+                    for (;;) {
+                        if (failed.load(std::memory_order_relaxed) || (current.stop && (*current.stop)())) {
+                            stopped = true;
+                            break;
+                        }
+                        std::int64_t chunk = queue.next.fetch_add(1, std::memory_order_relaxed);
+                        if (chunk >= queue.end) break;
+
+                        // Chunk index keys the kernel's RNG stream under --seed (see philox.hpp)
+                        RunSeed::currentChunk() = current.chunkBase + static_cast<std::uint64_t>(chunk);
+                        std::int64_t begin = chunk * current.chunkTrials;
+                        std::int64_t trials = std::min(current.chunkTrials, current.totalTrials - begin);
+                        TraceSpan chunkSpan("chunk", trials);
+                        hits += (*current.kernel)(trials);
+                        busyTicks += chunkSpan.elapsed();
+                        executed += trials;
+                    }
+                }
+            } catch (...) {
+                // Keep the first error for the caller; the other workers see `failed` and stop claiming
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) failure = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+
+            // Publish once; the mutex hand-off below orders it before the caller's read
+            results[self].hits = hits;
+            results[self].trials = executed;
+            results[self].trace = {runSpan.started(), runSpan.finish(), busyTicks};
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pending == 0) done.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief Storage for the calling thread's worker index.
+     * @return Reference to the thread-local index
+     */
+    static unsigned& workerIndexSlot() {
+        thread_local unsigned index = 0;
+        return index;
+    }
+
+    std::vector<WorkerQueue> queues;           ///< One chunk range per worker
+    std::vector<WorkerResult> results;         ///< One published hit total per worker
+    std::vector<std::thread> workers;          ///< Persistent worker threads
+    std::vector<int> cpuList;                  ///< CPU per worker (empty = unpinned)
+    std::atomic<unsigned> pinned{0};           ///< Workers pinned successfully
+    std::atomic<bool> failed{false};           ///< A kernel threw during the current run
+
+    std::mutex mutex;                          ///< Guards job hand-off and completion
+    std::condition_variable wake;              ///< Signals a new run (or shutdown) to workers
+    std::condition_variable done;              ///< Signals run completion to the caller
+
+    Job job;                                   ///< Current run
+    std::exception_ptr failure;                ///< First exception of the current run
+    std::uint64_t chunkBase = 0;               ///< Stream index of chunk 0 (see `setChunkBase()`)
+    std::uint64_t generation = 0;              ///< Run counter; workers wait for it to change
+    unsigned pending = 0;                      ///< Workers still busy with the current run
+    unsigned started = 0;                      ///< Workers that finished startup (pinning)
+    bool stopping = false;                     ///< Set on destruction
+};
@@ -0,0 +1,544 @@
+// ========================================
+// trace.hpp - Hot-path span tracing
+// ========================================
+/**
+ * @file trace.hpp
+ * @brief Per-thread timelines of pool start-up, chunks, RNG fill, count and reduction, as Chrome trace JSON.
+ *
+ * `measure()` brackets a whole method with one clock span, so thread start skew, uneven chunk
+ * work and the time the caller waits at the join are all folded into one number. With tracing
+ * compiled in, every thread records short named spans instead:
+ * | Span           | Thread | Covers                                                       |
+ * |----------------|--------|--------------------------------------------------------------|
+ * | `pool.spawn`   | caller | `ThreadPool` constructor until every worker is running        |
+ * | `worker.start` | worker | Pinning and counter set-up before the worker takes any run    |
+ * | `pool.run`     | caller | Publishing a run until the last worker reports back           |
+ * | `worker.run`   | worker | Wake-up to publishing its hits, own range and steals included |
+ * | `chunk`        | worker | One chunk kernel call (`args.trials`)                         |
+ * | `pool.reset`   | worker | `PoolAllocator::reset()` at the start of a pool kernel        |
+ * | `rng.fill`     | worker | Generate stage of one SoA buffer (`SIMDBuffered`, samplers)   |
+ * | `count`        | worker | Count stage of the same buffer                                |
+ * | `pool.reduce`  | caller | Summing the per-worker result slots                           |
+ * | method label   | caller | The timed call of `measure()`                                 |
+ *
+ * ---
+ *
+ * ## Build Toggle
+ * Spans are compiled only with `MC_TRACE` (`cmake -DMC_ENABLE_TRACE=ON`). Without it
+ * `MC_TRACE_SCOPE` expands to nothing and `TraceLog::active()` is a constant false, so the default
+ * build carries no trace code on the hot path. With it, `--trace PATH` turns recording on.
+ *
+ * ## Clock
+ * Spans read the raw cycle counter — `rdtsc` on x86, `cntvct_el0` on AArch64, `steady_clock`
+ * elsewhere — which costs a few nanoseconds and needs no system call. `TraceLog::open()`
+ * calibrates ticks against `steady_clock` over `kTraceCalibrationMs`, and `flush()` re-calibrates
+ * over the whole run before converting. This assumes an invariant TSC (every x86 CPU of the
+ * last decade; check `constant_tsc nonstop_tsc` in `/proc/cpuinfo`).
+ *
+ * ## Ring Buffers
+ * Each thread writes to its own `TraceRing` of `kTraceRingEvents` slots: one plain store and one
+ * release store of the head, no lock and no sharing. A full ring overwrites its oldest spans;
+ * `flush()` reports how many were dropped. Rings are registered once per thread and outlive it,
+ * so spans of exited threads are still exported. `flush()` reads them after the runs, while every
+ * worker is parked.
+ *
+ * ## Load Balance
+ * The pool also accumulates per-run balance figures (`TraceBalance`) from each worker's
+ * `worker.run` bounds and chunk time. `TraceRegion` takes their delta over one timed call, so
+ * every result row carries start skew, join wait, min/max worker busy time and the imbalance
+ * ratio — the columns the Grafana load-balance panels read.
+ *
+ * ## Output
+ * Chrome trace event JSON (`chrome://tracing`, https://ui.perfetto.dev): one complete (`"X"`)
+ * event per span, one `thread_name` metadata event per thread, times in microseconds since
+ * `open()`.
+ *
+ * ## Example
+ * ```cpp
+ * TraceLog::global().open("trace.json");   // before creating the ThreadPool
+ * TraceRegion region;
+ * std::int64_t hits = pool.run(trials, kDefaultChunkTrials, kernel);
+ * TraceBalance balance = region.stop();
+ * TraceLog::global().flush();              // writes trace.json
+ * ```
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#ifdef MC_TRACE
+constexpr bool kTraceCompiled = true;    ///< Spans are compiled in (`-DMC_TRACE`)
+#else
+constexpr bool kTraceCompiled = false;   ///< Spans are compiled out
+#endif
+
+/// Spans kept per thread (power of two); 32 bytes each.
+constexpr std::size_t kTraceRingEvents = std::size_t{1} << 16;
+
+/// Tick-to-nanosecond calibration window at `TraceLog::open()`.
+constexpr int kTraceCalibrationMs = 20;
+
+/**
+ * @brief Raw cycle counter read.
+ * @return TSC (x86), virtual counter (AArch64), or `steady_clock` nanoseconds elsewhere
+ */
+inline std::uint64_t traceTicks() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Escapes a label for use inside a JSON string literal.
+ * @param text Thread or span label
+ * @return `text` with quotes, backslashes and control characters escaped
+ */
+inline std::string traceJsonEscape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                escaped += code;
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+
+/**
+ * @brief One recorded span.
+ */
+struct TraceEvent {
+    std::uint64_t begin = 0;      ///< Start tick
+    std::uint64_t end = 0;        ///< End tick
+    const char* name = nullptr;   ///< Static or interned label
+    std::int64_t arg = 0;         ///< Trials (or other count) of the span; 0 = none
+};
+
+/**
+ * @brief Single-writer ring of one thread's spans.
+ */
+class TraceRing {
+public:
+    /**
+     * @brief Allocate an empty ring.
+     * @param id    Thread id in the exported trace
+     * @param label Thread name in the exported trace
+     */
+    TraceRing(unsigned id, std::string label)
+        : id(id), label(std::move(label)), events(new TraceEvent[kTraceRingEvents]) {}
+
+    /**
+     * @brief Record a span, overwriting the oldest one when full. Owning thread only.
+     * @param event Span
+     */
+    void push(const TraceEvent& event) {
+        std::uint64_t slot = head.load(std::memory_order_relaxed);
+        events[slot & (kTraceRingEvents - 1)] = event;
+        head.store(slot + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy of the retained spans, oldest first. Call while the owner is idle.
+     * @return Spans
+     */
+    std::vector<TraceEvent> snapshot() const {
+        std::uint64_t end = head.load(std::memory_order_acquire);
+        std::uint64_t begin = end > kTraceRingEvents ? end - kTraceRingEvents : 0;
+        std::vector<TraceEvent> copy;
+        copy.reserve(static_cast<std::size_t>(end - begin));
+        for (std::uint64_t i = begin; i < end; ++i) copy.push_back(events[i & (kTraceRingEvents - 1)]);
+        return copy;
+    }
+
+    /**
+     * @brief Spans overwritten because the ring was full.
+     * @return Dropped span count
+     */
+    std::uint64_t dropped() const {
+        std::uint64_t end = head.load(std::memory_order_acquire);
+        return end > kTraceRingEvents ? end - kTraceRingEvents : 0;
+    }
+
+    const unsigned id;       ///< `tid` in the exported trace
+    std::string label;       ///< `thread_name` in the exported trace (guarded by the log's mutex)
+
+private:
+    std::unique_ptr<TraceEvent[]> events;     ///< `kTraceRingEvents` slots
+    std::atomic<std::uint64_t> head{0};       ///< Spans ever pushed
+};
+
+/**
+ * @brief Bounds and busy time of one worker in one pool run, in ticks.
+ */
+struct TraceWorkerRun {
+    std::uint64_t begin = 0;   ///< `worker.run` start
+    std::uint64_t end = 0;     ///< `worker.run` end
+    std::uint64_t busy = 0;    ///< Sum of the worker's `chunk` spans
+};
+
+/**
+ * @brief Pool load-balance figures, summed over the pool runs of a region.
+ */
+struct TraceBalance {
+    int runs = 0;                 ///< Pool runs covered (0 = nothing traced)
+    long long startSkewNs = 0;    ///< Last worker's wake-up minus the first's
+    long long joinWaitNs = 0;     ///< Last worker's finish minus the first's: idle time at the join
+    long long busyMinNs = 0;      ///< Least busy worker's chunk time
+    long long busyMaxNs = 0;      ///< Busiest worker's chunk time
+    double busyMeanNs = 0.0;      ///< Mean chunk time per worker
+
+    /**
+     * @brief Whether the region covered a traced pool run.
+     * @return true if `runs > 0`
+     */
+    bool valid() const {
+        return runs > 0;
+    }
+
+    /**
+     * @brief Busiest worker's time over the mean: 1 is perfectly balanced.
+     * @return Imbalance ratio (0 when no chunk time was recorded)
+     */
+    double imbalance() const {
+        return busyMeanNs > 0.0 ? static_cast<double>(busyMaxNs) / busyMeanNs : 0.0;
+    }
+};
+
+/**
+ * @brief Process-wide trace registry: rings, interned labels, balance totals and the output file.
+ */
+class TraceLog {
+public:
+    /**
+     * @brief Process-wide log (closed by default).
+     * @return Reference to the log
+     */
+    static TraceLog& global() {
+        static TraceLog instance;
+        return instance;
+    }
+
+    /**
+     * @brief Start recording and calibrate the tick rate. Call before creating any `ThreadPool`.
+     * @param path Chrome trace JSON written by `flush()`
+     * @return false (after an `[ERROR]`) if this build has no trace spans
+     */
+    bool open(const std::string& path) {
+        if (!kTraceCompiled) {
+            std::cerr << "[ERROR] --trace needs a build with trace spans (cmake -DMC_ENABLE_TRACE=ON)\n";
+            return false;
+        }
+        outPath = path;
+        originTicks = traceTicks();
+        originTime = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(kTraceCalibrationMs));
+        calibrate();
+        enabled = true;
+        nameCurrentThread("main");
+        return true;
+    }
+
+    /**
+     * @brief Whether spans are being recorded.
+     * @return false at compile time without `MC_TRACE`
+     */
+    bool active() const {
+        return kTraceCompiled && enabled;
+    }
+
+    /**
+     * @brief The calling thread's ring, registered on first use.
+     * @return Reference to the ring
+     */
+    static TraceRing& currentRing() {
+        thread_local TraceRing* ring = nullptr;
+        if (!ring) {
+            TraceLog& log = global();
+            std::lock_guard<std::mutex> lock(log.mutex);
+            unsigned id = static_cast<unsigned>(log.rings.size());
+            log.rings.push_back(std::make_unique<TraceRing>(id, "thread " + std::to_string(id)));
+            ring = log.rings.back().get();
+        }
+        return *ring;
+    }
+
+    /**
+     * @brief Name the calling thread in the exported trace. No-op while closed.
+     * @param label Thread name (e.g. `worker 3`)
+     */
+    static void nameCurrentThread(const std::string& label) {
+        TraceLog& log = global();
+        if (!log.active()) return;
+        TraceRing& ring = currentRing();
+        std::lock_guard<std::mutex> lock(log.mutex);
+        ring.label = label;
+    }
+
+    /**
+     * @brief Stable copy of a dynamic label for `TraceSpan` (spans store only the pointer).
+     * @param name Label
+     * @return Pointer valid for the life of the process
+     */
+    const char* intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.insert(name).first->c_str();
+    }
+
+    /**
+     * @brief Add one pool run's balance figures to the running totals.
+     * @param workers One entry per worker, in worker order
+     */
+    void addPoolRun(const std::vector<TraceWorkerRun>& workers) {
+        if (workers.empty()) return;
+        std::uint64_t firstBegin = workers[0].begin, lastBegin = workers[0].begin;
+        std::uint64_t firstEnd = workers[0].end, lastEnd = workers[0].end;
+        std::uint64_t busyMin = workers[0].busy, busyMax = workers[0].busy, busySum = 0;
+        for (const TraceWorkerRun& worker : workers) {
+            firstBegin = std::min(firstBegin, worker.begin);
+            lastBegin = std::max(lastBegin, worker.begin);
+            firstEnd = std::min(firstEnd, worker.end);
+            lastEnd = std::max(lastEnd, worker.end);
+            busyMin = std::min(busyMin, worker.busy);
+            busyMax = std::max(busyMax, worker.busy);
+            busySum += worker.busy;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        totals.runs += 1;
+        totals.startSkewNs += toNs(lastBegin - firstBegin);
+        totals.joinWaitNs += toNs(lastEnd - firstEnd);
+        totals.busyMinNs += toNs(busyMin);
+        totals.busyMaxNs += toNs(busyMax);
+        totals.busyMeanNs += static_cast<double>(busySum) * tickNs / static_cast<double>(workers.size());
+    }
+
+    /**
+     * @brief Balance totals of every pool run so far.
+     * @return Running totals
+     */
+    TraceBalance balance() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return totals;
+    }
+
+    /**
+     * @brief Write every ring as Chrome trace JSON. No-op while closed.
+     * @return false (after an `[ERROR]`) if the file cannot be written
+     */
+    bool flush() {
+        if (!active()) return true;
+        calibrate();
+
+        std::ofstream out(outPath, std::ios::trunc);
+        std::uint64_t spans = 0, dropped = 0;
+        char number[64];
+        auto micros = [&](std::uint64_t ticks) {
+            std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(ticks) * tickNs / 1e3);
+            return std::string(number);
+        };
+
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        for (const std::unique_ptr<TraceRing>& ring : rings) {
+            out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << ring->id
+                << ",\"args\":{\"name\":\"" << traceJsonEscape(ring->label) << "\"}}";
+            first = false;
+            for (const TraceEvent& event : ring->snapshot()) {
+                std::uint64_t begin = event.begin > originTicks ? event.begin - originTicks : 0;
+                std::uint64_t length = event.end > event.begin ? event.end - event.begin : 0;
+                out << ",\n{\"ph\":\"X\",\"name\":\"" << traceJsonEscape(event.name ? event.name : "")
+                    << "\",\"pid\":1,\"tid\":" << ring->id << ",\"ts\":" << micros(begin) << ",\"dur\":" << micros(length);
+                if (event.arg != 0) out << ",\"args\":{\"trials\":" << event.arg << "}";
+                out << "}";
+                ++spans;
+            }
+            dropped += ring->dropped();
+        }
+        out << "\n]}\n";
+
+        if (!out) {
+            std::cerr << "[ERROR] Cannot write trace: " << outPath << "\n";
+            return false;
+        }
+        std::cout << "[INFO] Trace: " << spans << " spans from " << rings.size() << " threads written to " << outPath
+                  << "\n";
+        if (dropped > 0) {
+            std::cout << "[WARN] " << dropped << " older spans were overwritten (" << kTraceRingEvents
+                      << " per thread); trace the run with fewer trials or repetitions to keep them\n";
+        }
+        return true;
+    }
+
+private:
+    /**
+     * @brief Refresh the tick length from the ticks and `steady_clock` time elapsed since `open()`.
+     */
+    void calibrate() {
+        std::uint64_t ticks = traceTicks() - originTicks;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - originTime);
+        if (ticks > 0 && ns.count() > 0) tickNs = static_cast<double>(ns.count()) / static_cast<double>(ticks);
+    }
+
+    /**
+     * @brief Convert a tick count to nanoseconds.
+     * @param ticks Tick count
+     * @return Nanoseconds (rounded)
+     */
+    long long toNs(std::uint64_t ticks) const {
+        return static_cast<long long>(static_cast<double>(ticks) * tickNs + 0.5);
+    }
+
+    std::mutex mutex;                                   ///< Guards rings, labels, names and totals
+    std::vector<std::unique_ptr<TraceRing>> rings;      ///< One per thread that recorded a span
+    std::set<std::string> names;                        ///< Interned dynamic labels
+    TraceBalance totals;                                ///< Balance of every pool run so far
+    std::string outPath;                                ///< JSON output (set by `open()`)
+    std::uint64_t originTicks = 0;                      ///< Tick at `open()`; trace time zero
+    std::chrono::steady_clock::time_point originTime;   ///< `steady_clock` at `open()`
+    double tickNs = 1.0;                                ///< Nanoseconds per tick
+    bool enabled = false;                               ///< Set by `open()`
+};
+
+/**
+ * @brief Records one span on the calling thread from construction to destruction.
+ *
+ * Inert (no clock read) while tracing is off. Use through `MC_TRACE_SCOPE`.
+ */
+class TraceSpan {
+public:
+    /**
+     * @brief Start the span.
+     * @param name Static or interned label
+     * @param arg  Trials (or other count) shown in the span's args; 0 = none
+     */
+    explicit TraceSpan(const char* name, std::int64_t arg = 0)
+        : name(name), arg(arg), begin(TraceLog::global().active() ? traceTicks() : 0) {}
+
+    /**
+     * @brief End the span and push it to the thread's ring.
+     */
+    ~TraceSpan() {
+        if (begin != 0) TraceLog::currentRing().push({begin, traceTicks(), name, arg});
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /**
+     * @brief End the span now instead of at destruction (e.g. before handing results to another thread).
+     * @return End tick (0 while tracing is off)
+     */
+    std::uint64_t finish() {
+        if (begin == 0) return 0;
+        std::uint64_t end = traceTicks();
+        TraceLog::currentRing().push({begin, end, name, arg});
+        begin = 0;
+        return end;
+    }
+
+    /**
+     * @brief Ticks since the span started.
+     * @return Elapsed ticks (0 while tracing is off)
+     */
+    std::uint64_t elapsed() const {
+        return begin != 0 ? traceTicks() - begin : 0;
+    }
+
+    /**
+     * @brief Start tick.
+     * @return Tick at construction (0 while tracing is off)
+     */
+    std::uint64_t started() const {
+        return begin;
+    }
+
+private:
+    const char* name;        ///< Label
+    std::int64_t arg;        ///< Count shown in the span's args
+    std::uint64_t begin;     ///< Start tick (0 = not recording)
+};
+
+/**
+ * @brief Pool balance figures of all pool runs between construction and `stop()`.
+ */
+class TraceRegion {
+public:
+    /**
+     * @brief Snapshot the running totals.
+     */
+    TraceRegion() {
+        if (TraceLog::global().active()) start = TraceLog::global().balance();
+    }
+
+    /**
+     * @brief Totals of the region.
+     * @return Balance of the pool runs since construction (`runs == 0` if none or tracing is off)
+     */
+    TraceBalance stop() const {
+        TraceBalance delta;
+        if (!TraceLog::global().active()) return delta;
+        TraceBalance end = TraceLog::global().balance();
+        delta.runs = end.runs - start.runs;
+        delta.startSkewNs = end.startSkewNs - start.startSkewNs;
+        delta.joinWaitNs = end.joinWaitNs - start.joinWaitNs;
+        delta.busyMinNs = end.busyMinNs - start.busyMinNs;
+        delta.busyMaxNs = end.busyMaxNs - start.busyMaxNs;
+        delta.busyMeanNs = end.busyMeanNs - start.busyMeanNs;
+        return delta;
+    }
+
+private:
+    TraceBalance start;   ///< Totals at construction
+};
+
+#define MC_TRACE_CONCAT_(a, b) a##b
+#define MC_TRACE_CONCAT(a, b) MC_TRACE_CONCAT_(a, b)
+
+#ifdef MC_TRACE
+/// Span over the rest of the enclosing scope.
+#define MC_TRACE_SCOPE(name) TraceSpan MC_TRACE_CONCAT(traceSpan, __LINE__)(name)
+/// Span over the rest of the enclosing scope, with a trial count.
+#define MC_TRACE_SCOPE_ARG(name, arg) TraceSpan MC_TRACE_CONCAT(traceSpan, __LINE__)(name, static_cast<std::int64_t>(arg))
+#else
+#define MC_TRACE_SCOPE(name) ((void)0)
+#define MC_TRACE_SCOPE_ARG(name, arg) ((void)0)
+#endif